@@ -1 +1,7 @@
-gcc clock/digital.c bin/SDL2.dll bin/SDL2_ttf.dll -I./SDL2/include -I./SDL2_ttf-2.20.2/include -O3 -o bin/cclock.exe -mwindows
\ No newline at end of file
+rem libcclock: the clock engine without SDL (cclock.h), monotonic.c is its only OS specific file
+gcc -c clock/cclock.c -O3 -o bin/cclock.o
+gcc -c clock/format.c -O3 -o bin/format.o
+gcc -c clock/time_source.c -O3 -o bin/time_source.o
+gcc -c clock/monotonic.c -O3 -o bin/monotonic.o
+ar rcs bin/libcclock.a bin/cclock.o bin/format.o bin/time_source.o bin/monotonic.o
+gcc clock/digital.c clock/profile.c clock/analog.c clock/bench.c clock/glyph_atlas.c clock/worldclock.c clock/tzif.c clock/blend.c clock/compositor.c clock/workerpool.c clock/blur.c clock/texture_pool.c clock/text_cache.c clock/transition.c clock/export.c clock/shm_ring.c clock/skin.c clock/alarm.c clock/soak.c clock/replay.c clock/log.c clock/platform.c clock/platform_win32.c clock/platform_x11.c clock/term.c clock/stream.c clock/control.c bin/libcclock.a bin/SDL2.dll bin/SDL2_ttf.dll -I./SDL2/include -I./SDL2_ttf-2.20.2/include -O3 -o bin/cclock.exe -mwindows
\ No newline at end of file
@@ -0,0 +1,11 @@
+#!/bin/sh
+# Linux build, needs the SDL2, SDL2_ttf and X11 dev packages. Add -DCCLOCK_NO_X11 and drop x11 for a headless only build
+set -e
+# libcclock: the clock engine without SDL (cclock.h), monotonic.c is its only OS specific file
+mkdir -p bin
+gcc -c clock/cclock.c -O3 -o bin/cclock.o
+gcc -c clock/format.c -O3 -o bin/format.o
+gcc -c clock/time_source.c -O3 -o bin/time_source.o
+gcc -c clock/monotonic.c -O3 -o bin/monotonic.o
+ar rcs bin/libcclock.a bin/cclock.o bin/format.o bin/time_source.o bin/monotonic.o
+gcc clock/digital.c clock/profile.c clock/analog.c clock/bench.c clock/glyph_atlas.c clock/worldclock.c clock/tzif.c clock/blend.c clock/compositor.c clock/workerpool.c clock/blur.c clock/texture_pool.c clock/text_cache.c clock/transition.c clock/export.c clock/shm_ring.c clock/skin.c clock/alarm.c clock/soak.c clock/replay.c clock/log.c clock/platform.c clock/platform_win32.c clock/platform_x11.c clock/term.c clock/stream.c clock/control.c bin/libcclock.a $(pkg-config --cflags --libs sdl2 SDL2_ttf x11) -lm -lpthread -lrt -O3 -o bin/cclock
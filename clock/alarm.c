@@ -0,0 +1,337 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // localtime_r
+#endif
+
+#include "alarm.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crt_compat.h"
+#include "tzif.h"
+
+static const char* const g_weekdayNames[] = { "sun", "mon", "tue", "wed", "thu", "fri", "sat" };
+
+// "fri", "Friday" -> 5
+static int parse_weekday(const char* word, size_t length) {
+    if (length < 3) return -1;
+    for (int i = 0; i < 7; ++i) {
+        if (tolower((unsigned char)word[0]) == g_weekdayNames[i][0] && tolower((unsigned char)word[1]) == g_weekdayNames[i][1]
+            && tolower((unsigned char)word[2]) == g_weekdayNames[i][2]) return i;
+    }
+    return -1;
+}
+
+static bool word_is(const char* word, size_t length, const char* expected) {
+    if (length != strlen(expected)) return false;
+    for (size_t i = 0; i < length; ++i) {
+        if (tolower((unsigned char)word[i]) != expected[i]) return false;
+    }
+    return true;
+}
+
+static bool parse_days(CClockAlarmRule* rule, const char* days) {
+    const size_t length = strlen(days);
+    const char* space = strchr(days, ' ');
+    int year, month, day, n;
+
+    if (word_is(days, length, "daily") || word_is(days, length, "everyday")) {
+        rule->kind = CCLOCK_ALARM_WEEKLY;
+        rule->weekdays = 0x7F;
+    }
+    else if (word_is(days, length, "weekdays")) {
+        rule->kind = CCLOCK_ALARM_WEEKLY;
+        rule->weekdays = 0x3E;
+    }
+    else if (word_is(days, length, "weekends")) {
+        rule->kind = CCLOCK_ALARM_WEEKLY;
+        rule->weekdays = 0x41;
+    }
+    else if (sscanf_s(days, "%d-%d-%d%n", &year, &month, &day, &n) == 3 && (size_t)n == length) {
+        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+        // mktime moves 2025-02-31 to March 3, a day that comes back different does not exist
+        struct tm check = { .tm_year = year - 1900, .tm_mon = month - 1, .tm_mday = day, .tm_hour = 12, .tm_isdst = -1 };
+        if (mktime(&check) == (time_t)-1 || check.tm_year != year - 1900 || check.tm_mon != month - 1 || check.tm_mday != day) return false;
+        rule->kind = CCLOCK_ALARM_ONCE;
+        rule->year = year;
+        rule->month = month;
+        rule->day = day;
+    }
+    else if (sscanf_s(days, "day %d%n", &day, &n) == 1 && (size_t)n == length) {
+        if (day < 1 || day > 31) return false;
+        rule->kind = CCLOCK_ALARM_MONTH_DAY;
+        rule->monthDay = (uint8_t)day;
+    }
+    else if (space) {
+        // "last fri", "2nd tue"
+        const int weekday = parse_weekday(space + 1, strlen(space + 1));
+        if (weekday < 0) return false;
+        if (word_is(days, space - days, "last")) rule->nth = -1;
+        else if (space - days == 3 && days[0] >= '1' && days[0] <= '5') rule->nth = (int8_t)(days[0] - '0');
+        else return false;
+        rule->kind = CCLOCK_ALARM_NTH_WEEKDAY;
+        rule->weekday = (uint8_t)weekday;
+    }
+    else {
+        // "mon,wed,fri"
+        rule->kind = CCLOCK_ALARM_WEEKLY;
+        for (const char* word = days; *word;) {
+            const char* end = strchr(word, ',');
+            const size_t wordLength = end ? (size_t)(end - word) : strlen(word);
+            const int weekday = parse_weekday(word, wordLength);
+            if (weekday < 0) return false;
+            rule->weekdays |= (uint8_t)(1 << weekday);
+            word = end ? end + 1 : word + wordLength;
+        }
+        if (!rule->weekdays) return false;
+    }
+    return true;
+}
+
+bool alarm_rule_parse(CClockAlarmRule* rule, const char* text) {
+    *rule = (CClockAlarmRule){ 0 };
+    while (*text == ' ') ++text;
+
+    // The time is the last word, everything before it says which days
+    const char* time = strrchr(text, ' ');
+    if (!time) return false;
+    int hour, minute, n;
+    if (sscanf_s(time + 1, "%d:%d%n", &hour, &minute, &n) != 2 || time[1 + n] != '\0' || hour < 0 || hour > 23 || minute < 0 || minute > 59) return false;
+    rule->minute = hour * 60 + minute;
+
+    char days[64];
+    size_t length = (size_t)(time - text);
+    while (length > 0 && text[length - 1] == ' ') --length;
+    if (length == 0 || length >= sizeof(days)) return false;
+    memcpy(days, text, length);
+    days[length] = '\0';
+    return parse_days(rule, days);
+}
+
+bool alarm_parse_spec(const char* text, CClockAlarmRule* rule, char* label, size_t labelSize) {
+    char ruleText[96];
+    const char* bar = strchr(text, '|');
+    const size_t length = bar ? (size_t)(bar - text) : strcspn(text, "\r\n");
+    if (length >= sizeof(ruleText)) return false;
+    memcpy(ruleText, text, length);
+    ruleText[length] = '\0';
+
+    label[0] = '\0';
+    if (bar) {
+        const size_t labelLength = strcspn(bar + 1, "\r\n");
+        if (labelLength >= labelSize) return false;
+        memcpy(label, bar + 1, labelLength);
+        label[labelLength] = '\0';
+    }
+    return alarm_rule_parse(rule, ruleText);
+}
+
+static void to_local(time_t t, struct tm* out) {
+#ifdef _WIN32
+    localtime_s(out, &t);
+#else
+    localtime_r(&t, out);
+#endif
+}
+
+static time_t local_time(int year, int month, int day, int minute) {
+    struct tm tm = { 0 };
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = minute / 60;
+    tm.tm_min = minute % 60;
+    tm.tm_isdst = -1;
+    const time_t t = mktime(&tm);
+
+    // A wall time repeated by the end of DST fires on its first occurrence, mktime may pick either
+    struct tm earlier;
+    to_local(t - 3600, &earlier);
+    if (earlier.tm_mday == tm.tm_mday && earlier.tm_hour == tm.tm_hour && earlier.tm_min == tm.tm_min) return t - 3600;
+    return t;
+}
+
+static bool is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+static int days_in_month(int year, int month) {
+    static const int monthDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    return monthDays[month - 1] + (month == 2 && is_leap_year(year));
+}
+
+static int weekday_of(int64_t days) {
+    return (int)((days % 7 + 11) % 7); // 1970-01-01 was a Thursday
+}
+
+// Day of the month the rule fires on, 0 when this month has none
+static int month_fire_day(const CClockAlarmRule* rule, int year, int month) {
+    const int length = days_in_month(year, month);
+    if (rule->kind == CCLOCK_ALARM_MONTH_DAY) return rule->monthDay <= length ? rule->monthDay : 0;
+
+    const int firstWeekday = weekday_of(tz_days_from_civil(year, month, 1));
+    int day = 1 + (rule->weekday - firstWeekday + 7) % 7;
+    if (rule->nth < 0) {
+        while (day + 7 <= length) day += 7;
+        return day;
+    }
+    day += (rule->nth - 1) * 7;
+    return day <= length ? day : 0;
+}
+
+time_t alarm_rule_next(const CClockAlarmRule* rule, time_t after) {
+    struct tm now;
+    to_local(after, &now);
+    const int year = now.tm_year + 1900;
+    const int month = now.tm_mon + 1;
+    const int64_t today = tz_days_from_civil(year, month, now.tm_mday);
+    // Compared on the wall clock so a time repeated by the DST change does not fire twice
+    const int64_t firstDay = now.tm_hour * 60 + now.tm_min < rule->minute ? today : today + 1;
+
+    switch (rule->kind) {
+    case CCLOCK_ALARM_WEEKLY:
+        // 8 days: the same weekday next week is always reached
+        for (int64_t day = firstDay; day < firstDay + 8 && rule->weekdays; ++day) {
+            if (!(rule->weekdays & (1 << weekday_of(day)))) continue;
+            struct tm date;
+            tz_civil_from_seconds(day * 86400, &date);
+            const time_t t = local_time(date.tm_year + 1900, date.tm_mon + 1, date.tm_mday, rule->minute);
+            if (t > after) return t;
+        }
+        break;
+    case CCLOCK_ALARM_NTH_WEEKDAY:
+    case CCLOCK_ALARM_MONTH_DAY:
+        // A 5th weekday or a 31st can be missing for a few months in a row, never for a year
+        for (int i = 0; i < 14; ++i) {
+            const int y = year + (month - 1 + i) / 12;
+            const int m = (month - 1 + i) % 12 + 1;
+            const int day = month_fire_day(rule, y, m);
+            if (day == 0 || tz_days_from_civil(y, m, day) < firstDay) continue;
+            const time_t t = local_time(y, m, day, rule->minute);
+            if (t > after) return t;
+        }
+        break;
+    case CCLOCK_ALARM_ONCE:
+        if (tz_days_from_civil(rule->year, rule->month, rule->day) >= firstDay) {
+            const time_t t = local_time(rule->year, rule->month, rule->day, rule->minute);
+            if (t > after) return t;
+        }
+        break;
+    }
+    return ALARM_NEVER;
+}
+
+bool alarm_rule_matches(const CClockAlarmRule* rule, const struct tm* day) {
+    const int length = days_in_month(day->tm_year + 1900, day->tm_mon + 1);
+    switch (rule->kind) {
+    case CCLOCK_ALARM_WEEKLY:
+        return (rule->weekdays & (1 << day->tm_wday)) != 0;
+    case CCLOCK_ALARM_NTH_WEEKDAY:
+        if (day->tm_wday != rule->weekday) return false;
+        return rule->nth < 0 ? day->tm_mday + 7 > length : (day->tm_mday - 1) / 7 + 1 == rule->nth;
+    case CCLOCK_ALARM_MONTH_DAY:
+        return day->tm_mday == rule->monthDay;
+    case CCLOCK_ALARM_ONCE:
+        return day->tm_year + 1900 == rule->year && day->tm_mon + 1 == rule->month && day->tm_mday == rule->day;
+    }
+    return false;
+}
+
+// --- next fire time heap ----------------------------------------------------
+
+static void heap_swap(CClockAlarmSlot* heap, int a, int b) {
+    const CClockAlarmSlot tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}
+
+static void sift_up(CClockAlarmSlot* heap, int i) {
+    while (i > 0 && heap[(i - 1) / 2].next > heap[i].next) {
+        heap_swap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void sift_down(CClockAlarmSlot* heap, int count, int i) {
+    for (;;) {
+        int smallest = i;
+        const int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < count && heap[left].next < heap[smallest].next) smallest = left;
+        if (right < count && heap[right].next < heap[smallest].next) smallest = right;
+        if (smallest == i) return;
+        heap_swap(heap, i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_push(CClockAlarms* alarms, time_t next, int alarm) {
+    alarms->heap[alarms->heapCount] = (CClockAlarmSlot){ next, alarm };
+    sift_up(alarms->heap, alarms->heapCount++);
+}
+
+bool alarms_add(CClockAlarms* alarms, const CClockAlarmRule* rule, const char* label, time_t now) {
+    if (alarms->alarmCount == alarms->alarmCapacity) {
+        const int capacity = alarms->alarmCapacity ? alarms->alarmCapacity * 2 : 16;
+        CClockAlarm* grown = realloc(alarms->alarms, sizeof(CClockAlarm) * capacity);
+        if (!grown) return false;
+        alarms->alarms = grown;
+        CClockAlarmSlot* heap = realloc(alarms->heap, sizeof(CClockAlarmSlot) * capacity);
+        if (!heap) return false;
+        alarms->heap = heap;
+        alarms->alarmCapacity = capacity;
+    }
+
+    CClockAlarm* alarm = &alarms->alarms[alarms->alarmCount];
+    alarm->rule = *rule;
+    snprintf(alarm->label, sizeof(alarm->label), "%s", label ? label : "");
+    const time_t next = alarm_rule_next(rule, now);
+    alarm->active = next != ALARM_NEVER;
+    if (alarm->active) heap_push(alarms, next, alarms->alarmCount);
+    alarms->alarmCount++;
+    return true;
+}
+
+time_t alarms_next(const CClockAlarms* alarms) {
+    return alarms->heapCount > 0 ? alarms->heap[0].next : ALARM_NEVER;
+}
+
+int alarms_fire_due(CClockAlarms* alarms, time_t now, int* fired, int maxFired) {
+    int count = 0;
+    while (alarms->heapCount > 0 && alarms->heap[0].next <= now) {
+        const int index = alarms->heap[0].alarm;
+        if (count < maxFired) fired[count] = index;
+        count++;
+
+        // Only the alarm that fired is recomputed, from now so missed periods are skipped
+        const time_t next = alarm_rule_next(&alarms->alarms[index].rule, now);
+        alarms->recomputes++;
+        if (next == ALARM_NEVER) {
+            alarms->alarms[index].active = false;
+            alarms->heap[0] = alarms->heap[--alarms->heapCount];
+        }
+        else {
+            alarms->heap[0].next = next;
+        }
+        sift_down(alarms->heap, alarms->heapCount, 0);
+    }
+    return count;
+}
+
+void alarms_reschedule(CClockAlarms* alarms, time_t now) {
+    alarms->heapCount = 0;
+    for (int i = 0; i < alarms->alarmCount; ++i) {
+        CClockAlarm* alarm = &alarms->alarms[i];
+        const time_t next = alarm_rule_next(&alarm->rule, now);
+        alarm->active = next != ALARM_NEVER;
+        if (alarm->active) heap_push(alarms, next, i);
+        alarms->recomputes++;
+    }
+}
+
+void alarms_destroy(CClockAlarms* alarms) {
+    free(alarms->alarms);
+    free(alarms->heap);
+    *alarms = (CClockAlarms){ 0 };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Recurring alarms on calendar rules, local time:
+//
+//   "daily 07:00", "weekdays 09:55", "weekends 10:00", "mon,wed,fri 18:30",
+//   "last fri 16:00", "2nd tue 10:00", "day 15 12:00", "2025-12-24 18:00" (once)
+//
+// Rules are compiled once, the next fire time of every alarm is kept in a min-heap so the clock
+// only looks at the top and recomputes the alarm that fired
+
+#define ALARM_NEVER ((time_t)-1)
+#define ALARM_LABEL_LENGTH 32
+#define ALARM_SPEC_LENGTH 96   // "<rule>|<label>" line of the ini
+#define ALARM_MAX_SPECS 64
+
+typedef enum {
+    CCLOCK_ALARM_WEEKLY,        // weekdays mask
+    CCLOCK_ALARM_NTH_WEEKDAY,   // nth (or last) weekday of the month
+    CCLOCK_ALARM_MONTH_DAY,     // same day every month, months without it are skipped
+    CCLOCK_ALARM_ONCE,
+} CClockAlarmKind;
+
+typedef struct {
+    CClockAlarmKind kind;
+    uint8_t weekdays;   // WEEKLY: bit n = tm_wday n (0 Sunday)
+    int8_t nth;         // NTH_WEEKDAY: 1 to 5, -1 for the last one
+    uint8_t weekday;    // NTH_WEEKDAY: tm_wday
+    uint8_t monthDay;   // MONTH_DAY: 1 to 31
+    int year;           // ONCE
+    int month;          // ONCE: 1 to 12
+    int day;            // ONCE
+    int minute;         // minute of the day
+} CClockAlarmRule;
+
+typedef struct {
+    CClockAlarmRule rule;
+    char label[ALARM_LABEL_LENGTH];
+    bool active;        // false once a one shot alarm fired
+} CClockAlarm;
+
+typedef struct {
+    time_t next;
+    int alarm;          // index into CClockAlarms.alarms
+} CClockAlarmSlot;
+
+typedef struct {
+    CClockAlarm* alarms;
+    int alarmCount;
+    int alarmCapacity;
+    CClockAlarmSlot* heap; // next fire times, earliest first
+    int heapCount;
+    unsigned long recomputes;
+} CClockAlarms;
+
+bool alarm_rule_parse(CClockAlarmRule* rule, const char* text);
+
+// "<rule>|<label>" as stored in the ini, the label is optional
+bool alarm_parse_spec(const char* text, CClockAlarmRule* rule, char* label, size_t labelSize);
+
+// First fire time strictly after `after`, ALARM_NEVER if there is none. Wall times that do not exist
+// (DST gap) fire at the time mktime normalizes them to, repeated ones on their first occurrence
+time_t alarm_rule_next(const CClockAlarmRule* rule, time_t after);
+
+// Whether the rule fires on the day of `day` (time of day ignored), slow but independent of alarm_rule_next
+bool alarm_rule_matches(const CClockAlarmRule* rule, const struct tm* day);
+
+bool alarms_add(CClockAlarms* alarms, const CClockAlarmRule* rule, const char* label, time_t now);
+
+// Earliest fire time, ALARM_NEVER without active alarms. O(1)
+time_t alarms_next(const CClockAlarms* alarms);
+
+// Pops every alarm due at `now`, stores up to maxFired of their indices and schedules them again.
+// An alarm late by several periods (sleep, clock jump) fires once. Returns how many fired
+int alarms_fire_due(CClockAlarms* alarms, time_t now, int* fired, int maxFired);
+
+// Recomputes every fire time, for when the wall clock or the time zone jumped backwards
+void alarms_reschedule(CClockAlarms* alarms, time_t now);
+
+void alarms_destroy(CClockAlarms* alarms);
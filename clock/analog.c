@@ -0,0 +1,244 @@
+#include "analog.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "soak_track.h"
+
+#define PI 3.14159265358979323846
+
+// Width of the edge over which shapes fade out, gives anti-aliased edges without MSAA
+#define AA_FRINGE 1.0f
+
+#define DIAL_SEGMENTS 96
+#define CAP_SEGMENTS 16
+
+#define MAX_VERTICES 1024
+#define MAX_INDICES 4096
+
+typedef struct {
+    SDL_Vertex vertices[MAX_VERTICES];
+    int indices[MAX_INDICES];
+    int vertexCount;
+    int indexCount;
+} GeometryBatch;
+
+// The renderer is single threaded, one batch is enough
+static GeometryBatch g_batch;
+
+static int batch_vertex(GeometryBatch* batch, float x, float y, SDL_Color color) {
+    SDL_assert(batch->vertexCount < MAX_VERTICES);
+    batch->vertices[batch->vertexCount] = (SDL_Vertex){ .position = { x, y }, .color = color, .tex_coord = { 0.f, 0.f } };
+    return batch->vertexCount++;
+}
+
+static void batch_triangle(GeometryBatch* batch, int a, int b, int c) {
+    SDL_assert(batch->indexCount + 3 <= MAX_INDICES);
+    batch->indices[batch->indexCount++] = a;
+    batch->indices[batch->indexCount++] = b;
+    batch->indices[batch->indexCount++] = c;
+}
+
+static void batch_quad(GeometryBatch* batch, int a, int b, int c, int d) {
+    batch_triangle(batch, a, b, c);
+    batch_triangle(batch, a, c, d);
+}
+
+// Solid core plus a fringe fading to transparent on both long sides
+static void push_segment(GeometryBatch* batch, float x0, float y0, float x1, float y1, float halfWidth, SDL_Color color) {
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    const float len = sqrtf(dx * dx + dy * dy);
+    if (len <= 0.f) return;
+    dx /= len;
+    dy /= len;
+    const float nx = -dy;
+    const float ny = dx;
+    const float outer = halfWidth + AA_FRINGE;
+    const SDL_Color clear = { color.r, color.g, color.b, 0 };
+
+    const int v0 = batch_vertex(batch, x0 + nx * outer, y0 + ny * outer, clear);
+    const int v1 = batch_vertex(batch, x0 + nx * halfWidth, y0 + ny * halfWidth, color);
+    const int v2 = batch_vertex(batch, x0 - nx * halfWidth, y0 - ny * halfWidth, color);
+    const int v3 = batch_vertex(batch, x0 - nx * outer, y0 - ny * outer, clear);
+    const int v4 = batch_vertex(batch, x1 + nx * outer, y1 + ny * outer, clear);
+    const int v5 = batch_vertex(batch, x1 + nx * halfWidth, y1 + ny * halfWidth, color);
+    const int v6 = batch_vertex(batch, x1 - nx * halfWidth, y1 - ny * halfWidth, color);
+    const int v7 = batch_vertex(batch, x1 - nx * outer, y1 - ny * outer, clear);
+
+    batch_quad(batch, v0, v1, v5, v4);
+    batch_quad(batch, v1, v2, v6, v5);
+    batch_quad(batch, v2, v3, v7, v6);
+}
+
+static void push_disc(GeometryBatch* batch, float cx, float cy, float radius, SDL_Color color, int segments) {
+    const SDL_Color clear = { color.r, color.g, color.b, 0 };
+    const int center = batch_vertex(batch, cx, cy, color);
+    const int first = batch->vertexCount;
+    for (int i = 0; i < segments; ++i) {
+        const float a = (float)(2.0 * PI * i / segments);
+        const float c = cosf(a);
+        const float s = sinf(a);
+        batch_vertex(batch, cx + c * radius, cy + s * radius, color);
+        batch_vertex(batch, cx + c * (radius + AA_FRINGE), cy + s * (radius + AA_FRINGE), clear);
+    }
+    for (int i = 0; i < segments; ++i) {
+        const int inner = first + 2 * i;
+        const int nextInner = first + 2 * ((i + 1) % segments);
+        batch_triangle(batch, center, inner, nextInner);
+        batch_quad(batch, inner, inner + 1, nextInner + 1, nextInner);
+    }
+}
+
+static void batch_flush(SDL_Renderer* renderer, GeometryBatch* batch) {
+    if (batch->indexCount > 0) {
+        SDL_BlendMode previous;
+        SDL_GetRenderDrawBlendMode(renderer, &previous);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderGeometry(renderer, NULL, batch->vertices, batch->vertexCount, batch->indices, batch->indexCount);
+        SDL_SetRenderDrawBlendMode(renderer, previous);
+    }
+    batch->vertexCount = 0;
+    batch->indexCount = 0;
+}
+
+static void draw_dial(SDL_Renderer* renderer, CClockAnalogFace* face, TTF_Font* numeralFont, float x0, float y0, int diameter) {
+    const float k = (float)diameter / ANALOG_DIAMETER;
+    const float radius = diameter / 2.f - 2.f * AA_FRINGE;
+    const float cx = x0 + diameter / 2.f;
+    const float cy = y0 + diameter / 2.f;
+
+    push_disc(&g_batch, cx, cy, radius, (SDL_Color) { 70, 70, 70, 255 }, DIAL_SEGMENTS);
+    push_disc(&g_batch, cx, cy, radius - 4.f * k, (SDL_Color) { 24, 24, 24, 255 }, DIAL_SEGMENTS);
+
+    for (int i = 0; i < 60; ++i) {
+        const bool isHour = i % 5 == 0;
+        const double a = 2.0 * PI * i / 60.0;
+        const float dx = (float)sin(a);
+        const float dy = (float)-cos(a);
+        const float inner = radius * (isHour ? 0.82f : 0.90f);
+        const float outer = radius * 0.95f;
+        push_segment(&g_batch, cx + dx * inner, cy + dy * inner, cx + dx * outer, cy + dy * outer,
+            (isHour ? 2.5f : 1.f) * k, (SDL_Color) { 200, 200, 200, 255 });
+    }
+    batch_flush(renderer, &g_batch);
+
+    if (!numeralFont) return;
+    // Over the opaque dial, anti-aliasing leaves no fringe even on a color keyed window
+    face->numerals.blended = true;
+    face->numerals.fixedStrings = true;
+    const float scale = k * 0.75f;
+    for (int h = 1; h <= 12; ++h) {
+        char text[3];
+        SDL_snprintf(text, sizeof(text), "%d", h);
+        int w, hgt;
+        if (TTF_SizeText(numeralFont, text, &w, &hgt) != 0) continue;
+        const double a = 2.0 * PI * h / 12.0;
+        const float r = radius * 0.66f;
+        const float x = cx + (float)sin(a) * r - w * scale / 2.f;
+        const float y = cy - (float)cos(a) * r - hgt * scale / 2.f;
+        text_cache_draw(&face->numerals, renderer, numeralFont, text, (int)lroundf(x), (int)lroundf(y),
+            scale, (SDL_Color) { 230, 230, 230, 255 });
+    }
+}
+
+static SDL_Texture* get_dial(SDL_Renderer* renderer, CClockAnalogFace* face, TTF_Font* numeralFont, int diameter) {
+    face->useCounter++;
+
+    CClockAnalogDial* victim = &face->dials[0];
+    CClockAnalogDial* nearest = NULL;
+    for (int i = 0; i < ANALOG_DIAL_CACHE_SIZE; ++i) {
+        CClockAnalogDial* dial = &face->dials[i];
+        if (dial->texture && dial->diameter == diameter) {
+            dial->lastUse = face->useCounter;
+            return dial->texture;
+        }
+        if (dial->texture && (!nearest || abs(dial->diameter - diameter) < abs(nearest->diameter - diameter))) nearest = dial;
+        if (!dial->texture || dial->lastUse < victim->lastUse) victim = dial;
+    }
+    if (nearest && face->stretchNearest) {
+        nearest->lastUse = face->useCounter;
+        return nearest->texture;
+    }
+
+    if (!SDL_RenderTargetSupported(renderer)) return NULL;
+
+    if (victim->texture) SDL_DestroyTexture(victim->texture);
+    victim->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, diameter, diameter);
+    if (!victim->texture) return NULL;
+    victim->diameter = diameter;
+    victim->lastUse = face->useCounter;
+
+    // Opaque black corners are fine, black is the transparency color key of the window
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, victim->texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderClear(renderer);
+    draw_dial(renderer, face, numeralFont, 0.f, 0.f, diameter);
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_SetTextureBlendMode(victim->texture, SDL_BLENDMODE_NONE);
+
+    return victim->texture;
+}
+
+static void push_hands(GeometryBatch* batch, float cx, float cy, float radius, float k, double secondsOfDay, SDL_Color handColor, SDL_Color secondColor) {
+    const double hourAngle = 2.0 * PI * fmod(secondsOfDay, 43200.0) / 43200.0;
+    const double minuteAngle = 2.0 * PI * fmod(secondsOfDay, 3600.0) / 3600.0;
+    const double secondAngle = 2.0 * PI * fmod(secondsOfDay, 60.0) / 60.0;
+
+    const float hx = (float)sin(hourAngle), hy = (float)-cos(hourAngle);
+    const float mx = (float)sin(minuteAngle), my = (float)-cos(minuteAngle);
+    const float sx = (float)sin(secondAngle), sy = (float)-cos(secondAngle);
+    const float tail = radius * 0.12f;
+
+    push_segment(batch, cx - hx * tail, cy - hy * tail, cx + hx * radius * 0.5f, cy + hy * radius * 0.5f, 5.f * k, handColor);
+    push_segment(batch, cx - mx * tail, cy - my * tail, cx + mx * radius * 0.75f, cy + my * radius * 0.75f, 3.5f * k, handColor);
+    push_segment(batch, cx - sx * tail, cy - sy * tail, cx + sx * radius * 0.88f, cy + sy * radius * 0.88f, 1.2f * k, secondColor);
+    push_disc(batch, cx, cy, 6.f * k, secondColor, CAP_SEGMENTS);
+}
+
+void analog_face_render(SDL_Renderer* renderer, CClockAnalogFace* face, TTF_Font* numeralFont,
+    const SDL_Rect* dest, double secondsOfDay, SDL_Color handColor, bool shadowEffect) {
+
+    const int diameter = dest->w < dest->h ? dest->w : dest->h;
+    if (diameter <= 0) return;
+
+    SDL_Texture* dial = get_dial(renderer, face, numeralFont, diameter);
+    if (dial) {
+        const SDL_Rect dialRect = { dest->x, dest->y, diameter, diameter };
+        SDL_RenderCopy(renderer, dial, NULL, &dialRect);
+    }
+    else {
+        // No render targets (some software fallbacks), rebuild the dial every frame
+        draw_dial(renderer, face, numeralFont, (float)dest->x, (float)dest->y, diameter);
+    }
+
+    const float k = (float)diameter / ANALOG_DIAMETER;
+    const float radius = diameter / 2.f - 2.f * AA_FRINGE;
+    const float cx = dest->x + diameter / 2.f;
+    const float cy = dest->y + diameter / 2.f;
+
+    // Shadow and hands go out in a single geometry batch
+    if (shadowEffect) {
+        const SDL_Color shadowColor = { 1, 1, 1, 160 };
+        const float offset = 4.f * k;
+        push_hands(&g_batch, cx + offset, cy + offset, radius, k, secondsOfDay, shadowColor, shadowColor);
+    }
+    push_hands(&g_batch, cx, cy, radius, k, secondsOfDay, handColor, (SDL_Color) { 255, 87, 51, 255 });
+    batch_flush(renderer, &g_batch);
+}
+
+void analog_face_invalidate(CClockAnalogFace* face) {
+    // The dials and numerals are re-rendered lazily on the next frame
+    analog_face_destroy(face);
+}
+
+void analog_face_destroy(CClockAnalogFace* face) {
+    for (int i = 0; i < ANALOG_DIAL_CACHE_SIZE; ++i) {
+        if (face->dials[i].texture) SDL_DestroyTexture(face->dials[i].texture);
+        face->dials[i] = (CClockAnalogDial){ 0 };
+    }
+    face->useCounter = 0;
+    text_cache_clear(&face->numerals);
+}
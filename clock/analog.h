@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "text_cache.h"
+
+// Diameter of the dial at clockScale == 1
+#define ANALOG_DIAMETER 300
+
+#define ANALOG_DIAL_CACHE_SIZE 4
+
+// The dial (disc, ticks, numerals) never changes so it is rendered once per diameter
+// into a target texture, only the hands are drawn each frame
+typedef struct {
+    SDL_Texture* texture;
+    int diameter;
+    unsigned long lastUse;
+} CClockAnalogDial;
+
+typedef struct {
+    CClockAnalogDial dials[ANALOG_DIAL_CACHE_SIZE];
+    unsigned long useCounter;
+    bool stretchNearest;    // set during a zoom: draw the closest cached dial scaled instead of one per frame size
+    CClockTextCache numerals;   // 1 to 12 in pooled textures, a dial rebuild or a frame without targets rasterizes nothing
+} CClockAnalogFace;
+
+// secondsOfDay is the local time of day, the fractional part drives the smooth sweep of the second hand
+void analog_face_render(SDL_Renderer* renderer, CClockAnalogFace* face, TTF_Font* numeralFont,
+    const SDL_Rect* dest, double secondsOfDay, SDL_Color handColor, bool shadowEffect);
+
+// Drop the cached dials, needed after SDL_RENDER_TARGETS_RESET / SDL_RENDER_DEVICE_RESET
+void analog_face_invalidate(CClockAnalogFace* face);
+
+void analog_face_destroy(CClockAnalogFace* face);
@@ -0,0 +1,1480 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // setenv, tzset, localtime_r
+#endif
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#define bench_fileno(file) _fileno(file)
+#define bench_mkdir(path) _mkdir(path)
+#define bench_rmdir(path) _rmdir(path)
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#define bench_fileno(file) fileno(file)
+#define bench_mkdir(path) mkdir(path, 0755)
+#define bench_rmdir(path) rmdir(path)
+#endif
+
+#include "alarm.h"
+#include "blend.h"
+#include "blur.h"
+#include "cclock.h"
+#include "compositor.h"
+#include "control.h"
+#include "format.h"
+#include "glyph_atlas.h"
+#include "log.h"
+#include "skin.h"
+#include "soak_track.h"
+#include "stream.h"
+#include "term.h"
+#include "text_cache.h"
+#include "transition.h"
+#include "tzif.h"
+#include "worldclock.h"
+
+#define BENCH_WIDTH 1600
+#define BENCH_HEIGHT 350
+
+// Offscreen window + renderer shared by the rendering benchmarks
+typedef struct {
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    TTF_Font* font256;
+    TTF_Font* font64;
+} BenchContext;
+
+static bool bench_context_init(BenchContext* ctx, int w, int h) {
+    *ctx = (BenchContext){ 0 };
+    if (SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() < 0) {
+        fprintf(stderr, "bench: init failed: %s\n", SDL_GetError());
+        return false;
+    }
+    ctx->window = SDL_CreateWindow("CClock bench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, w, h, SDL_WINDOW_HIDDEN);
+    if (!ctx->window) {
+        fprintf(stderr, "bench: window failed: %s\n", SDL_GetError());
+        return false;
+    }
+    ctx->renderer = SDL_CreateRenderer(ctx->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+    if (!ctx->renderer) ctx->renderer = SDL_CreateRenderer(ctx->window, -1, SDL_RENDERER_SOFTWARE);
+    ctx->font256 = TTF_OpenFont("digital-mono.ttf", 256);
+    ctx->font64 = TTF_OpenFont("digital-mono.ttf", 48);
+    if (!ctx->renderer || !ctx->font256 || !ctx->font64) {
+        fprintf(stderr, "bench: renderer or font failed: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+static void bench_context_destroy(BenchContext* ctx) {
+    if (ctx->font256) TTF_CloseFont(ctx->font256);
+    if (ctx->font64) TTF_CloseFont(ctx->font64);
+    if (ctx->renderer) SDL_DestroyRenderer(ctx->renderer);
+    if (ctx->window) SDL_DestroyWindow(ctx->window);
+    TTF_Quit();
+    SDL_Quit();
+}
+
+static double bench_seconds(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+}
+
+// Frame cost of the world clock panel must stay near-constant from 1 to 100 clocks
+#define WORLD_BENCH_FRAMES 200
+#define WORLD_BENCH_MAX_RATIO 2.0
+
+static int bench_world(int argc, char** argv) {
+    (void)argc; (void)argv;
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, BENCH_WIDTH, BENCH_HEIGHT)) goto done;
+
+    CClockGlyphAtlas atlas;
+    TTF_Font* const fonts[] = { ctx.font256, ctx.font64 };
+    const char* const charsets[] = { WORLD_CLOCK_TIME_CHARSET, WORLD_CLOCK_LABEL_CHARSET };
+    const int shadowRadii[] = { 8, 4 };
+    if (!glyph_atlas_build(&atlas, ctx.renderer, fonts, charsets, shadowRadii, 2, false)) goto done;
+
+    CClockZoneSpec defaults[8];
+    const int defaultCount = world_clock_default_zones(defaults, 8);
+    static CClockZoneSpec specs[WORLD_CLOCK_MAX_ZONES];
+    static CClockWorldClock worldClock;
+
+    const int counts[] = { 1, 2, 5, 10, 25, 50, 100 };
+    const int countCount = (int)(sizeof(counts) / sizeof(counts[0]));
+    const SDL_Rect area = { 0, 0, BENCH_WIDTH, BENCH_HEIGHT };
+    double firstFrameUs = 0.0;
+    double lastFrameUs = 0.0;
+
+    for (int c = 0; c < countCount; ++c) {
+        const int n = counts[c];
+        for (int i = 0; i < n; ++i) {
+            specs[i] = defaults[i % defaultCount];
+            SDL_snprintf(specs[i].label, sizeof(specs[i].label), "%s %d", defaults[i % defaultCount].label, i);
+        }
+        world_clock_init(&worldClock, specs, n);
+
+        // The first frame fills the offset cache, it is not part of the steady state
+        const time_t now = time(NULL);
+        world_clock_render(ctx.renderer, &worldClock, &atlas, &area, now, true, (SDL_Color) { 245, 245, 245, 255 }, true);
+
+        const Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < WORLD_BENCH_FRAMES; ++frame) {
+            SDL_SetRenderDrawColor(ctx.renderer, 0, 0, 0, 255);
+            SDL_RenderClear(ctx.renderer);
+            world_clock_render(ctx.renderer, &worldClock, &atlas, &area, now + frame, true, (SDL_Color) { 245, 245, 245, 255 }, true);
+            SDL_RenderPresent(ctx.renderer);
+        }
+        const double frameUs = bench_seconds(start) * 1e6 / WORLD_BENCH_FRAMES;
+        printf("world clocks=%3d frame_us=%8.1f offset_recomputes=%lu\n", n, frameUs, worldClock.offsetRecomputes);
+
+        if (c == 0) firstFrameUs = frameUs;
+        lastFrameUs = frameUs;
+        world_clock_destroy(&worldClock);
+    }
+
+    const double ratio = firstFrameUs > 0.0 ? lastFrameUs / firstFrameUs : 0.0;
+    printf("world ratio 100/1 = %.2f (max %.2f)\n", ratio, WORLD_BENCH_MAX_RATIO);
+    result = ratio <= WORLD_BENCH_MAX_RATIO ? 0 : 1;
+    glyph_atlas_destroy(&atlas);
+
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// Zones with half hour offsets, southern hemisphere DST, negative DST and rule footers
+static const char* const g_tzifZones[] = {
+    "UTC", "Europe/Paris", "Europe/London", "Europe/Dublin", "Europe/Moscow", "America/New_York",
+    "America/Los_Angeles", "America/Sao_Paulo", "America/St_Johns", "America/Santiago", "Asia/Tokyo",
+    "Asia/Kolkata", "Asia/Kathmandu", "Asia/Tehran", "Australia/Sydney", "Australia/Lord_Howe",
+    "Pacific/Auckland", "Pacific/Chatham", "Pacific/Apia", "Africa/Casablanca", "Antarctica/Troll",
+};
+
+#define TZIF_BENCH_FIRST ((int64_t)-2000000000)     // 1906
+#define TZIF_BENCH_LAST ((int64_t)4102444800)       // 2100
+#define TZIF_BENCH_STEP ((int64_t)86400 * 3 + 3607)
+#define TZIF_BENCH_CALLS 1000000
+
+static bool same_tm(const struct tm* a, const struct tm* b) {
+    return a->tm_year == b->tm_year && a->tm_mon == b->tm_mon && a->tm_mday == b->tm_mday
+        && a->tm_hour == b->tm_hour && a->tm_min == b->tm_min && a->tm_sec == b->tm_sec
+        && a->tm_wday == b->tm_wday && a->tm_yday == b->tm_yday && a->tm_isdst == b->tm_isdst;
+}
+
+// Compares tz_zone_localtime with localtime_r over two centuries and around every transition,
+// then times both. The comparison needs the C library to understand zoneinfo names, so not on Windows
+static int bench_tzif(int argc, char** argv) {
+    const char* const* zones = argc > 1 ? (const char* const*)argv + 1 : g_tzifZones;
+    const int zoneCount = argc > 1 ? argc - 1 : (int)(sizeof(g_tzifZones) / sizeof(g_tzifZones[0]));
+    unsigned long totalMismatches = 0;
+    int missing = 0, compared = 0;
+#ifndef _WIN32
+    // The comparison points TZ at every zone, the caller's TZ is put back at the end
+    char savedTz[256];
+    const char* tz = getenv("TZ");
+    const bool hadTz = tz != NULL;
+    if (hadTz) SDL_strlcpy(savedTz, tz, sizeof(savedTz));
+#endif
+
+    for (int z = 0; z < zoneCount; ++z) {
+        CClockTzZone zone;
+        if (!tz_zone_load(&zone, NULL, zones[z])) {
+            printf("tzif %-22s not found\n", zones[z]);
+            missing++;
+            continue;
+        }
+        compared++;
+
+        volatile int sink = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < TZIF_BENCH_CALLS; ++i) {
+            struct tm local;
+            tz_zone_localtime(&zone, 1700000000 + i, &local);
+            sink += local.tm_sec;
+        }
+        const double cachedNs = bench_seconds(start) * 1e9 / TZIF_BENCH_CALLS;
+
+        start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < TZIF_BENCH_CALLS; ++i) {
+            struct tm local;
+            tz_zone_localtime(&zone, TZIF_BENCH_FIRST + (int64_t)i * 6007, &local);
+            sink += local.tm_sec;
+        }
+        const double searchNs = bench_seconds(start) * 1e9 / TZIF_BENCH_CALLS;
+
+#ifdef _WIN32
+        printf("tzif %-22s transitions=%4d cached_ns=%6.1f search_ns=%6.1f\n", zones[z], zone.transitionCount, cachedNs, searchNs);
+#else
+        setenv("TZ", zones[z], 1);
+        tzset();
+
+        start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < TZIF_BENCH_CALLS; ++i) {
+            struct tm local;
+            const time_t t = (time_t)(1700000000 + i);
+            localtime_r(&t, &local);
+            sink += local.tm_sec;
+        }
+        const double libcNs = bench_seconds(start) * 1e9 / TZIF_BENCH_CALLS;
+
+        unsigned long samples = 0;
+        unsigned long mismatches = 0;
+        for (int64_t t = TZIF_BENCH_FIRST; t < TZIF_BENCH_LAST; t += TZIF_BENCH_STEP) {
+            const time_t tt = (time_t)t;
+            struct tm expected, actual;
+            localtime_r(&tt, &expected);
+            tz_zone_localtime(&zone, t, &actual);
+            samples++;
+            if (!same_tm(&expected, &actual)) mismatches++;
+        }
+        for (int i = 0; i < zone.transitionCount; ++i) {
+            for (int64_t d = -1; d <= 1; ++d) {
+                const time_t tt = (time_t)(zone.transitions[i] + d);
+                struct tm expected, actual;
+                localtime_r(&tt, &expected);
+                tz_zone_localtime(&zone, zone.transitions[i] + d, &actual);
+                samples++;
+                if (!same_tm(&expected, &actual)) mismatches++;
+            }
+        }
+        totalMismatches += mismatches;
+        printf("tzif %-22s transitions=%4d cached_ns=%6.1f search_ns=%6.1f localtime_r_ns=%6.1f samples=%lu mismatches=%lu\n",
+            zones[z], zone.transitionCount, cachedNs, searchNs, libcNs, samples, mismatches);
+#endif
+        (void)sink;
+        tz_zone_free(&zone);
+    }
+#ifndef _WIN32
+    if (hadTz) setenv("TZ", savedTz, 1);
+    else unsetenv("TZ");
+    tzset();
+#endif
+    // A zone that is not there checks nothing, it must not pass as a match
+    if (missing > 0 || compared == 0) {
+        fprintf(stderr, "tzif: %d of %d zones not found\n", missing, zoneCount);
+        return 1;
+    }
+    return totalMismatches == 0 ? 0 : 1;
+}
+
+// Every kernel must match the scalar blend bit for bit, timed on glyph-like coverage (mostly 0 or 255, some edges)
+#define BLEND_BENCH_PIXELS (1920 * 64)
+#define BLEND_BENCH_PASSES 200
+
+typedef struct {
+    const char* name;
+    CClockBlendSpanFn fn;
+    bool supported;
+} BlendKernel;
+
+static int bench_blend(int argc, char** argv) {
+    (void)argc; (void)argv;
+    const BlendKernel kernels[] = {
+        { "scalar", blend_span_scalar, true },
+#ifdef CCLOCK_BLEND_X86
+        { "sse2", blend_span_sse2, SDL_HasSSE2() },
+        { "avx2", blend_span_avx2, SDL_HasAVX2() },
+#endif
+    };
+    const int kernelCount = (int)(sizeof(kernels) / sizeof(kernels[0]));
+    const uint32_t colors[] = { 0xFFF5F5F5, 0xFF010101, 0x80FF5733 };
+
+    uint8_t* coverage = malloc(BLEND_BENCH_PIXELS);
+    uint32_t* background = malloc(sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+    uint32_t* expected = malloc(sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+    uint32_t* actual = malloc(sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+    if (!coverage || !background || !expected || !actual) {
+        fprintf(stderr, "bench: out of memory\n");
+        return 1;
+    }
+
+    uint32_t seed = 12345;
+    for (int i = 0; i < BLEND_BENCH_PIXELS; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const uint32_t r = seed >> 8;
+        coverage[i] = (r & 3) == 0 ? (uint8_t)(r >> 8) : (r & 1) ? 255 : 0;
+        seed = seed * 1664525u + 1013904223u;
+        background[i] = seed;
+    }
+
+    unsigned long mismatches = 0;
+    for (int k = 0; k < kernelCount; ++k) {
+        if (!kernels[k].supported) {
+            printf("blend %-6s not supported by this CPU\n", kernels[k].name);
+            continue;
+        }
+
+        // Odd offsets and lengths exercise the unaligned heads and tails
+        unsigned long kernelMismatches = 0;
+        for (int c = 0; c < (int)(sizeof(colors) / sizeof(colors[0])); ++c) {
+            for (int offset = 0; offset < 9; ++offset) {
+                const int count = BLEND_BENCH_PIXELS - offset - 7;
+                memcpy(expected, background, sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+                memcpy(actual, background, sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+                blend_span_scalar(expected + offset, coverage + offset, count, colors[c]);
+                kernels[k].fn(actual + offset, coverage + offset, count, colors[c]);
+                for (int i = 0; i < BLEND_BENCH_PIXELS; ++i) {
+                    if (expected[i] != actual[i]) kernelMismatches++;
+                }
+            }
+        }
+
+        memcpy(actual, background, sizeof(uint32_t) * BLEND_BENCH_PIXELS);
+        const Uint64 start = SDL_GetPerformanceCounter();
+        for (int pass = 0; pass < BLEND_BENCH_PASSES; ++pass) {
+            kernels[k].fn(actual, coverage, BLEND_BENCH_PIXELS, colors[pass % 3]);
+        }
+        const double pixelNs = bench_seconds(start) * 1e9 / ((double)BLEND_BENCH_PASSES * BLEND_BENCH_PIXELS);
+        printf("blend %-6s ns_per_pixel=%6.3f mismatches=%lu%s\n", kernels[k].name, pixelNs, kernelMismatches,
+            kernels[k].fn == blend_select_span() ? " (selected)" : "");
+        mismatches += kernelMismatches;
+    }
+
+    free(coverage);
+    free(background);
+    free(expected);
+    free(actual);
+    return mismatches == 0 ? 0 : 1;
+}
+
+// Software compositor frame time vs thread count at kiosk resolutions. "full" redraws every tile,
+// "tick" is the real workload where only the tiles under the changed digits are redrawn
+#define TILES_BENCH_FRAMES 30
+
+typedef struct {
+    int width;
+    int height;
+} BenchResolution;
+
+static void record_clock_frame(CClockCompositor* compositor, const BenchContext* ctx, int second, float scale) {
+    char timeStr[16];
+    snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", (second / 3600) % 24, (second / 60) % 60, second % 60);
+    const int x = compositor->width / 20;
+    const int y = compositor->height / 4;
+    compositor_clear(compositor, 0xFF000000);
+    compositor_draw_text(compositor, ctx->font64, "Monday 1 January 2024", x + 15 + 2, y - 40 + 2, scale, (SDL_Color) { 1, 1, 1, 255 });
+    compositor_draw_text(compositor, ctx->font256, timeStr, x + 4, y + 4, scale, (SDL_Color) { 1, 1, 1, 255 });
+    compositor_draw_text(compositor, ctx->font64, "Monday 1 January 2024", x + 15, y - 40, scale, (SDL_Color) { 245, 245, 245, 255 });
+    compositor_draw_text(compositor, ctx->font256, timeStr, x, y, scale, (SDL_Color) { 245, 245, 245, 255 });
+}
+
+static int bench_tiles(int argc, char** argv) {
+    (void)argc; (void)argv;
+    const BenchResolution resolutions[] = { { 1920, 1080 }, { 3840, 2160 }, { 7680, 4320 } };
+    // The renderer is not used, the offscreen driver avoids needing a display unless SDL_VIDEODRIVER says otherwise
+    SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, 64, 64)) goto done;
+    result = 0;
+
+    const int cpuCount = SDL_GetCPUCount();
+    for (int r = 0; r < (int)(sizeof(resolutions) / sizeof(resolutions[0])); ++r) {
+        const BenchResolution* res = &resolutions[r];
+        int textW = 0, textH = 0;
+        TTF_SizeText(ctx.font256, "00:00:00", &textW, &textH);
+        const float scale = textW > 0 ? res->width * 0.9f / textW : 1.f;
+
+        // Reference frame from a single thread, every other thread count must match it
+        CClockCompositor reference;
+        if (!compositor_init(&reference, NULL, res->width, res->height, NULL)) { result = 1; break; }
+        record_clock_frame(&reference, &ctx, 12 * 3600, scale);
+        compositor_render(&reference);
+
+        for (int threads = 1; ; threads = threads * 2 > cpuCount && threads < cpuCount ? cpuCount : threads * 2) {
+            CClockWorkerPool pool;
+            CClockCompositor compositor;
+            if (!worker_pool_init(&pool, threads) || !compositor_init(&compositor, NULL, res->width, res->height, &pool)) {
+                result = 1;
+                break;
+            }
+
+            Uint64 start = SDL_GetPerformanceCounter();
+            for (int frame = 0; frame < TILES_BENCH_FRAMES; ++frame) {
+                record_clock_frame(&compositor, &ctx, 12 * 3600, scale);
+                compositor_invalidate(&compositor);
+                compositor_render(&compositor);
+            }
+            const double fullMs = bench_seconds(start) * 1e3 / TILES_BENCH_FRAMES;
+            const bool same = memcmp(compositor.pixels, reference.pixels, sizeof(uint32_t) * (size_t)res->width * res->height) == 0;
+
+            int dirtyTiles = 0;
+            start = SDL_GetPerformanceCounter();
+            for (int frame = 1; frame <= TILES_BENCH_FRAMES; ++frame) {
+                record_clock_frame(&compositor, &ctx, 12 * 3600 + frame, scale);
+                dirtyTiles += compositor_render(&compositor);
+            }
+            const double tickMs = bench_seconds(start) * 1e3 / TILES_BENCH_FRAMES;
+
+            printf("tiles %4dx%-4d threads=%2d full_ms=%8.2f tick_ms=%7.2f dirty_tiles=%4d/%d steals=%d%s\n",
+                res->width, res->height, pool.threadCount, fullMs, tickMs, dirtyTiles / TILES_BENCH_FRAMES,
+                compositor.tileColumns * compositor.tileRows, SDL_AtomicGet(&pool.steals), same ? "" : " MISMATCH");
+            if (!same) result = 1;
+
+            compositor_destroy(&compositor);
+            worker_pool_destroy(&pool);
+            if (threads >= cpuCount) break;
+        }
+        compositor_destroy(&reference);
+    }
+
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// Soft shadows are baked once: reports the bake cost per radius (scalar vs SIMD blur, which must match)
+// and checks a 100 clock frame with soft shadows costs about the same as with hard ones
+#define SHADOW_BENCH_FRAMES 200
+#define SHADOW_BENCH_MAX_RATIO 1.5
+
+static double shadow_frame_us(BenchContext* ctx, const CClockGlyphAtlas* atlas, CClockWorldClock* worldClock) {
+    const SDL_Rect area = { 0, 0, BENCH_WIDTH, BENCH_HEIGHT };
+    const time_t now = time(NULL);
+    world_clock_render(ctx->renderer, worldClock, atlas, &area, now, true, (SDL_Color) { 245, 245, 245, 255 }, true);
+    const Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < SHADOW_BENCH_FRAMES; ++frame) {
+        SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 255);
+        SDL_RenderClear(ctx->renderer);
+        world_clock_render(ctx->renderer, worldClock, atlas, &area, now + frame, true, (SDL_Color) { 245, 245, 245, 255 }, true);
+        SDL_RenderPresent(ctx->renderer);
+    }
+    return bench_seconds(start) * 1e6 / SHADOW_BENCH_FRAMES;
+}
+
+static int bench_shadow(int argc, char** argv) {
+    (void)argc; (void)argv;
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, BENCH_WIDTH, BENCH_HEIGHT)) goto done;
+
+    // Bake cost on the biggest glyph we draw
+    SDL_Surface* glyph = TTF_RenderGlyph_Blended(ctx.font256, '8', (SDL_Color) { 255, 255, 255, 255 });
+    if (!glyph) goto done;
+    uint8_t* coverage = malloc((size_t)glyph->w * glyph->h);
+    uint8_t* simd = malloc((size_t)(glyph->w + 2 * BLUR_MAX_RADIUS) * (glyph->h + 2 * BLUR_MAX_RADIUS));
+    uint8_t* scalar = malloc((size_t)(glyph->w + 2 * BLUR_MAX_RADIUS) * (glyph->h + 2 * BLUR_MAX_RADIUS));
+    if (!coverage || !simd || !scalar) goto free_buffers;
+    SDL_LockSurface(glyph);
+    for (int y = 0; y < glyph->h; ++y) {
+        const Uint32* row = (const Uint32*)((const Uint8*)glyph->pixels + y * glyph->pitch);
+        for (int x = 0; x < glyph->w; ++x) coverage[y * glyph->w + x] = (uint8_t)(row[x] >> 24);
+    }
+    SDL_UnlockSurface(glyph);
+
+    result = 0;
+    const int radii[] = { 2, 4, 8, 16, 32 };
+    for (int r = 0; r < (int)(sizeof(radii) / sizeof(radii[0])); ++r) {
+        CClockBlurKernel kernel;
+        blur_kernel_init(&kernel, radii[r]);
+        const size_t outSize = (size_t)(glyph->w + 2 * radii[r]) * (glyph->h + 2 * radii[r]);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        blur_a8_scalar(scalar, coverage, glyph->w, glyph->h, &kernel);
+        const double scalarUs = bench_seconds(start) * 1e6;
+        start = SDL_GetPerformanceCounter();
+        blur_a8(simd, coverage, glyph->w, glyph->h, &kernel);
+        const double simdUs = bench_seconds(start) * 1e6;
+
+        const bool same = memcmp(simd, scalar, outSize) == 0;
+        printf("shadow blur %dx%d radius=%2d scalar_us=%8.1f simd_us=%8.1f%s\n",
+            glyph->w, glyph->h, radii[r], scalarUs, simdUs, same ? "" : " MISMATCH");
+        if (!same) result = 1;
+    }
+
+    // Per frame cost, hard shadow (glyph drawn twice) vs baked soft shadow (second page)
+    TTF_Font* const fonts[] = { ctx.font256, ctx.font64 };
+    const char* const charsets[] = { WORLD_CLOCK_TIME_CHARSET, WORLD_CLOCK_LABEL_CHARSET };
+    const int shadowRadii[] = { 8, 4 };
+    CClockGlyphAtlas hardAtlas, softAtlas;
+    Uint64 start = SDL_GetPerformanceCounter();
+    const bool hardBuilt = glyph_atlas_build(&hardAtlas, ctx.renderer, fonts, charsets, NULL, 2, false);
+    const double hardBakeMs = bench_seconds(start) * 1e3;
+    start = SDL_GetPerformanceCounter();
+    const bool softBuilt = glyph_atlas_build(&softAtlas, ctx.renderer, fonts, charsets, shadowRadii, 2, false);
+    const double softBakeMs = bench_seconds(start) * 1e3;
+
+    if (hardBuilt && softBuilt && softAtlas.shadowTexture) {
+        CClockZoneSpec defaults[8];
+        const int defaultCount = world_clock_default_zones(defaults, 8);
+        static CClockZoneSpec specs[100];
+        static CClockWorldClock worldClock;
+        for (int i = 0; i < 100; ++i) specs[i] = defaults[i % defaultCount];
+        world_clock_init(&worldClock, specs, 100);
+        const double hardUs = shadow_frame_us(&ctx, &hardAtlas, &worldClock);
+        const double softUs = shadow_frame_us(&ctx, &softAtlas, &worldClock);
+        world_clock_destroy(&worldClock);
+
+        const double ratio = hardUs > 0.0 ? softUs / hardUs : 0.0;
+        printf("shadow atlas bake_ms hard=%.1f soft=%.1f, 100 clocks frame_us hard=%.1f soft=%.1f ratio=%.2f (max %.2f)\n",
+            hardBakeMs, softBakeMs, hardUs, softUs, ratio, SHADOW_BENCH_MAX_RATIO);
+        if (ratio > SHADOW_BENCH_MAX_RATIO) result = 1;
+    }
+    else {
+        result = 1;
+    }
+    glyph_atlas_destroy(&hardAtlas);
+    glyph_atlas_destroy(&softAtlas);
+
+free_buffers:
+    free(coverage);
+    free(simd);
+    free(scalar);
+    SDL_FreeSurface(glyph);
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// Ticking clock drawn through the text cache vs a texture created and destroyed per string
+#define TEXT_BENCH_FRAMES 600
+
+static void draw_text_uncached(SDL_Renderer* renderer, TTF_Font* font, const char* text, int x, int y, SDL_Color color) {
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text, color);
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    const SDL_Rect dst = { x, y, surface ? surface->w : 0, surface ? surface->h : 0 };
+    SDL_RenderCopy(renderer, texture, NULL, &dst);
+    SDL_DestroyTexture(texture);
+    SDL_FreeSurface(surface);
+}
+
+static int bench_text(int argc, char** argv) {
+    (void)argc; (void)argv;
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, BENCH_WIDTH, BENCH_HEIGHT)) goto done;
+
+    const SDL_Color shadowColor = { 1, 1, 1, 255 };
+    const SDL_Color clockColor = { 245, 245, 245, 255 };
+    static CClockTextCache cache;
+    double frameUs[2];
+    for (int cached = 0; cached < 2; ++cached) {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < TEXT_BENCH_FRAMES; ++frame) {
+            char timeStr[16];
+            snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", 12, (frame / 60) % 60, frame % 60);
+            SDL_SetRenderDrawColor(ctx.renderer, 0, 0, 0, 255);
+            SDL_RenderClear(ctx.renderer);
+            if (cached) {
+                text_cache_draw(&cache, ctx.renderer, ctx.font64, "Monday 1 January 2024", 17, 2, 1.f, shadowColor);
+                text_cache_draw(&cache, ctx.renderer, ctx.font256, timeStr, 4, 44, 1.f, shadowColor);
+                text_cache_draw(&cache, ctx.renderer, ctx.font64, "Monday 1 January 2024", 15, 0, 1.f, clockColor);
+                text_cache_draw(&cache, ctx.renderer, ctx.font256, timeStr, 0, 40, 1.f, clockColor);
+            }
+            else {
+                draw_text_uncached(ctx.renderer, ctx.font64, "Monday 1 January 2024", 17, 2, shadowColor);
+                draw_text_uncached(ctx.renderer, ctx.font256, timeStr, 4, 44, shadowColor);
+                draw_text_uncached(ctx.renderer, ctx.font64, "Monday 1 January 2024", 15, 0, clockColor);
+                draw_text_uncached(ctx.renderer, ctx.font256, timeStr, 0, 40, clockColor);
+            }
+            SDL_RenderPresent(ctx.renderer);
+        }
+        frameUs[cached] = bench_seconds(start) * 1e6 / TEXT_BENCH_FRAMES;
+    }
+
+    printf("text frame_us create/destroy=%.1f pooled=%.1f\n", frameUs[0], frameUs[1]);
+    text_cache_report(&cache, stdout);
+    // Every frame after the first must be served by the same textures
+    result = cache.pool.misses <= 2 ? 0 : 1;
+    text_cache_clear(&cache);
+
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// Digit transitions on a simulated 60 Hz display, every style must settle in TRANSITION_DURATION_MS
+#define TRANSITION_BENCH_COUNT 10
+#define TRANSITION_BENCH_FRAME_MS 16
+
+static int bench_transition(int argc, char** argv) {
+    (void)argc; (void)argv;
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, BENCH_WIDTH, BENCH_HEIGHT)) goto done;
+
+    CClockGlyphAtlas atlas;
+    TTF_Font* const fonts[] = { ctx.font256, ctx.font64 };
+    const char* const charsets[] = { WORLD_CLOCK_TIME_CHARSET, WORLD_CLOCK_LABEL_CHARSET };
+    const int shadowRadii[] = { 8, 4 };
+    if (!glyph_atlas_build(&atlas, ctx.renderer, fonts, charsets, shadowRadii, 2, false)) goto done;
+
+    CClockGlyphBatch batch = { 0 };
+    CClockGlyphBatch shadowBatch = { 0 };
+    const unsigned maxFrames = TRANSITION_DURATION_MS / TRANSITION_BENCH_FRAME_MS + 2;
+    result = 0;
+    for (int style = CCLOCK_TRANSITION_FLIP; style < CCLOCK_TRANSITION_COUNT; ++style) {
+        CClockTransitions transitions = { .style = (CClockTransitionStyle)style };
+        uint64_t nowMs = 1000;
+        transitions_update(&transitions, "12:59:59", nowMs);
+
+        for (int t = 0; t < TRANSITION_BENCH_COUNT; ++t) {
+            char timeStr[16];
+            // Alternate between one digit and every digit changing
+            snprintf(timeStr, sizeof(timeStr), t % 2 ? "13:00:%02d" : "12:59:%02d", t);
+            nowMs += 1000;
+            transitions_update(&transitions, timeStr, nowMs);
+            do {
+                const Uint64 start = SDL_GetPerformanceCounter();
+                SDL_SetRenderDrawColor(ctx.renderer, 0, 0, 0, 255);
+                SDL_RenderClear(ctx.renderer);
+                transitions_push_text(&transitions, &shadowBatch, &atlas, WORLD_CLOCK_TIME_FACE, true, 4.f, 44.f, 1.f, (SDL_Color) { 1, 1, 1, 255 }, nowMs);
+                glyph_batch_flush_shadow(ctx.renderer, &atlas, &shadowBatch);
+                transitions_push_text(&transitions, &batch, &atlas, WORLD_CLOCK_TIME_FACE, false, 0.f, 40.f, 1.f, (SDL_Color) { 245, 245, 245, 255 }, nowMs);
+                glyph_batch_flush(ctx.renderer, &atlas, &batch);
+                SDL_RenderPresent(ctx.renderer);
+                transitions_frame_presented(&transitions, bench_seconds(start) * 1e3, nowMs);
+                nowMs += TRANSITION_BENCH_FRAME_MS;
+            } while (transitions_running(&transitions));
+        }
+
+        transitions_report(&transitions, stdout);
+        if (transitions.count != TRANSITION_BENCH_COUNT || transitions.maxFrames > maxFrames) result = 1;
+    }
+
+    glyph_batch_destroy(&batch);
+    glyph_batch_destroy(&shadowBatch);
+    glyph_atlas_destroy(&atlas);
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// Skin packs of growing size written as BMPs, then loaded and packed like at startup.
+// Every glyph must land in the atlas at its image size without overlapping another one
+#define SKIN_BENCH_DIR "bench-skin"
+#define SKIN_BENCH_RUNS 3
+
+static bool write_bench_skin(int glyphHeight) {
+    bench_mkdir(SKIN_BENCH_DIR);
+    FILE* manifest = NULL;
+#ifdef _WIN32
+    fopen_s(&manifest, SKIN_BENCH_DIR "/" SKIN_MANIFEST, "w");
+#else
+    manifest = fopen(SKIN_BENCH_DIR "/" SKIN_MANIFEST, "w");
+#endif
+    if (!manifest) return false;
+    fprintf(manifest, "name=bench %d\ntint=1\n", glyphHeight);
+
+    bool success = true;
+    for (const char* c = SKIN_REQUIRED_CHARSET; *c && success; ++c) {
+        // Digits 3:5, the colon narrower so the packer sees mixed sizes
+        const int w = *c == ':' ? glyphHeight / 5 : glyphHeight * 3 / 5;
+        SDL_Surface* image = SDL_CreateRGBSurfaceWithFormat(0, w, glyphHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!image) {
+            success = false;
+            break;
+        }
+        SDL_LockSurface(image);
+        for (int y = 0; y < image->h; ++y) {
+            Uint32* row = (Uint32*)((Uint8*)image->pixels + y * image->pitch);
+            for (int x = 0; x < image->w; ++x) row[x] = ((Uint32)((x ^ y ^ *c) & 0xFF) << 24) | 0x00FFFFFF;
+        }
+        SDL_UnlockSurface(image);
+        char file[32], path[64];
+        snprintf(file, sizeof(file), "glyph%d.bmp", (int)(c - SKIN_REQUIRED_CHARSET));
+        snprintf(path, sizeof(path), "%s/%s", SKIN_BENCH_DIR, file);
+        success = SDL_SaveBMP(image, path) == 0;
+        SDL_FreeSurface(image);
+        fprintf(manifest, "glyph=%c|%s\n", *c, file);
+    }
+    fclose(manifest);
+    return success;
+}
+
+static void remove_bench_skin(void) {
+    for (int i = 0; SKIN_REQUIRED_CHARSET[i]; ++i) {
+        char path[64];
+        snprintf(path, sizeof(path), "%s/glyph%d.bmp", SKIN_BENCH_DIR, i);
+        remove(path);
+    }
+    remove(SKIN_BENCH_DIR "/" SKIN_MANIFEST);
+    bench_rmdir(SKIN_BENCH_DIR);
+}
+
+static bool rects_overlap(const SDL_Rect* a, const SDL_Rect* b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static bool check_skin_atlas(const CClockGlyphAtlas* atlas, const CClockSkin* skin) {
+    const SDL_Rect* rects[GLYPH_ATLAS_MAX_FACES * GLYPH_ATLAS_CHAR_COUNT];
+    int count = 0;
+    for (int f = 0; f < atlas->faceCount; ++f) {
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+            const SDL_Rect* src = &atlas->faces[f].glyphs[ch].src;
+            if (src->w == 0) continue;
+            if (src->x < 0 || src->y < 0 || src->x + src->w > atlas->width || src->y + src->h > atlas->height) return false;
+            rects[count++] = src;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        for (int j = i + 1; j < count; ++j) {
+            if (rects_overlap(rects[i], rects[j])) return false;
+        }
+    }
+    for (const char* c = SKIN_REQUIRED_CHARSET; *c; ++c) {
+        const CClockGlyph* glyph = &atlas->faces[WORLD_CLOCK_TIME_FACE].glyphs[(unsigned char)*c];
+        const SDL_Surface* image = skin->images.surfaces[(unsigned char)*c];
+        if (glyph->src.w != image->w || glyph->src.h != image->h || glyph->advance != image->w) return false;
+    }
+    return atlas->faces[WORLD_CLOCK_TIME_FACE].lineHeight == skin->images.metrics.lineHeight;
+}
+
+static int bench_skin(int argc, char** argv) {
+    (void)argc; (void)argv;
+    BenchContext ctx;
+    int result = 1;
+    if (!bench_context_init(&ctx, BENCH_WIDTH, BENCH_HEIGHT)) goto done;
+
+    TTF_Font* const fonts[] = { ctx.font256, ctx.font64 };
+    const char* const charsets[] = { WORLD_CLOCK_TIME_CHARSET, WORLD_CLOCK_LABEL_CHARSET };
+    const int shadowRadii[] = { 8, 4 };
+    const int heights[] = { 128, 256, 512, 1024 };
+    result = 0;
+    for (int h = 0; h < (int)(sizeof(heights) / sizeof(heights[0])) && result == 0; ++h) {
+        if (!write_bench_skin(heights[h])) {
+            fprintf(stderr, "bench: could not write the %d px skin\n", heights[h]);
+            result = 1;
+            break;
+        }
+
+        // Best of a few runs, the first one also pays for the cold file cache
+        double loadMs = 1e9, buildMs = 1e9;
+        long imageBytes = 0;
+        int atlasHeight = 0;
+        for (int run = 0; run < SKIN_BENCH_RUNS && result == 0; ++run) {
+            CClockSkin skin;
+            CClockGlyphAtlas atlas;
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (!skin_load(&skin, SKIN_BENCH_DIR)) {
+                result = 1;
+                break;
+            }
+            loadMs = SDL_min(loadMs, bench_seconds(start) * 1e3);
+
+            const CClockGlyphImages* const images[] = { &skin.images, NULL };
+            start = SDL_GetPerformanceCounter();
+            const bool built = glyph_atlas_build_images(&atlas, ctx.renderer, fonts, charsets, images, shadowRadii, 2, false);
+            buildMs = SDL_min(buildMs, bench_seconds(start) * 1e3);
+
+            if (!built || !check_skin_atlas(&atlas, &skin)) result = 1;
+            imageBytes = 0;
+            for (const char* c = SKIN_REQUIRED_CHARSET; *c; ++c) {
+                const SDL_Surface* image = skin.images.surfaces[(unsigned char)*c];
+                imageBytes += (long)image->w * image->h * 4;
+            }
+            atlasHeight = atlas.height;
+            glyph_atlas_destroy(&atlas);
+            skin_free(&skin);
+        }
+        printf("skin glyph_h=%4d images_kb=%6ld load_ms=%7.1f atlas_ms=%7.1f atlas=%dx%d%s\n",
+            heights[h], imageBytes / 1024, loadMs, buildMs, GLYPH_ATLAS_WIDTH, atlasHeight, result ? " FAILED" : "");
+    }
+    remove_bench_skin();
+done:
+    bench_context_destroy(&ctx);
+    return result;
+}
+
+// 10k recurring alarms over 45 days of simulated time: cost of the heap top check the event loop does
+// vs scanning every rule, and of recomputing the alarm that fired. Fire times are checked against a
+// day by day scan with alarm_rule_matches
+#define ALARM_BENCH_RULES 10000
+#define ALARM_BENCH_DAYS 45
+#define ALARM_BENCH_CHECK_EVERY 50
+
+static void bench_localtime(time_t t, struct tm* out) {
+#ifdef _WIN32
+    localtime_s(out, &t);
+#else
+    localtime_r(&t, out);
+#endif
+}
+
+static time_t reference_next(const CClockAlarmRule* rule, time_t after) {
+    struct tm now;
+    bench_localtime(after, &now);
+    for (int i = 0; i < 400; ++i) {
+        struct tm day = { 0 };
+        day.tm_year = now.tm_year;
+        day.tm_mon = now.tm_mon;
+        day.tm_mday = now.tm_mday + i;
+        day.tm_hour = 12;
+        day.tm_isdst = -1;
+        mktime(&day);
+        if (!alarm_rule_matches(rule, &day)) continue;
+        if (i == 0 && now.tm_hour * 60 + now.tm_min >= rule->minute) continue;
+        day.tm_hour = rule->minute / 60;
+        day.tm_min = rule->minute % 60;
+        day.tm_isdst = -1;
+        const time_t t = mktime(&day);
+        if (t > after) return t;
+    }
+    return ALARM_NEVER;
+}
+
+// Same wall time, possibly the other occurrence of an hour repeated by the end of DST
+static bool same_fire_time(time_t actual, time_t expected) {
+    if (actual == expected) return true;
+    if (actual == ALARM_NEVER || expected == ALARM_NEVER || (actual - expected != 3600 && expected - actual != 3600)) return false;
+    struct tm a, e;
+    bench_localtime(actual, &a);
+    bench_localtime(expected, &e);
+    return a.tm_hour == e.tm_hour && a.tm_min == e.tm_min && a.tm_mday == e.tm_mday;
+}
+
+static int bench_alarms(int argc, char** argv) {
+    (void)argc; (void)argv;
+    static const char* const days[] = { "daily", "weekdays", "weekends", "mon,wed,fri", "tue,thu", "last fri", "1st mon", "3rd wed", "5th sun", "day 31", "day 15" };
+    const int dayCount = (int)(sizeof(days) / sizeof(days[0]));
+    // Feb 20th + 45 days: two month rollovers and the spring DST change in the US and in Europe
+    struct tm startTm = { .tm_year = 125, .tm_mon = 1, .tm_mday = 20, .tm_isdst = -1 };
+    const time_t start = mktime(&startTm);
+    const time_t end = start + ALARM_BENCH_DAYS * 86400;
+
+    CClockAlarms alarms = { 0 };
+    static time_t expected[ALARM_BENCH_RULES];
+    srand(42);
+    Uint64 timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < ALARM_BENCH_RULES; ++i) {
+        char text[64];
+        snprintf(text, sizeof(text), "%s %02d:%02d", days[i % dayCount], rand() % 24, rand() % 60);
+        CClockAlarmRule rule;
+        if (!alarm_rule_parse(&rule, text) || !alarms_add(&alarms, &rule, text, start)) {
+            fprintf(stderr, "bench: could not add alarm '%s'\n", text);
+            alarms_destroy(&alarms);
+            return 1;
+        }
+    }
+    const double buildMs = bench_seconds(timer) * 1e3;
+    for (int i = 0; i < ALARM_BENCH_RULES; i += ALARM_BENCH_CHECK_EVERY) expected[i] = reference_next(&alarms.alarms[i].rule, start);
+
+    // What the event loop does every wakeup: heap top vs the minimum over every rule
+    volatile time_t sink = 0;
+    timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < 1000; ++i) sink += alarms_next(&alarms);
+    const double peekNs = bench_seconds(timer) * 1e9 / 1000;
+    timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < 10; ++i) {
+        time_t earliest = ALARM_NEVER;
+        for (int a = 0; a < alarms.heapCount; ++a) {
+            if (earliest == ALARM_NEVER || alarms.heap[a].next < earliest) earliest = alarms.heap[a].next;
+        }
+        sink += earliest;
+    }
+    const double scanNs = bench_seconds(timer) * 1e9 / 10;
+
+    int result = 0;
+    unsigned long fires = 0, checked = 0, mismatches = 0, outOfOrder = 0;
+    time_t last = start;
+    const unsigned long recomputesBefore = alarms.recomputes;
+    int fired[64];
+    timer = SDL_GetPerformanceCounter();
+    double checkSeconds = 0.0;
+    while (alarms_next(&alarms) != ALARM_NEVER && alarms_next(&alarms) < end) {
+        const time_t now = alarms_next(&alarms);
+        if (now < last) outOfOrder++;
+        last = now;
+        const int count = alarms_fire_due(&alarms, now, fired, 64);
+        fires += count;
+
+        const Uint64 checkStart = SDL_GetPerformanceCounter();
+        for (int f = 0; f < count && f < 64; ++f) {
+            if (fired[f] % ALARM_BENCH_CHECK_EVERY != 0) continue;
+            checked++;
+            if (!same_fire_time(now, expected[fired[f]])) mismatches++;
+            expected[fired[f]] = reference_next(&alarms.alarms[fired[f]].rule, now);
+        }
+        checkSeconds += bench_seconds(checkStart);
+    }
+    const double fireNs = (bench_seconds(timer) - checkSeconds) * 1e9 / (fires ? fires : 1);
+    (void)sink;
+
+    printf("alarms rules=%d build_ms=%.1f next_ns=%.1f scan_all_ns=%.0f\n", ALARM_BENCH_RULES, buildMs, peekNs, scanNs);
+    printf("alarms %d days fires=%lu recomputes=%lu fire_ns=%.0f checked=%lu mismatches=%lu out_of_order=%lu\n",
+        ALARM_BENCH_DAYS, fires, alarms.recomputes - recomputesBefore, fireNs, checked, mismatches, outOfOrder);
+    // One recompute per fire, never a pass over every rule
+    if (mismatches || outOfOrder || fires == 0 || alarms.recomputes - recomputesBefore != fires) result = 1;
+    alarms_destroy(&alarms);
+    return result;
+}
+
+// Compiled formats vs strftime and vs parsing the format every frame. The output is checked against
+// strftime and the refresh period against a second by second walk over the EU spring DST change:
+// the text must only change on a refresh boundary
+#define FORMAT_BENCH_ITERATIONS 200000
+#define FORMAT_BENCH_TIMES 1024
+
+static int bench_format(int argc, char** argv) {
+    (void)argc; (void)argv;
+    static const char* const formats[] = { "%H:%M", "%H:%M:%S", "%I:%M %p", "%H h", "%A %d %B %Y", "%a %d %b %y", "%Y-%m-%d", "day %j, 100%%" };
+    const int formatCount = (int)(sizeof(formats) / sizeof(formats[0]));
+    // Saturday March 29th 2025, two days later Europe is on summer time
+    struct tm startTm = { .tm_year = 125, .tm_mon = 2, .tm_mday = 29, .tm_isdst = -1 };
+    const time_t start = mktime(&startTm);
+    const int walkSeconds = 3 * 86400;
+
+    static struct tm times[FORMAT_BENCH_TIMES];
+    for (int i = 0; i < FORMAT_BENCH_TIMES; ++i) bench_localtime(start + (time_t)i * 7919, &times[i]);
+
+    int result = 0;
+    for (int f = 0; f < formatCount; ++f) {
+        CClockFormat format;
+        if (!format_compile(&format, formats[f])) {
+            result = 1;
+            continue;
+        }
+        const int refresh = format_refresh_seconds(format.fields);
+
+        unsigned long mismatches = 0, earlyChanges = 0;
+        char text[FORMAT_MAX_TEXT], expected[FORMAT_MAX_TEXT], previous[FORMAT_MAX_TEXT] = "";
+        for (int s = 0; s < walkSeconds; ++s) {
+            struct tm tm;
+            bench_localtime(start + s, &tm);
+            format_apply(&format, &tm, text, sizeof(text));
+            strftime(expected, sizeof(expected), formats[f], &tm);
+            if (strcmp(text, expected) != 0) mismatches++;
+            const long secondOfDay = tm.tm_hour * 3600L + tm.tm_min * 60L + tm.tm_sec;
+            if (s > 0 && strcmp(text, previous) != 0 && secondOfDay % refresh != 0) earlyChanges++;
+            SDL_strlcpy(previous, text, sizeof(previous));
+        }
+
+        volatile size_t sink = 0;
+        Uint64 timer = SDL_GetPerformanceCounter();
+        for (int i = 0; i < FORMAT_BENCH_ITERATIONS; ++i) sink += format_apply(&format, &times[i % FORMAT_BENCH_TIMES], text, sizeof(text));
+        const double applyNs = bench_seconds(timer) * 1e9 / FORMAT_BENCH_ITERATIONS;
+        timer = SDL_GetPerformanceCounter();
+        for (int i = 0; i < FORMAT_BENCH_ITERATIONS; ++i) sink += strftime(text, sizeof(text), formats[f], &times[i % FORMAT_BENCH_TIMES]);
+        const double strftimeNs = bench_seconds(timer) * 1e9 / FORMAT_BENCH_ITERATIONS;
+        timer = SDL_GetPerformanceCounter();
+        for (int i = 0; i < FORMAT_BENCH_ITERATIONS; ++i) {
+            CClockFormat parsed;
+            format_compile(&parsed, formats[f]);
+            sink += format_apply(&parsed, &times[i % FORMAT_BENCH_TIMES], text, sizeof(text));
+        }
+        const double reparseNs = bench_seconds(timer) * 1e9 / FORMAT_BENCH_ITERATIONS;
+        (void)sink;
+
+        printf("format '%s' fields=0x%02x refresh_s=%d apply_ns=%.0f strftime_ns=%.0f reparse_ns=%.0f mismatches=%lu early_changes=%lu\n",
+            formats[f], format.fields, refresh, applyNs, strftimeNs, reparseNs, mismatches, earlyChanges);
+        if (mismatches || earlyChanges) result = 1;
+    }
+    return result;
+}
+
+// One tick of libcclock (snapshot, text, next wakeup) per mode over three days of a fixed source across the EU
+// spring DST change. The clock text is checked against strftime, the countdown against the seconds left, and
+// jumping from one wakeup to the next like the event loop must see every change a second by second walk sees
+#define ENGINE_BENCH_DAYS 3
+
+typedef struct {
+    const char* name;
+    const char* timeFormat;     // strftime compatible, it is the reference
+    const char* dateFormat;
+    long chronoSeconds;         // > 0: a countdown of that length from the start
+} EngineBenchCase;
+
+static int bench_engine(int argc, char** argv) {
+    (void)argc; (void)argv;
+    static const EngineBenchCase cases[] = {
+        { "clock", "%H:%M:%S", "%A %d %B %Y", 0 },
+        { "clock-minutes", "%I:%M %p", "%a %d %b", 0 },
+        { "chrono", "%H:%M:%S", "%A %d %B %Y", 36 * 3600L },
+    };
+    // Saturday March 29th 2025, two days later Europe is on summer time
+    struct tm startTm = { .tm_year = 125, .tm_mon = 2, .tm_mday = 29, .tm_isdst = -1 };
+    const time_t start = mktime(&startTm);
+    const long walkSeconds = ENGINE_BENCH_DAYS * 86400L;
+
+    int result = 0;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        const EngineBenchCase* bench = &cases[c];
+        CClockTimeSource source = { .kind = CCLOCK_TIME_FIXED, .originNs = (int64_t)start * 1000000000 };
+        CClockEngine engine;
+        cclock_engine_init(&engine, &source);
+        if (!cclock_engine_set_formats(&engine, bench->timeFormat, bench->dateFormat)) {
+            result = 1;
+            continue;
+        }
+        CClockSnapshot now;
+        cclock_snapshot(&engine, &now);
+        if (bench->chronoSeconds > 0) cclock_chrono_start(&engine, &now, bench->chronoSeconds);
+
+        CClockText text;
+        volatile long sink = 0;
+        Uint64 timer = SDL_GetPerformanceCounter();
+        for (long s = 0; s < walkSeconds; ++s) {
+            time_source_set(&source, (int64_t)(start + s) * 1000000000);
+            cclock_snapshot(&engine, &now);
+            cclock_build_text(&engine, &now, NULL, &text);
+            sink += cclock_wall_ms_until_next_tick(&engine, &now);
+        }
+        const double tickNs = bench_seconds(timer) * 1e9 / walkSeconds;
+        (void)sink;
+
+        unsigned long mismatches = 0, changes = 0, wakeups = 0, jumpChanges = 0;
+        char expected[FORMAT_MAX_TEXT], previous[2 * FORMAT_MAX_TEXT] = "", current[2 * FORMAT_MAX_TEXT];
+        for (long s = 0; s < walkSeconds; ++s) {
+            time_source_set(&source, (int64_t)(start + s) * 1000000000);
+            cclock_snapshot(&engine, &now);
+            cclock_build_text(&engine, &now, NULL, &text);
+            if (bench->chronoSeconds > 0) {
+                const long left = bench->chronoSeconds > s ? bench->chronoSeconds - s : 0;
+                snprintf(expected, sizeof(expected), "%02ld:%02ld:%02ld", left / 3600, left % 3600 / 60, left % 60);
+                if (text.chronoLeft != left || text.alert != (left == 0)) mismatches++;
+            }
+            else strftime(expected, sizeof(expected), bench->timeFormat, &now.local);
+            if (strcmp(text.timeStr, expected) != 0) mismatches++;
+            snprintf(current, sizeof(current), "%s|%s", text.timeStr, text.dateStr);
+            if (strcmp(current, previous) != 0) changes++;
+            SDL_strlcpy(previous, current, sizeof(previous));
+        }
+
+        previous[0] = '\0';
+        time_source_set(&source, (int64_t)start * 1000000000);
+        for (cclock_snapshot(&engine, &now); now.now < start + walkSeconds; cclock_snapshot(&engine, &now)) {
+            cclock_build_text(&engine, &now, NULL, &text);
+            snprintf(current, sizeof(current), "%s|%s", text.timeStr, text.dateStr);
+            if (strcmp(current, previous) != 0) jumpChanges++;
+            SDL_strlcpy(previous, current, sizeof(previous));
+            wakeups++;
+            const long wallMs = cclock_wall_ms_until_next_tick(&engine, &now);
+            time_source_set(&source, now.nowNs + (int64_t)(wallMs > 0 ? wallMs : 1000) * 1000000);
+        }
+
+        printf("engine '%s' refresh_s=%d tick_ns=%.0f changes=%lu wakeups=%lu missed_changes=%ld mismatches=%lu\n",
+            bench->name, cclock_refresh_seconds(&engine), tickNs, changes, wakeups, (long)changes - (long)jumpChanges, mismatches);
+        if (mismatches || changes != jumpChanges) result = 1;
+    }
+    return result;
+}
+
+// Scratch stream for the benches that write files, tmpfile is a C4996 error in the MSVC build
+static FILE* bench_tmpfile(void) {
+    FILE* file = NULL;
+#ifdef _WIN32
+    if (tmpfile_s(&file) != 0) return NULL;
+#else
+    file = tmpfile();
+#endif
+    return file;
+}
+
+// Cost of a log call for the caller vs a plain fprintf on the same stream. Several threads overflow the
+// ring on purpose: every message must end up either in the file or in the dropped count
+#define LOG_BENCH_THREADS 4
+#define LOG_BENCH_MESSAGES 100000
+
+static int log_bench_producer(void* data) {
+    double* ns = data;
+    const Uint64 timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < LOG_BENCH_MESSAGES; ++i) log_write(LOG_LEVEL_INFO, "wheel %d scale %.2f", i, i * 0.001);
+    *ns = bench_seconds(timer) * 1e9 / LOG_BENCH_MESSAGES;
+    return 0;
+}
+
+static int bench_log(int argc, char** argv) {
+    (void)argc; (void)argv;
+    FILE* out = bench_tmpfile();
+    if (!out) return 1;
+
+    Uint64 timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < LOG_BENCH_MESSAGES; ++i) {
+        fprintf(out, "[%8.3f] I wheel %d scale %.2f\n", SDL_GetTicks64() / 1000.0, i, i * 0.001);
+        fflush(out);
+    }
+    const double fprintfNs = bench_seconds(timer) * 1e9 / LOG_BENCH_MESSAGES;
+
+    const unsigned long writtenBefore = log_written(), droppedBefore = log_dropped();
+    if (!log_start(out, LOG_LEVEL_INFO)) {
+        fclose(out);
+        return 1;
+    }
+    SDL_Thread* threads[LOG_BENCH_THREADS];
+    double producerNs[LOG_BENCH_THREADS] = { 0 };
+    for (int t = 0; t < LOG_BENCH_THREADS; ++t) threads[t] = SDL_CreateThread(log_bench_producer, "bench-log", &producerNs[t]);
+    double logNs = 0;
+    for (int t = 0; t < LOG_BENCH_THREADS; ++t) {
+        if (threads[t]) SDL_WaitThread(threads[t], NULL);
+        logNs += producerNs[t] / LOG_BENCH_THREADS;
+    }
+
+    // Below the runtime level: one atomic load, the arguments are not even evaluated
+    volatile int sink = 0;
+    timer = SDL_GetPerformanceCounter();
+    for (int i = 0; i < LOG_BENCH_MESSAGES; ++i) LOG_DEBUG("hit test %d", sink++);
+    const double filteredNs = bench_seconds(timer) * 1e9 / LOG_BENCH_MESSAGES;
+    log_stop();
+
+    const unsigned long written = log_written() - writtenBefore, dropped = log_dropped() - droppedBefore;
+    unsigned long lines = 0;
+    rewind(out);
+    for (int c = fgetc(out); c != EOF; c = fgetc(out)) lines += c == '\n';
+    fclose(out);
+
+    printf("log threads=%d messages=%d fprintf_ns=%.0f log_ns=%.0f filtered_ns=%.1f written=%lu dropped=%lu\n",
+        LOG_BENCH_THREADS, LOG_BENCH_THREADS * LOG_BENCH_MESSAGES, fprintfNs, logNs, filteredNs, written, dropped);
+    const bool accounted = written + dropped == (unsigned long)LOG_BENCH_THREADS * LOG_BENCH_MESSAGES
+        && lines == LOG_BENCH_MESSAGES + written && sink == 0;
+    return accounted ? 0 : 1;
+}
+
+// Terminal front end over an hour of clock then a countdown: every update is played into a small VT
+// emulator that must end up showing the frame, and against a full redraw of every tick
+#define TERM_BENCH_ROWS 40
+#define TERM_BENCH_COLS 120
+#define TERM_BENCH_SECONDS 3600L
+#define TERM_BENCH_CHRONO 600L
+
+typedef struct {
+    CClockTermCell cells[TERM_BENCH_ROWS * TERM_BENCH_COLS];
+    int rows;
+    int cols;
+    int row;
+    int col;
+    uint8_t alert;
+    char title[CCLOCK_TITLE_MAX];
+} TermBenchScreen;
+
+static int parse_term_number(const char** p, const char* end) {
+    int value = 0;
+    while (*p < end && **p >= '0' && **p <= '9') value = value * 10 + *(*p)++ - '0';
+    return value;
+}
+
+// The subset term.c writes: CUP, SGR 0 and 31, OSC 0 titles, cursor visibility, ASCII and U+2588
+static bool term_bench_play(TermBenchScreen* screen, const char* bytes, size_t length) {
+    const char* p = bytes;
+    const char* end = bytes + length;
+    while (p < end) {
+        if (*p == '\x1b' && p + 1 < end && p[1] == '[') {
+            p += 2;
+            const bool private = p < end && *p == '?';
+            if (private) p++;
+            const int first = parse_term_number(&p, end);
+            int second = 0;
+            if (p < end && *p == ';') {
+                p++;
+                second = parse_term_number(&p, end);
+            }
+            if (p >= end) return false;
+            const char final = *p++;
+            if (final == 'H' && !private) {
+                screen->row = first - 1;
+                screen->col = second - 1;
+            }
+            else if (final == 'm' && !private) screen->alert = first == 31;
+            else if (!private || (final != 'h' && final != 'l')) return false;
+            continue;
+        }
+        if (*p == '\x1b' && p + 1 < end && p[1] == ']') {
+            const char* bell = memchr(p, '\x07', (size_t)(end - p));
+            if (!bell || p + 4 > bell || strncmp(p + 2, "0;", 2) != 0) return false;
+            snprintf(screen->title, sizeof(screen->title), "%.*s", (int)(bell - p - 4), p + 4);
+            p = bell + 1;
+            continue;
+        }
+        uint8_t ch;
+        if ((unsigned char)*p == 0xe2 && p + 2 < end && (unsigned char)p[1] == 0x96 && (unsigned char)p[2] == 0x88) {
+            ch = TERM_CELL_BLOCK;
+            p += 3;
+        }
+        else if (*p == '#' || ((unsigned char)*p >= 0x20 && (unsigned char)*p < 0x7f)) ch = (uint8_t)*p++;
+        else return false;
+        // Pending wrap after the last column
+        if (screen->col >= screen->cols) {
+            screen->col = 0;
+            screen->row++;
+        }
+        if (screen->row < 0 || screen->row >= screen->rows || screen->col < 0) return false;
+        screen->cells[screen->row * screen->cols + screen->col++] = (CClockTermCell){ ch, screen->alert };
+    }
+    return true;
+}
+
+static bool term_bench_matches(const TermBenchScreen* screen, const CClockTerm* term, const CClockText* text) {
+    if (strcmp(screen->title, text->windowTitle) != 0) return false;
+    for (int i = 0; i < term->rows * term->cols; ++i) {
+        const CClockTermCell shown = screen->cells[i], wanted = term->frame[i];
+        if (shown.ch != wanted.ch || (shown.alert != wanted.alert && wanted.ch != ' ')) return false;
+    }
+    return true;
+}
+
+static int bench_term(int argc, char** argv) {
+    (void)argc; (void)argv;
+    FILE* sink = bench_tmpfile();
+    if (!sink) return 1;
+    CClockTerm term, full;
+    if (!term_init(&term, bench_fileno(sink), TERM_BENCH_ROWS, TERM_BENCH_COLS, false)
+        || !term_init(&full, bench_fileno(sink), TERM_BENCH_ROWS, TERM_BENCH_COLS, false)) {
+        fclose(sink);
+        return 1;
+    }
+    static TermBenchScreen screen;
+    memset(&screen, 0, sizeof(screen));
+    screen.rows = TERM_BENCH_ROWS;
+    screen.cols = TERM_BENCH_COLS;
+
+    struct tm startTm = { .tm_year = 125, .tm_mon = 2, .tm_mday = 29, .tm_hour = 23, .tm_min = 30, .tm_isdst = -1 };
+    const time_t start = mktime(&startTm);
+    CClockTimeSource source = { .kind = CCLOCK_TIME_FIXED, .originNs = (int64_t)start * 1000000000 };
+    CClockEngine engine;
+    cclock_engine_init(&engine, &source);
+
+    unsigned long ticks = 0, updates = 0, mismatches = 0;
+    unsigned long long fullBytes = 0;
+    double updateNs = 0;
+    CClockSnapshot now;
+    CClockText text;
+    for (long s = 0; s < 2 * TERM_BENCH_SECONDS; ++s) {
+        time_source_set(&source, (int64_t)(start + s) * 1000000000);
+        cclock_snapshot(&engine, &now);
+        if (s == TERM_BENCH_SECONDS) cclock_chrono_start(&engine, &now, TERM_BENCH_CHRONO);
+        cclock_build_text(&engine, &now, NULL, &text);
+
+        const Uint64 timer = SDL_GetPerformanceCounter();
+        const size_t bytes = term_update(&term, &text);
+        updateNs += bench_seconds(timer) * 1e9;
+        if (!term_bench_play(&screen, term.out, term.outLength) || !term_bench_matches(&screen, &term, &text)) mismatches++;
+        if (bytes > 0) {
+            updates++;
+            if (!term_flush(&term)) mismatches++;
+        }
+
+        term_resize(&full, TERM_BENCH_ROWS, TERM_BENCH_COLS);
+        fullBytes += term_update(&full, &text);
+        ticks++;
+    }
+
+    // Too small for the big digits, and the first update after a resize
+    if (!term_resize(&term, 4, 20)) mismatches++;
+    screen.rows = 4;
+    screen.cols = 20;
+    time_source_set(&source, (int64_t)start * 1000000000);
+    cclock_engine_init(&engine, &source);
+    cclock_snapshot(&engine, &now);
+    cclock_build_text(&engine, &now, "Wake up", &text);
+    term_update(&term, &text);
+    if (!term_bench_play(&screen, term.out, term.outLength) || !term_bench_matches(&screen, &term, &text)) mismatches++;
+
+    printf("term %dx%d ticks=%lu updates=%lu bytes_per_tick=%.1f full_redraw_bytes_per_tick=%.1f writes_per_tick=%.3f update_ns=%.0f mismatches=%lu\n",
+        TERM_BENCH_COLS, TERM_BENCH_ROWS, ticks, updates, (double)term.bytes / ticks, (double)fullBytes / ticks,
+        (double)term.writes / ticks, updateNs / ticks, mismatches);
+    const bool ok = mismatches == 0 && term.writes <= updates && term.bytes < fullBytes;
+    term_destroy(&term);
+    term_destroy(&full);
+    fclose(sink);
+    return ok ? 0 : 1;
+}
+
+// --stream on the real clock: a few ticks then a short countdown as JSON. Every line must be one second
+// after the previous one and each wakeup close to its boundary
+#define STREAM_BENCH_TICKS 5
+#define STREAM_BENCH_CHRONO 2
+#define STREAM_BENCH_MAX_LATE_US 50000.0
+
+static int bench_stream(int argc, char** argv) {
+    (void)argc; (void)argv;
+    FILE* out = bench_tmpfile();
+    if (!out) return 1;
+    CClockTimeSource source = { .kind = CCLOCK_TIME_REAL };
+    CClockEngine engine;
+    cclock_engine_init(&engine, &source);
+
+    CClockStreamStats clock, chrono;
+    const CClockStreamOptions clockOptions = { .json = true, .count = STREAM_BENCH_TICKS };
+    const CClockStreamOptions chronoOptions = { .json = true, .chronoSeconds = STREAM_BENCH_CHRONO };
+    stream_run(&engine, NULL, &clockOptions, out, &clock);
+    stream_run(&engine, NULL, &chronoOptions, out, &chrono);
+
+    // Clock ticks, then the countdown from STREAM_BENCH_CHRONO down to 0
+    unsigned long lines = 0, errors = 0;
+    long long previous = 0;
+    char line[256], event[16];
+    rewind(out);
+    while (fgets(line, sizeof(line), out)) {
+        long long epoch;
+#ifdef _WIN32
+        const int fields = sscanf_s(line, "{\"event\":\"%15[^\"]\",\"epoch\":%lld", event, (unsigned)sizeof(event), &epoch);
+#else
+        const int fields = sscanf(line, "{\"event\":\"%15[^\"]\",\"epoch\":%lld", event, &epoch);
+#endif
+        if (fields != 2) {
+            errors++;
+            continue;
+        }
+        const bool isChrono = lines >= STREAM_BENCH_TICKS;
+        if (strcmp(event, isChrono ? "chrono" : "tick") != 0) errors++;
+        // The countdown prints its first line at once, in the second of the last clock tick
+        const bool restart = lines == STREAM_BENCH_TICKS;
+        if (lines > 0 && epoch != previous + (restart ? 0 : 1)) errors++;
+        if (isChrono) {
+            const long expectedLeft = STREAM_BENCH_CHRONO - (long)(lines - STREAM_BENCH_TICKS);
+            char expected[32];
+            snprintf(expected, sizeof(expected), "\"left\":%ld,", expectedLeft);
+            if (!strstr(line, expected) || !strstr(line, expectedLeft == 0 ? "\"done\":true" : "\"done\":false")) errors++;
+        }
+        previous = epoch;
+        lines++;
+    }
+    fclose(out);
+
+    const double maxLateUs = clock.maxLateUs > chrono.maxLateUs ? clock.maxLateUs : chrono.maxLateUs;
+    printf("stream lines=%lu startup_us=%.0f mean_late_us=%.0f max_late_us=%.0f errors=%lu\n",
+        lines, clock.startupUs, clock.meanLateUs, maxLateUs, errors);
+    return errors == 0 && lines == STREAM_BENCH_TICKS + STREAM_BENCH_CHRONO + 1 && maxLateUs < STREAM_BENCH_MAX_LATE_US ? 0 : 1;
+}
+
+// Control socket round trips: a client thread sends single commands then batches while the bench thread
+// plays the event loop (wait for the event, apply, build the text, reply). A batch must cost one wakeup
+#define CONTROL_BENCH_ROUNDS 400
+#define CONTROL_BENCH_BATCHES 50
+
+static const char* const g_controlBatch[] = {
+    "style hh:mm", "mode world", "list", "style analog", "mode clock", "start 10m", "cancel", "style hh:mm:ss",
+    "start 2h", "list", "cancel", "mode world", "mode clock", "start 90s", "list",
+};
+
+typedef struct {
+    char name[64];
+    FILE* replies;
+    uint64_t singleNs[CONTROL_BENCH_ROUNDS];
+    double batchUs;
+    int failed;
+    SDL_atomic_t finished;
+} ControlBench;
+
+static int control_bench_client(void* data) {
+    ControlBench* bench = data;
+    for (int r = 0; r < CONTROL_BENCH_ROUNDS; ++r) {
+        const char* command = r % 2 ? "cancel" : "start 90s";
+        const Uint64 timer = SDL_GetPerformanceCounter();
+        if (control_send(bench->name, &command, 1, bench->replies) != 0) bench->failed++;
+        bench->singleNs[r] = (uint64_t)(bench_seconds(timer) * 1e9);
+    }
+    const int batchCount = (int)(sizeof(g_controlBatch) / sizeof(g_controlBatch[0]));
+    const Uint64 timer = SDL_GetPerformanceCounter();
+    for (int b = 0; b < CONTROL_BENCH_BATCHES; ++b) {
+        if (control_send(bench->name, g_controlBatch, batchCount, bench->replies) != 0) bench->failed++;
+    }
+    bench->batchUs = bench_seconds(timer) * 1e6 / CONTROL_BENCH_BATCHES;
+    SDL_AtomicSet(&bench->finished, 1);
+    SDL_Event wake = { .type = SDL_USEREVENT };
+    SDL_PushEvent(&wake);
+    return 0;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static int bench_control(int argc, char** argv) {
+    (void)argc; (void)argv;
+    if (SDL_InitSubSystem(SDL_INIT_EVENTS) != 0) return 1;
+    static ControlBench bench;
+    memset(&bench, 0, sizeof(bench));
+    snprintf(bench.name, sizeof(bench.name), "cclock-bench-%llx", (unsigned long long)SDL_GetPerformanceCounter());
+    bench.replies = bench_tmpfile();
+    CClockControl control;
+    if (!bench.replies || !control_start(&control, bench.name, SDL_RegisterEvents(1))) {
+        if (bench.replies) fclose(bench.replies);
+        SDL_QuitSubSystem(SDL_INIT_EVENTS);
+        return 1;
+    }
+
+    CClockTimeSource source = { .kind = CCLOCK_TIME_REAL };
+    CClockEngine engine;
+    cclock_engine_init(&engine, &source);
+    CClockStyle style = CCLOCK_STYLE_HH_MM_SS;
+    unsigned long wakeups = 0, commands = 0, mismatches = 0;
+    SDL_Thread* client = SDL_CreateThread(control_bench_client, "bench-control", &bench);
+    while (client && !SDL_AtomicGet(&bench.finished)) {
+        SDL_Event event;
+        if (!SDL_WaitEventTimeout(&event, 1000) || event.type != control.eventType) continue;
+        int count;
+        CClockControlCommand* batch = control_take(&control, &count);
+        if (!batch) continue;
+        CClockSnapshot now;
+        cclock_snapshot(&engine, &now);
+        for (int i = 0; i < count; ++i) control_apply(&batch[i], &engine, &style, &now);
+        // What the window would draw next
+        CClockText text;
+        cclock_build_text(&engine, &now, NULL, &text);
+        if (batch[count - 1].kind == CONTROL_START && strcmp(text.timeStr, "00:01:30") != 0) mismatches++;
+        if (batch[count - 1].kind == CONTROL_CANCEL && engine.mode != CCLOCK_CLOCK) mismatches++;
+        control_complete(&control);
+        wakeups++;
+        commands += (unsigned long)count;
+    }
+    if (client) SDL_WaitThread(client, NULL);
+    control_stop(&control);
+
+    // Each batch ends with a list right after start 90s
+    unsigned long lists = 0;
+    char line[CONTROL_REPLY_MAX + 2];
+    rewind(bench.replies);
+    while (fgets(line, sizeof(line), bench.replies)) lists += strcmp(line, "mode=chrono style=hh:mm:ss left=90 total=90\n") == 0;
+    fclose(bench.replies);
+
+    qsort(bench.singleNs, CONTROL_BENCH_ROUNDS, sizeof(uint64_t), compare_u64);
+    const int batchCount = (int)(sizeof(g_controlBatch) / sizeof(g_controlBatch[0]));
+    printf("control single_us p50=%.1f p99=%.1f max=%.1f batch_of_%d_us=%.1f per_command_us=%.2f wakeups=%lu commands=%lu failed=%d mismatches=%lu\n",
+        bench.singleNs[CONTROL_BENCH_ROUNDS / 2] / 1000.0, bench.singleNs[CONTROL_BENCH_ROUNDS * 99 / 100] / 1000.0,
+        bench.singleNs[CONTROL_BENCH_ROUNDS - 1] / 1000.0, batchCount, bench.batchUs, bench.batchUs / batchCount,
+        wakeups, commands, bench.failed, mismatches);
+    SDL_QuitSubSystem(SDL_INIT_EVENTS);
+    const unsigned long expectedCommands = CONTROL_BENCH_ROUNDS + (unsigned long)CONTROL_BENCH_BATCHES * batchCount;
+    return client && bench.failed == 0 && mismatches == 0 && commands == expectedCommands
+        && wakeups == CONTROL_BENCH_ROUNDS + CONTROL_BENCH_BATCHES && lists == CONTROL_BENCH_BATCHES ? 0 : 1;
+}
+
+typedef struct {
+    const char* name;
+    int (*run)(int argc, char** argv);
+} BenchEntry;
+
+static const BenchEntry g_benches[] = {
+    { "world", bench_world },
+    { "tzif", bench_tzif },
+    { "blend", bench_blend },
+    { "tiles", bench_tiles },
+    { "shadow", bench_shadow },
+    { "text", bench_text },
+    { "transition", bench_transition },
+    { "skin", bench_skin },
+    { "alarms", bench_alarms },
+    { "format", bench_format },
+    { "log", bench_log },
+    { "engine", bench_engine },
+    { "term", bench_term },
+    { "stream", bench_stream },
+    { "control", bench_control },
+};
+
+int bench_run(int argc, char** argv) {
+    const int count = (int)(sizeof(g_benches) / sizeof(g_benches[0]));
+    for (int i = 0; i < count; ++i) {
+        if (strcmp(argv[0], g_benches[i].name) == 0) {
+            return g_benches[i].run(argc, argv);
+        }
+    }
+    fprintf(stderr, "Unknown benchmark '%s', available:", argv[0]);
+    for (int i = 0; i < count; ++i) fprintf(stderr, " %s", g_benches[i].name);
+    fprintf(stderr, "\n");
+    return 1;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Benchmarks, run with `cclock --bench <name> [args...]`, argv[0] is the benchmark name.
+// Prints one line per measurement and returns the process exit code (non zero on regression)
+int bench_run(int argc, char** argv);
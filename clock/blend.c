@@ -0,0 +1,133 @@
+#include "blend.h"
+
+#include <string.h>
+
+#include <SDL_cpuinfo.h>
+
+#ifdef CCLOCK_BLEND_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// gcc/clang only emit AVX2 for functions that ask for it, MSVC takes the intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// Exact x / 255 rounded to nearest for x in [0, 255 * 255]
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t blend_pixel(uint32_t dst, uint32_t argb, uint32_t a) {
+    const uint32_t ia = 255 - a;
+    const uint32_t b = div255((argb & 0xFF) * a + (dst & 0xFF) * ia);
+    const uint32_t g = div255(((argb >> 8) & 0xFF) * a + ((dst >> 8) & 0xFF) * ia);
+    const uint32_t r = div255(((argb >> 16) & 0xFF) * a + ((dst >> 16) & 0xFF) * ia);
+    const uint32_t al = div255(255 * a + (dst >> 24) * ia);
+    return (al << 24) | (r << 16) | (g << 8) | b;
+}
+
+void blend_span_scalar(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb) {
+    const uint32_t colorAlpha = argb >> 24;
+    for (int i = 0; i < count; ++i) {
+        const uint32_t a = div255(coverage[i] * colorAlpha);
+        if (a == 0) continue;
+        dst[i] = blend_pixel(dst[i], argb, a);
+    }
+}
+
+#ifdef CCLOCK_BLEND_X86
+
+// 16-bit lanes: (x + 128 + ((x + 128) >> 8)) >> 8, never overflows for x <= 255 * 255
+#define DIV255_EPI16(x, bias) _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16((x), (bias)), _mm_srli_epi16(_mm_add_epi16((x), (bias)), 8)), 8)
+#define DIV255_EPI16_256(x, bias) _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16((x), (bias)), _mm256_srli_epi16(_mm256_add_epi16((x), (bias)), 8)), 8)
+
+TARGET_SSE2
+void blend_span_sse2(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i colorAlpha = _mm_set1_epi16((short)(argb >> 24));
+    // Two pixels worth of source channels (B, G, R, A=255) in 16-bit lanes
+    const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32((int)((argb & 0x00FFFFFF) | 0xFF000000)), zero);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int cov4;
+        memcpy(&cov4, coverage + i, 4);
+        if (cov4 == 0) continue;
+
+        const __m128i cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128(cov4), zero);
+        const __m128i a = DIV255_EPI16(_mm_mullo_epi16(cov, colorAlpha), bias);
+        const __m128i aa = _mm_unpacklo_epi16(a, a);
+        const __m128i aLo = _mm_unpacklo_epi32(aa, aa);
+        const __m128i aHi = _mm_unpackhi_epi32(aa, aa);
+
+        const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        const __m128i dLo = _mm_unpacklo_epi8(d, zero);
+        const __m128i dHi = _mm_unpackhi_epi8(d, zero);
+
+        const __m128i lo = _mm_add_epi16(_mm_mullo_epi16(src, aLo), _mm_mullo_epi16(dLo, _mm_sub_epi16(full, aLo)));
+        const __m128i hi = _mm_add_epi16(_mm_mullo_epi16(src, aHi), _mm_mullo_epi16(dHi, _mm_sub_epi16(full, aHi)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(DIV255_EPI16(lo, bias), DIV255_EPI16(hi, bias)));
+    }
+    blend_span_scalar(dst + i, coverage + i, count - i, argb);
+}
+
+TARGET_AVX2
+void blend_span_avx2(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i full = _mm256_set1_epi16(255);
+    const __m128i colorAlpha = _mm_set1_epi16((short)(argb >> 24));
+    const __m128i bias128 = _mm_set1_epi16(128);
+    const __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)((argb & 0x00FFFFFF) | 0xFF000000)), zero);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        long long cov8;
+        memcpy(&cov8, coverage + i, 8);
+        if (cov8 == 0) continue;
+
+        // a0..a3 in the low lane, a4..a7 in the high lane to match the in-lane unpacks of dst
+        const __m128i cov = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(coverage + i)), _mm_setzero_si128());
+        const __m128i a128 = DIV255_EPI16(_mm_mullo_epi16(cov, colorAlpha), bias128);
+        const __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(a128), _mm_srli_si128(a128, 8), 1);
+        const __m256i aa = _mm256_unpacklo_epi16(a, a);
+        const __m256i aLo = _mm256_unpacklo_epi32(aa, aa);
+        const __m256i aHi = _mm256_unpackhi_epi32(aa, aa);
+
+        const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        const __m256i dLo = _mm256_unpacklo_epi8(d, zero);
+        const __m256i dHi = _mm256_unpackhi_epi8(d, zero);
+
+        const __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(src, aLo), _mm256_mullo_epi16(dLo, _mm256_sub_epi16(full, aLo)));
+        const __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(src, aHi), _mm256_mullo_epi16(dHi, _mm256_sub_epi16(full, aHi)));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packus_epi16(DIV255_EPI16_256(lo, bias), DIV255_EPI16_256(hi, bias)));
+    }
+    blend_span_sse2(dst + i, coverage + i, count - i, argb);
+}
+
+#endif
+
+CClockBlendSpanFn blend_select_span(void) {
+#ifdef CCLOCK_BLEND_X86
+    if (SDL_HasAVX2()) return blend_span_avx2;
+    if (SDL_HasSSE2()) return blend_span_sse2;
+#endif
+    return blend_span_scalar;
+}
+
+const char* blend_span_name(CClockBlendSpanFn fn) {
+#ifdef CCLOCK_BLEND_X86
+    if (fn == blend_span_avx2) return "avx2";
+    if (fn == blend_span_sse2) return "sse2";
+#endif
+    return "scalar";
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+// Blends `count` pixels of A8 coverage in a solid color over ARGB8888 pixels:
+// dst = div255(src * a + dst * (255 - a)) per channel with a = div255(coverage * colorAlpha),
+// the alpha channel blends towards 255. Every kernel gives bit-identical results.
+typedef void (*CClockBlendSpanFn)(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb);
+
+void blend_span_scalar(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb);
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CCLOCK_BLEND_X86 1
+void blend_span_sse2(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb);
+void blend_span_avx2(uint32_t* dst, const uint8_t* coverage, int count, uint32_t argb);
+#endif
+
+// Fastest kernel the CPU supports
+CClockBlendSpanFn blend_select_span(void);
+
+const char* blend_span_name(CClockBlendSpanFn fn);
@@ -0,0 +1,140 @@
+#include "blur.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL_cpuinfo.h>
+
+#include "blend.h"
+
+#ifdef CCLOCK_BLEND_X86
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define TARGET_SSE2
+#endif
+
+void blur_kernel_init(CClockBlurKernel* kernel, int radius) {
+    if (radius < 0) radius = 0;
+    if (radius > BLUR_MAX_RADIUS) radius = BLUR_MAX_RADIUS;
+    kernel->radius = radius;
+
+    const double sigma = radius > 0 ? radius / 2.0 : 1.0;
+    double weights[2 * BLUR_MAX_RADIUS + 1];
+    double sum = 0.0;
+    for (int i = -radius; i <= radius; ++i) {
+        weights[i + radius] = exp(-(double)(i * i) / (2.0 * sigma * sigma));
+        sum += weights[i + radius];
+    }
+
+    // Rounding leaves a few units over or under, the center tap absorbs them so flat areas stay exact
+    int total = 0;
+    for (int i = 0; i <= 2 * radius; ++i) {
+        kernel->weights[i] = (int16_t)floor(weights[i] / sum * (1 << BLUR_WEIGHT_BITS) + 0.5);
+        total += kernel->weights[i];
+    }
+    kernel->weights[radius] += (int16_t)((1 << BLUR_WEIGHT_BITS) - total);
+}
+
+typedef void (*VerticalPassFn)(uint8_t* dst, const uint8_t* src, int width, int rows, const CClockBlurKernel* kernel);
+
+// dst row y = sum of src rows y .. y + 2 * radius, src has rows + 2 * radius rows, both are width wide
+static void vertical_pass_scalar(uint8_t* dst, const uint8_t* src, int width, int rows, const CClockBlurKernel* kernel) {
+    const int taps = 2 * kernel->radius + 1;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int32_t acc = 1 << (BLUR_WEIGHT_BITS - 1);
+            for (int k = 0; k < taps; ++k) acc += kernel->weights[k] * src[(size_t)(y + k) * width + x];
+            dst[(size_t)y * width + x] = (uint8_t)(acc >> BLUR_WEIGHT_BITS);
+        }
+    }
+}
+
+#ifdef CCLOCK_BLEND_X86
+// 8 columns at a time, two taps per _mm_madd_epi16 by interleaving two source rows
+TARGET_SSE2
+static void vertical_pass_sse2(uint8_t* dst, const uint8_t* src, int width, int rows, const CClockBlurKernel* kernel) {
+    const int taps = 2 * kernel->radius + 1;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (BLUR_WEIGHT_BITS - 1));
+    __m128i pairWeights[BLUR_MAX_RADIUS + 1];
+    for (int k = 0; k < taps; k += 2) {
+        const int16_t next = k + 1 < taps ? kernel->weights[k + 1] : 0;
+        pairWeights[k / 2] = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t)next << 16) | (uint16_t)kernel->weights[k]));
+    }
+
+    const int vectorWidth = width & ~7;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < vectorWidth; x += 8) {
+            __m128i accLo = round;
+            __m128i accHi = round;
+            for (int k = 0; k < taps; k += 2) {
+                const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + (size_t)(y + k) * width + x)), zero);
+                const __m128i b = k + 1 < taps
+                    ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + (size_t)(y + k + 1) * width + x)), zero)
+                    : zero;
+                accLo = _mm_add_epi32(accLo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pairWeights[k / 2]));
+                accHi = _mm_add_epi32(accHi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pairWeights[k / 2]));
+            }
+            accLo = _mm_srai_epi32(accLo, BLUR_WEIGHT_BITS);
+            accHi = _mm_srai_epi32(accHi, BLUR_WEIGHT_BITS);
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(accLo, accHi), zero);
+            _mm_storel_epi64((__m128i*)(dst + (size_t)y * width + x), packed);
+        }
+        for (int x = vectorWidth; x < width; ++x) {
+            int32_t acc = 1 << (BLUR_WEIGHT_BITS - 1);
+            for (int k = 0; k < taps; ++k) acc += kernel->weights[k] * src[(size_t)(y + k) * width + x];
+            dst[(size_t)y * width + x] = (uint8_t)(acc >> BLUR_WEIGHT_BITS);
+        }
+    }
+}
+#endif
+
+static void transpose(uint8_t* dst, const uint8_t* src, int width, int height) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) dst[(size_t)x * height + y] = src[(size_t)y * width + x];
+    }
+}
+
+static bool blur_with(uint8_t* dst, const uint8_t* src, int w, int h, const CClockBlurKernel* kernel, VerticalPassFn pass) {
+    const int r = kernel->radius;
+    // Vertical: src padded to (w + 4r) x (h + 4r) gives (w + 4r) x (h + 2r), the extra columns feed the horizontal pass
+    const int paddedW = w + 4 * r;
+    const int outW = w + 2 * r;
+    const int outH = h + 2 * r;
+    const size_t paddedSize = (size_t)paddedW * (h + 4 * r);
+    const size_t verticalSize = (size_t)paddedW * outH;
+    // One block for the four steps, a failed allocation leaves nothing to free
+    uint8_t* scratch = malloc(paddedSize + 2 * verticalSize + (size_t)outW * outH);
+    if (!scratch) return false;
+    uint8_t* padded = scratch;
+    uint8_t* vertical = padded + paddedSize;
+    uint8_t* transposed = vertical + verticalSize;
+    uint8_t* horizontal = transposed + verticalSize;
+
+    memset(padded, 0, paddedSize);
+    for (int y = 0; y < h; ++y) memcpy(padded + (size_t)(y + 2 * r) * paddedW + 2 * r, src + (size_t)y * w, w);
+    pass(vertical, padded, paddedW, outH, kernel);
+    // Horizontal: rows of the transposed image are the columns, (outH) x (w + 4r) gives outH x outW
+    transpose(transposed, vertical, paddedW, outH);
+    pass(horizontal, transposed, outH, outW, kernel);
+    transpose(dst, horizontal, outH, outW);
+
+    free(scratch);
+    return true;
+}
+
+bool blur_a8_scalar(uint8_t* dst, const uint8_t* src, int w, int h, const CClockBlurKernel* kernel) {
+    return blur_with(dst, src, w, h, kernel, vertical_pass_scalar);
+}
+
+bool blur_a8(uint8_t* dst, const uint8_t* src, int w, int h, const CClockBlurKernel* kernel) {
+#ifdef CCLOCK_BLEND_X86
+    if (SDL_HasSSE2()) return blur_with(dst, src, w, h, kernel, vertical_pass_sse2);
+#endif
+    return blur_a8_scalar(dst, src, w, h, kernel);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BLUR_MAX_RADIUS 32
+#define BLUR_WEIGHT_BITS 14
+
+// Gaussian with sigma = radius / 2 truncated at +-radius, weights in fixed point summing to exactly 1 << 14
+typedef struct {
+    int radius;
+    int16_t weights[2 * BLUR_MAX_RADIUS + 1];
+} CClockBlurKernel;
+
+void blur_kernel_init(CClockBlurKernel* kernel, int radius);
+
+// Separable blur of a w * h A8 image into dst of (w + 2 * radius) * (h + 2 * radius) so nothing is cut off.
+// Both passes run as a vertical pass (SIMD across columns), the horizontal one on a transposed copy.
+// Returns false when out of memory
+bool blur_a8(uint8_t* dst, const uint8_t* src, int w, int h, const CClockBlurKernel* kernel);
+
+// Same as blur_a8 without SIMD, results are bit-identical
+bool blur_a8_scalar(uint8_t* dst, const uint8_t* src, int w, int h, const CClockBlurKernel* kernel);
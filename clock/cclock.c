@@ -0,0 +1,125 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // localtime_r
+#endif
+
+#include "cclock.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CCLOCK_DATE_FORMAT_DEFAULT "%A %-d %B %Y"
+
+static const char* style_time_format(CClockStyle style) {
+    return style == CCLOCK_STYLE_HH_MM ? "%H:%M" : "%H:%M:%S";
+}
+
+void cclock_engine_init(CClockEngine* engine, const CClockTimeSource* time) {
+    memset(engine, 0, sizeof(*engine));
+    engine->time = time;
+    engine->mode = CCLOCK_CLOCK;
+    engine->style = CCLOCK_STYLE_HH_MM_SS;
+    format_compile(&engine->timeFormat, style_time_format(engine->style));
+    format_compile(&engine->dateFormat, CCLOCK_DATE_FORMAT_DEFAULT);
+}
+
+bool cclock_engine_set_formats(CClockEngine* engine, const char* timeFormat, const char* dateFormat) {
+    CClockFormat time, date;
+    if (!format_compile(&time, timeFormat) || !format_compile(&date, dateFormat)) return false;
+    engine->timeFormat = time;
+    engine->dateFormat = date;
+    return true;
+}
+
+void cclock_snapshot(const CClockEngine* engine, CClockSnapshot* snapshot) {
+    snapshot->nowNs = time_source_now_ns(engine->time);
+    snapshot->now = time_source_seconds(snapshot->nowNs);
+#ifdef _WIN32
+    localtime_s(&snapshot->local, &snapshot->now);
+#else
+    localtime_r(&snapshot->now, &snapshot->local);
+#endif
+    const int64_t subSecondNs = snapshot->nowNs - (int64_t)snapshot->now * 1000000000;
+    snapshot->secondsOfDay = snapshot->local.tm_hour * 3600.0 + snapshot->local.tm_min * 60.0 + snapshot->local.tm_sec + (double)subSecondNs / 1e9;
+}
+
+// Countdowns are in seconds of real time: across a DST change a 1h chrono still lasts an hour
+void cclock_chrono_start(CClockEngine* engine, const CClockSnapshot* now, long seconds) {
+    engine->mode = CCLOCK_CHRONO;
+    engine->chronoStart = now->now;
+    engine->chronoTarget = now->now + seconds;
+}
+
+long cclock_chrono_left(const CClockEngine* engine, const CClockSnapshot* now) {
+    const long left = (long)(engine->chronoTarget - now->now);
+    return left > 0 ? left : 0;
+}
+
+void cclock_chrono_progress(const CClockEngine* engine, const CClockSnapshot* now, uint64_t* completed, uint64_t* total) {
+    const long length = (long)(engine->chronoTarget - engine->chronoStart);
+    *total = length > 0 ? (uint64_t)length : 0;
+    *completed = *total - (uint64_t)cclock_chrono_left(engine, now);
+}
+
+void cclock_build_text(const CClockEngine* engine, const CClockSnapshot* now, const char* alarmText, CClockText* text) {
+    text->windowTitle[0] = text->timeStr[0] = text->dateStr[0] = '\0';
+    text->alert = false;
+    text->chronoLeft = 0;
+
+    if (engine->mode == CCLOCK_CLOCK || engine->mode == CCLOCK_WORLD) {
+        // The title shows the time format so a format without seconds does not have to wake up every second
+        format_apply(&engine->timeFormat, &now->local, text->timeStr, sizeof(text->timeStr));
+        format_apply(&engine->dateFormat, &now->local, text->dateStr, sizeof(text->dateStr));
+        snprintf(text->windowTitle, sizeof(text->windowTitle), "%s - CClock", text->timeStr);
+
+        if (alarmText) {
+            text->alert = true;
+            snprintf(text->dateStr, sizeof(text->dateStr), "%s", alarmText);
+        }
+    }
+    else if (engine->mode == CCLOCK_CHRONO) {
+        const long left = cclock_chrono_left(engine, now);
+        text->alert = left == 0;
+        const int hour = (int)(left / 3600);
+        const int min = (int)(left % 3600 / 60);
+        const int sec = (int)(left % 60);
+
+        snprintf(text->windowTitle, sizeof(text->windowTitle), "%d%d:%d%d:%d%d - CClock (Timer Mode)", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
+        snprintf(text->dateStr, sizeof(text->dateStr), "Timer Mode: ");
+        snprintf(text->timeStr, sizeof(text->timeStr), "%d%d:%d%d:%d%d", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
+        text->chronoLeft = left;
+    }
+}
+
+int cclock_refresh_seconds(const CClockEngine* engine) {
+    if (engine->mode == CCLOCK_CLOCK) return format_refresh_seconds(engine->timeFormat.fields | engine->dateFormat.fields);
+    if (engine->mode == CCLOCK_WORLD && engine->style == CCLOCK_STYLE_HH_MM) return 60;
+    return 1;
+}
+
+long cclock_wall_ms_until_next_tick(const CClockEngine* engine, const CClockSnapshot* now) {
+    const int refreshSeconds = cclock_refresh_seconds(engine);
+    const long msIntoSecond = (long)((now->nowNs - (int64_t)now->now * 1000000000) / 1000000);
+    if (refreshSeconds <= 1) return 1000 - msIntoSecond;
+
+    // Local time: half hour zones would otherwise wake an hour format at :30
+    const long secondOfDay = now->local.tm_hour * 3600L + now->local.tm_min * 60L + now->local.tm_sec;
+    const long msIntoPeriod = (secondOfDay % refreshSeconds) * 1000 + msIntoSecond;
+    return refreshSeconds * 1000L - msIntoPeriod;
+}
+
+void cclock_placeholder(const CClockEngine* engine, char* out, size_t size) {
+    if (engine->mode == CCLOCK_CLOCK) format_placeholder(&engine->timeFormat, out, size);
+    else snprintf(out, size, "00:00:00");
+}
+
+int cclock_layout_text(const CClockGlyphMetrics* metrics, const char* text, CClockGlyphPlacement* out, int max, int* width) {
+    int count = 0, penX = 0;
+    for (const char* c = text; *c; ++c) {
+        const int ch = (unsigned char)*c;
+        if (ch >= CCLOCK_GLYPH_COUNT) continue;
+        if (count < max) out[count++] = (CClockGlyphPlacement){ *c, penX };
+        penX += metrics->advances[ch];
+    }
+    if (width) *width = penX;
+    return count;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "format.h"
+#include "time_source.h"
+
+// libcclock, the clock engine without SDL: what the clock shows, when it changes next and where
+// the glyphs go. Built from cclock.c, format.c, time_source.c and monotonic.c, front ends draw the text it produces.
+// A tick reads the time source once (cclock_snapshot) and every other call works on that snapshot,
+// so a tick costs one clock read, one localtime and the format op lists whatever the mode
+
+#define CCLOCK_GLYPH_COUNT 128
+#define CCLOCK_TITLE_MAX (FORMAT_MAX_TEXT + 32)
+
+enum CClockMode {
+    CCLOCK_CLOCK,
+    CCLOCK_TIMER,
+    CCLOCK_CHRONO,
+    CCLOCK_WORLD,
+};
+
+typedef enum {
+    CCLOCK_STYLE_HH_MM_SS,
+    CCLOCK_STYLE_HH_MM,
+    CCLOCK_STYLE_ANALOG,
+} CClockStyle;
+
+typedef struct {
+    const CClockTimeSource* time;   // every wall time read goes through it
+    enum CClockMode mode;
+    CClockStyle style;
+    CClockFormat timeFormat;
+    CClockFormat dateFormat;
+    time_t chronoStart;             // CHRONO: when the countdown started and when it ends
+    time_t chronoTarget;
+} CClockEngine;
+
+typedef struct {
+    int64_t nowNs;
+    time_t now;
+    struct tm local;
+    double secondsOfDay;    // local, with the sub-second part
+} CClockSnapshot;
+
+typedef struct {
+    char windowTitle[CCLOCK_TITLE_MAX];
+    char timeStr[FORMAT_MAX_TEXT];
+    char dateStr[FORMAT_MAX_TEXT];
+    bool alert;             // an alarm label or a finished countdown, front ends pick the color
+    long chronoLeft;        // CHRONO: seconds left, 0 once done
+} CClockText;
+
+// Advance of each character and the line height, in pixels, cells or any unit of the front end
+typedef struct {
+    int advances[CCLOCK_GLYPH_COUNT];
+    int lineHeight;
+} CClockGlyphMetrics;
+
+typedef struct {
+    char ch;
+    int x;                  // pen position from the start of the line
+} CClockGlyphPlacement;
+
+// Clock mode, formats from the style ("%H:%M" or "%H:%M:%S") and "%A %-d %B %Y"
+void cclock_engine_init(CClockEngine* engine, const CClockTimeSource* time);
+
+// False (the format is left unchanged) when it does not compile
+bool cclock_engine_set_formats(CClockEngine* engine, const char* timeFormat, const char* dateFormat);
+
+void cclock_snapshot(const CClockEngine* engine, CClockSnapshot* snapshot);
+
+// Switches to the chrono mode, counting down `seconds` from the snapshot
+void cclock_chrono_start(CClockEngine* engine, const CClockSnapshot* now, long seconds);
+
+long cclock_chrono_left(const CClockEngine* engine, const CClockSnapshot* now);
+
+// Elapsed and total seconds of the countdown, for progress bars
+void cclock_chrono_progress(const CClockEngine* engine, const CClockSnapshot* now, uint64_t* completed, uint64_t* total);
+
+// Text of the time and date lines. alarmText replaces the date while an alarm is shown, NULL otherwise
+void cclock_build_text(const CClockEngine* engine, const CClockSnapshot* now, const char* alarmText, CClockText* text);
+
+// Seconds between two changes of what the mode displays
+int cclock_refresh_seconds(const CClockEngine* engine);
+
+// Wall milliseconds until the text can change next, aligned on the local wall clock boundary
+long cclock_wall_ms_until_next_tick(const CClockEngine* engine, const CClockSnapshot* now);
+
+// Widest time line the mode can show with monospace digits, what layouts reserve room for
+void cclock_placeholder(const CClockEngine* engine, char* out, size_t size);
+
+// Pen positions of the glyphs of text, characters outside the metrics are skipped.
+// Returns the number of placements written, at most max, *width gets the full advance of the line
+int cclock_layout_text(const CClockGlyphMetrics* metrics, const char* text, CClockGlyphPlacement* out, int max, int* width);
@@ -0,0 +1,261 @@
+#include "compositor.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "soak_track.h"
+
+bool compositor_renderer_is_software(SDL_Renderer* renderer) {
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(renderer, &info) != 0) return false;
+    return (info.flags & SDL_RENDERER_SOFTWARE) || !(info.flags & SDL_RENDERER_ACCELERATED);
+}
+
+bool compositor_init(CClockCompositor* compositor, SDL_Renderer* renderer, int width, int height, CClockWorkerPool* pool) {
+    *compositor = (CClockCompositor){ 0 };
+    compositor->blendSpan = blend_select_span();
+    compositor->pool = pool;
+    return compositor_resize(compositor, renderer, width, height);
+}
+
+static void free_framebuffer(CClockCompositor* compositor) {
+    free(compositor->pixels);
+    free(compositor->tileHashes);
+    free(compositor->nextTileHashes);
+    free(compositor->dirtyTiles);
+    if (compositor->texture) SDL_DestroyTexture(compositor->texture);
+    compositor->pixels = NULL;
+    compositor->tileHashes = compositor->nextTileHashes = NULL;
+    compositor->dirtyTiles = NULL;
+    compositor->texture = NULL;
+    compositor->width = compositor->height = 0;
+    compositor->tileColumns = compositor->tileRows = 0;
+}
+
+bool compositor_resize(CClockCompositor* compositor, SDL_Renderer* renderer, int width, int height) {
+    if (compositor->pixels && compositor->width == width && compositor->height == height) return true;
+
+    free_framebuffer(compositor);
+    const int columns = (width + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE;
+    const int rows = (height + COMPOSITOR_TILE_SIZE - 1) / COMPOSITOR_TILE_SIZE;
+    compositor->pixels = malloc(sizeof(uint32_t) * (size_t)width * (size_t)height);
+    compositor->tileHashes = calloc((size_t)columns * rows, sizeof(uint64_t));
+    compositor->nextTileHashes = calloc((size_t)columns * rows, sizeof(uint64_t));
+    compositor->dirtyTiles = malloc(sizeof(int) * (size_t)columns * rows);
+    if (renderer) {
+        compositor->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+    }
+    if (!compositor->pixels || !compositor->tileHashes || !compositor->nextTileHashes || !compositor->dirtyTiles
+        || (renderer && !compositor->texture)) {
+        fprintf(stderr, "Could not create the compositor framebuffer: %s\n", SDL_GetError());
+        free_framebuffer(compositor);
+        return false;
+    }
+    compositor->width = width;
+    compositor->height = height;
+    compositor->tileColumns = columns;
+    compositor->tileRows = rows;
+    compositor->invalidated = true;
+    return true;
+}
+
+void compositor_invalidate(CClockCompositor* compositor) {
+    compositor->invalidated = true;
+}
+
+void compositor_clear(CClockCompositor* compositor, uint32_t argb) {
+    compositor->clearColor = argb;
+    compositor->opCount = 0;
+}
+
+static void free_face(CClockA8Face* face) {
+    for (int ch = 0; ch < COMPOSITOR_CHAR_COUNT; ++ch) free(face->glyphs[ch].coverage);
+    *face = (CClockA8Face){ 0 };
+}
+
+static CClockA8Face* get_face(CClockCompositor* compositor, TTF_Font* font, float scale) {
+    compositor->useCounter++;
+    CClockA8Face* victim = &compositor->faces[0];
+    for (int i = 0; i < COMPOSITOR_MAX_FACES; ++i) {
+        CClockA8Face* face = &compositor->faces[i];
+        if (face->font == font && face->scale == scale) {
+            face->lastUse = compositor->useCounter;
+            return face;
+        }
+        if (!face->font || face->lastUse < victim->lastUse) victim = face;
+    }
+    // Recorded hashes only know the glyph addresses, reusing a slot must repaint everything
+    if (victim->font) compositor->invalidated = true;
+    free_face(victim);
+    victim->font = font;
+    victim->scale = scale;
+    victim->lastUse = compositor->useCounter;
+    return victim;
+}
+
+// Solid rendering like the GPU path, coverage is 0 or 255 so nothing fringes against the color key
+static void rasterize_glyph(CClockA8Face* face, int ch) {
+    face->rasterized[ch] = true;
+    CClockA8Glyph* glyph = &face->glyphs[ch];
+
+    int advance = 0;
+    TTF_GlyphMetrics(face->font, (Uint16)ch, NULL, NULL, NULL, NULL, &advance);
+    glyph->advance = advance * face->scale;
+
+    SDL_Surface* surface = TTF_RenderGlyph_Solid(face->font, (Uint16)ch, (SDL_Color) { 255, 255, 255, 255 });
+    if (!surface) return;
+
+    const int w = (int)ceilf(surface->w * face->scale);
+    const int h = (int)ceilf(surface->h * face->scale);
+    glyph->coverage = w > 0 && h > 0 ? malloc((size_t)w * (size_t)h) : NULL;
+    if (glyph->coverage) {
+        glyph->w = w;
+        glyph->h = h;
+        SDL_LockSurface(surface);
+        // Nearest neighbour scaling, done once per glyph and scale; palette index 0 is the background
+        for (int y = 0; y < h; ++y) {
+            const int sy = (int)(y / face->scale) < surface->h ? (int)(y / face->scale) : surface->h - 1;
+            const Uint8* srcRow = (const Uint8*)surface->pixels + sy * surface->pitch;
+            for (int x = 0; x < w; ++x) {
+                const int sx = (int)(x / face->scale) < surface->w ? (int)(x / face->scale) : surface->w - 1;
+                glyph->coverage[y * w + x] = srcRow[sx] ? 255 : 0;
+            }
+        }
+        SDL_UnlockSurface(surface);
+    }
+    SDL_FreeSurface(surface);
+}
+
+static bool reserve_ops(CClockCompositor* compositor, int count) {
+    if (compositor->opCount + count <= compositor->opCapacity) return true;
+    int capacity = compositor->opCapacity ? compositor->opCapacity * 2 : 64;
+    while (capacity < compositor->opCount + count) capacity *= 2;
+    CClockGlyphOp* ops = realloc(compositor->ops, sizeof(CClockGlyphOp) * capacity);
+    if (!ops) return false;
+    compositor->ops = ops;
+    compositor->opCapacity = capacity;
+    return true;
+}
+
+void compositor_draw_text(CClockCompositor* compositor, TTF_Font* font, const char* text, int x, int y, float scale, SDL_Color color) {
+    if (!compositor->pixels || !reserve_ops(compositor, (int)strlen(text))) return;
+    // A smooth zoom goes through every scale, faces are rasterized per 1/32 only
+    CClockA8Face* face = get_face(compositor, font, roundf(scale * 32.f) / 32.f);
+    const uint32_t argb = ((uint32_t)color.a << 24) | ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+
+    float penX = (float)x;
+    for (const char* c = text; *c; ++c) {
+        const int ch = (unsigned char)*c;
+        if (ch >= COMPOSITOR_CHAR_COUNT) continue;
+        if (!face->rasterized[ch]) rasterize_glyph(face, ch);
+        const CClockA8Glyph* glyph = &face->glyphs[ch];
+        if (glyph->coverage) {
+            compositor->ops[compositor->opCount++] = (CClockGlyphOp){ glyph, (int)penX, y, argb };
+        }
+        penX += glyph->advance;
+    }
+}
+
+static uint64_t hash_mix(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash * 0xFF51AFD7ED558CCDull;
+}
+
+static void get_tile_rect(const CClockCompositor* compositor, int tile, SDL_Rect* rect) {
+    rect->x = (tile % compositor->tileColumns) * COMPOSITOR_TILE_SIZE;
+    rect->y = (tile / compositor->tileColumns) * COMPOSITOR_TILE_SIZE;
+    rect->w = SDL_min(COMPOSITOR_TILE_SIZE, compositor->width - rect->x);
+    rect->h = SDL_min(COMPOSITOR_TILE_SIZE, compositor->height - rect->y);
+}
+
+// Runs on the worker pool, tiles never overlap so no synchronization is needed
+static void draw_tile(void* context, int task) {
+    const CClockCompositor* compositor = context;
+    SDL_Rect tile;
+    get_tile_rect(compositor, compositor->dirtyTiles[task], &tile);
+
+    for (int row = 0; row < tile.h; ++row) {
+        uint32_t* dst = compositor->pixels + (size_t)(tile.y + row) * compositor->width + tile.x;
+        for (int i = 0; i < tile.w; ++i) dst[i] = compositor->clearColor;
+    }
+
+    for (int o = 0; o < compositor->opCount; ++o) {
+        const CClockGlyphOp* op = &compositor->ops[o];
+        const CClockA8Glyph* glyph = op->glyph;
+        // Clip the glyph rectangle against the tile
+        const int x0 = SDL_max(op->x, tile.x);
+        const int x1 = SDL_min(op->x + glyph->w, tile.x + tile.w);
+        const int y0 = SDL_max(op->y, tile.y);
+        const int y1 = SDL_min(op->y + glyph->h, tile.y + tile.h);
+        for (int y = y0; y < y1 && x0 < x1; ++y) {
+            uint32_t* dst = compositor->pixels + (size_t)y * compositor->width + x0;
+            compositor->blendSpan(dst, glyph->coverage + (y - op->y) * glyph->w + (x0 - op->x), x1 - x0, op->argb);
+        }
+    }
+}
+
+int compositor_render(CClockCompositor* compositor) {
+    if (!compositor->pixels) return 0;
+    const int tileCount = compositor->tileColumns * compositor->tileRows;
+
+    // Hash what lands on every tile: the clear color then each overlapping glyph in draw order
+    for (int t = 0; t < tileCount; ++t) compositor->nextTileHashes[t] = hash_mix(0, compositor->clearColor);
+    for (int o = 0; o < compositor->opCount; ++o) {
+        const CClockGlyphOp* op = &compositor->ops[o];
+        const int c0 = SDL_max(op->x, 0) / COMPOSITOR_TILE_SIZE;
+        const int c1 = SDL_min(op->x + op->glyph->w, compositor->width) - 1;
+        const int r0 = SDL_max(op->y, 0) / COMPOSITOR_TILE_SIZE;
+        const int r1 = SDL_min(op->y + op->glyph->h, compositor->height) - 1;
+        if (c1 < 0 || r1 < 0) continue;
+        const uint64_t opHash = hash_mix(hash_mix(hash_mix((uint64_t)(uintptr_t)op->glyph, (uint32_t)op->x), (uint32_t)op->y), op->argb);
+        for (int r = r0; r <= r1 / COMPOSITOR_TILE_SIZE; ++r) {
+            for (int c = c0; c <= c1 / COMPOSITOR_TILE_SIZE; ++c) {
+                uint64_t* hash = &compositor->nextTileHashes[r * compositor->tileColumns + c];
+                *hash = hash_mix(*hash, opHash);
+            }
+        }
+    }
+
+    compositor->dirtyCount = 0;
+    for (int t = 0; t < tileCount; ++t) {
+        if (compositor->invalidated || compositor->nextTileHashes[t] != compositor->tileHashes[t]) {
+            compositor->dirtyTiles[compositor->dirtyCount++] = t;
+            SDL_Rect tile;
+            get_tile_rect(compositor, t, &tile);
+            if (SDL_RectEmpty(&compositor->uploadRect)) compositor->uploadRect = tile;
+            else SDL_UnionRect(&compositor->uploadRect, &tile, &compositor->uploadRect);
+        }
+    }
+    uint64_t* swap = compositor->tileHashes;
+    compositor->tileHashes = compositor->nextTileHashes;
+    compositor->nextTileHashes = swap;
+    compositor->invalidated = false;
+
+    if (compositor->pool) worker_pool_run(compositor->pool, draw_tile, compositor, compositor->dirtyCount);
+    else for (int t = 0; t < compositor->dirtyCount; ++t) draw_tile(compositor, t);
+
+    compositor->tilesDrawn += compositor->dirtyCount;
+    compositor->tilesSkipped += tileCount - compositor->dirtyCount;
+    return compositor->dirtyCount;
+}
+
+void compositor_present(CClockCompositor* compositor, SDL_Renderer* renderer) {
+    if (!compositor->texture) return;
+    compositor_render(compositor);
+    if (!SDL_RectEmpty(&compositor->uploadRect)) {
+        const SDL_Rect* rect = &compositor->uploadRect;
+        const uint32_t* first = compositor->pixels + (size_t)rect->y * compositor->width + rect->x;
+        SDL_UpdateTexture(compositor->texture, rect, first, compositor->width * (int)sizeof(uint32_t));
+        compositor->uploadRect = (SDL_Rect){ 0 };
+    }
+    SDL_RenderCopy(renderer, compositor->texture, NULL, NULL);
+}
+
+void compositor_destroy(CClockCompositor* compositor) {
+    for (int i = 0; i < COMPOSITOR_MAX_FACES; ++i) free_face(&compositor->faces[i]);
+    free_framebuffer(compositor);
+    free(compositor->ops);
+    *compositor = (CClockCompositor){ 0 };
+}
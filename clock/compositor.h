@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "blend.h"
+#include "workerpool.h"
+
+#define COMPOSITOR_MAX_FACES 8
+#define COMPOSITOR_CHAR_COUNT 128
+#define COMPOSITOR_TILE_SIZE 128
+
+// Glyph coverage kept as A8, scaled once per face instead of converted to ARGB every frame
+typedef struct {
+    uint8_t* coverage;
+    int w;
+    int h;
+    float advance;
+} CClockA8Glyph;
+
+typedef struct {
+    TTF_Font* font;
+    float scale;
+    unsigned long lastUse;
+    CClockA8Glyph glyphs[COMPOSITOR_CHAR_COUNT];
+    bool rasterized[COMPOSITOR_CHAR_COUNT];
+} CClockA8Face;
+
+// One glyph placed in the frame, recorded by compositor_draw_text and rasterized per tile
+typedef struct {
+    const CClockA8Glyph* glyph;
+    int x;
+    int y;
+    uint32_t argb;
+} CClockGlyphOp;
+
+// CPU backend for software renderers (VDI, SDL_RENDERER_ACCELERATED silently falling back):
+// text is blended straight into one ARGB framebuffer which is uploaded once per changed frame.
+// The frame is split in tiles, only tiles whose content hash changed are redrawn, in parallel
+typedef struct {
+    uint32_t* pixels;
+    int width;
+    int height;
+    SDL_Texture* texture;       // streaming, same size as pixels, NULL without renderer
+    CClockBlendSpanFn blendSpan;
+    CClockWorkerPool* pool;     // NULL draws the tiles on the calling thread
+    CClockA8Face faces[COMPOSITOR_MAX_FACES];
+    unsigned long useCounter;
+
+    // Display list of the frame being recorded
+    uint32_t clearColor;
+    CClockGlyphOp* ops;
+    int opCount;
+    int opCapacity;
+
+    int tileColumns;
+    int tileRows;
+    uint64_t* tileHashes;       // content of every tile as last drawn
+    uint64_t* nextTileHashes;
+    int* dirtyTiles;
+    int dirtyCount;
+    bool invalidated;           // every tile is redrawn by the next compositor_render
+    SDL_Rect uploadRect;        // union of the tiles drawn since the last upload
+
+    unsigned long tilesDrawn;
+    unsigned long tilesSkipped;
+} CClockCompositor;
+
+bool compositor_init(CClockCompositor* compositor, SDL_Renderer* renderer, int width, int height, CClockWorkerPool* pool);
+
+// Reallocates the framebuffer when the size changed
+bool compositor_resize(CClockCompositor* compositor, SDL_Renderer* renderer, int width, int height);
+
+// Starts a new frame filled with argb
+void compositor_clear(CClockCompositor* compositor, uint32_t argb);
+
+// Glyphs are rasterized here on the calling thread (SDL_ttf is not thread-safe), the blending is deferred
+void compositor_draw_text(CClockCompositor* compositor, TTF_Font* font, const char* text, int x, int y, float scale, SDL_Color color);
+
+// Redraws the dirty tiles of the recorded frame into pixels, returns how many
+int compositor_render(CClockCompositor* compositor);
+
+// Forces a full redraw on the next frame
+void compositor_invalidate(CClockCompositor* compositor);
+
+// Renders, uploads the changed tiles and copies the framebuffer to the render target
+void compositor_present(CClockCompositor* compositor, SDL_Renderer* renderer);
+
+// Cached glyph faces hold pointers to fonts, call before closing them
+void compositor_destroy(CClockCompositor* compositor);
+
+// True when the renderer composites on the CPU anyway
+bool compositor_renderer_is_software(SDL_Renderer* renderer);
@@ -0,0 +1,413 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // poll
+#endif
+
+#include "control.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "time_source.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define CONTROL_BUFFER_SIZE (CONTROL_MAX_BATCH * CONTROL_LINE_MAX)
+
+static const char* const g_styleNames[] = { "hh:mm:ss", "hh:mm", "analog" };
+
+void control_path(const char* name, char* out, size_t size) {
+#ifdef _WIN32
+    snprintf(out, size, "\\\\.\\pipe\\%s", name);
+#else
+    // A path as is, a name in the per user runtime directory
+    const char* runtime = getenv("XDG_RUNTIME_DIR");
+    if (strchr(name, '/')) snprintf(out, size, "%s", name);
+    else if (runtime && runtime[0]) snprintf(out, size, "%s/%s.sock", runtime, name);
+    else snprintf(out, size, "/tmp/%s-%u.sock", name, (unsigned)getuid());
+#endif
+}
+
+static void parse_line(const char* line, CClockControlCommand* command) {
+    char verb[16] = "", argument[32] = "", extra[2] = "";
+#ifdef _WIN32
+    const int fields = sscanf_s(line, "%15s %31s %1s", verb, (unsigned)sizeof(verb), argument, (unsigned)sizeof(argument), extra, (unsigned)sizeof(extra));
+#else
+    const int fields = sscanf(line, "%15s %31s %1s", verb, argument, extra);
+#endif
+    *command = (CClockControlCommand){ CONTROL_INVALID, 0, "" };
+    if (fields == 3) snprintf(command->reply, sizeof(command->reply), "error too many arguments");
+    else if (strcmp(verb, "start") == 0) {
+        if (fields == 2 && time_source_parse_duration(argument, &command->value) && command->value > 0) command->kind = CONTROL_START;
+        else snprintf(command->reply, sizeof(command->reply), "error expected start <duration>, ex: start 25m");
+    }
+    else if (strcmp(verb, "cancel") == 0 && fields == 1) command->kind = CONTROL_CANCEL;
+    else if (strcmp(verb, "list") == 0 && fields == 1) command->kind = CONTROL_LIST;
+    else if (strcmp(verb, "mode") == 0 && fields == 2) {
+        command->kind = CONTROL_MODE;
+        if (strcmp(argument, "clock") == 0) command->value = CCLOCK_CLOCK;
+        else if (strcmp(argument, "world") == 0) command->value = CCLOCK_WORLD;
+        else {
+            command->kind = CONTROL_INVALID;
+            snprintf(command->reply, sizeof(command->reply), "error expected mode clock|world");
+        }
+    }
+    else if (strcmp(verb, "style") == 0 && fields == 2) {
+        command->kind = CONTROL_INVALID;
+        snprintf(command->reply, sizeof(command->reply), "error expected style hh:mm:ss|hh:mm|analog");
+        for (int i = 0; i < (int)(sizeof(g_styleNames) / sizeof(g_styleNames[0])); ++i) {
+            if (strcmp(argument, g_styleNames[i]) == 0) *command = (CClockControlCommand){ CONTROL_STYLE, i, "" };
+        }
+    }
+    else snprintf(command->reply, sizeof(command->reply), "error unknown command '%s'", verb);
+}
+
+bool control_apply(CClockControlCommand* command, CClockEngine* engine, CClockStyle* style, const CClockSnapshot* now) {
+    // The parser already answered
+    if (command->kind == CONTROL_INVALID) return false;
+    bool styleChanged = false;
+    snprintf(command->reply, sizeof(command->reply), "ok");
+    switch (command->kind) {
+    case CONTROL_START:
+        cclock_chrono_start(engine, now, command->value);
+        break;
+    case CONTROL_CANCEL:
+        if (engine->mode == CCLOCK_CHRONO) engine->mode = CCLOCK_CLOCK;
+        else snprintf(command->reply, sizeof(command->reply), "error no countdown running");
+        break;
+    case CONTROL_LIST:
+        if (engine->mode == CCLOCK_CHRONO) {
+            uint64_t completed, total;
+            cclock_chrono_progress(engine, now, &completed, &total);
+            snprintf(command->reply, sizeof(command->reply), "mode=chrono style=%s left=%ld total=%llu",
+                g_styleNames[*style], cclock_chrono_left(engine, now), (unsigned long long)total);
+        }
+        else snprintf(command->reply, sizeof(command->reply), "mode=%s style=%s", engine->mode == CCLOCK_WORLD ? "world" : "clock", g_styleNames[*style]);
+        break;
+    case CONTROL_MODE:
+        engine->mode = (enum CClockMode)command->value;
+        break;
+    case CONTROL_STYLE:
+        // Like the menu: a style is a clock mode
+        engine->mode = CCLOCK_CLOCK;
+        styleChanged = *style != (CClockStyle)command->value;
+        *style = (CClockStyle)command->value;
+        break;
+    default:
+        break;
+    }
+    return styleChanged;
+}
+
+// > 0 bytes read, 0 nothing there yet (wait false), -1 closed
+static int client_read(CClockControl* control, char* out, int size, bool wait) {
+#ifdef _WIN32
+    DWORD available = 0, read = 0;
+    if (!PeekNamedPipe(control->pipe, NULL, 0, NULL, &available, NULL)) return -1;
+    if (!wait && available == 0) return 0;
+    if (!ReadFile(control->pipe, out, wait || (int)available > size ? (DWORD)size : available, &read, NULL) || read == 0) return -1;
+    return (int)read;
+#else
+    if (!wait) {
+        struct pollfd ready = { .fd = control->clientFd, .events = POLLIN };
+        if (poll(&ready, 1, 0) <= 0) return 0;
+    }
+    ssize_t count;
+    do count = recv(control->clientFd, out, (size_t)size, 0);
+    while (count < 0 && errno == EINTR);
+    return count > 0 ? (int)count : -1;
+#endif
+}
+
+static bool client_write(CClockControl* control, const char* bytes, size_t length) {
+#ifdef _WIN32
+    DWORD written;
+    return WriteFile(control->pipe, bytes, (DWORD)length, &written, NULL) && written == length;
+#else
+    while (length > 0) {
+        const ssize_t count = send(control->clientFd, bytes, length, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        bytes += count;
+        length -= (size_t)count;
+    }
+    return true;
+#endif
+}
+
+// Hands the batch to the event loop and waits for its replies, then answers them in one write
+static bool submit(CClockControl* control, CClockControlCommand* commands, int count) {
+    bool needsLoop = false;
+    for (int i = 0; i < count; ++i) needsLoop |= commands[i].kind != CONTROL_INVALID;
+    if (needsLoop) {
+        SDL_LockMutex(control->lock);
+        memcpy(control->batch, commands, (size_t)count * sizeof(CClockControlCommand));
+        control->batchCount = count;
+        control->batchPending = true;
+        SDL_Event event = { .type = control->eventType };
+        event.user.data1 = control;
+        SDL_PushEvent(&event);
+        while (control->batchPending && !SDL_AtomicGet(&control->quit)) SDL_CondWait(control->done, control->lock);
+        memcpy(commands, control->batch, (size_t)count * sizeof(CClockControlCommand));
+        SDL_UnlockMutex(control->lock);
+        if (SDL_AtomicGet(&control->quit)) return false;
+    }
+
+    char replies[CONTROL_MAX_BATCH * (CONTROL_REPLY_MAX + 1)];
+    size_t length = 0;
+    for (int i = 0; i < count; ++i) length += (size_t)snprintf(replies + length, sizeof(replies) - length, "%s\n", commands[i].reply);
+    return client_write(control, replies, length);
+}
+
+static void serve(CClockControl* control) {
+    char buffer[CONTROL_BUFFER_SIZE + 1];
+    int length = 0;
+    for (bool open = true; open && !SDL_AtomicGet(&control->quit);) {
+        int count = client_read(control, buffer + length, CONTROL_BUFFER_SIZE - length, true);
+        if (count <= 0) break;
+        length += count;
+        // Whatever else the client already sent joins the same batch
+        while (length < CONTROL_BUFFER_SIZE && (count = client_read(control, buffer + length, CONTROL_BUFFER_SIZE - length, false)) > 0) length += count;
+        if (count < 0) open = false;
+
+        CClockControlCommand commands[CONTROL_MAX_BATCH];
+        int commandCount = 0, consumed = 0;
+        for (char* newline; (newline = memchr(buffer + consumed, '\n', (size_t)(length - consumed))) != NULL;) {
+            *newline = '\0';
+            if (newline > buffer + consumed && newline[-1] == '\r') newline[-1] = '\0';
+            parse_line(buffer + consumed, &commands[commandCount++]);
+            consumed = (int)(newline - buffer) + 1;
+            if (commandCount == CONTROL_MAX_BATCH) {
+                if (!submit(control, commands, commandCount)) return;
+                commandCount = 0;
+            }
+        }
+        // Closed without a last newline: still a command
+        if (!open && consumed < length) {
+            buffer[length] = '\0';
+            parse_line(buffer + consumed, &commands[commandCount++]);
+            consumed = length;
+        }
+        if (commandCount > 0 && !submit(control, commands, commandCount)) return;
+
+        memmove(buffer, buffer + consumed, (size_t)(length - consumed));
+        length -= consumed;
+        if (length == CONTROL_BUFFER_SIZE) {
+            client_write(control, "error line too long\n", 20);
+            return;
+        }
+    }
+}
+
+static int control_main(void* data) {
+    CClockControl* control = data;
+    while (!SDL_AtomicGet(&control->quit)) {
+#ifdef _WIN32
+        const bool connected = ConnectNamedPipe(control->pipe, NULL) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if (connected && !SDL_AtomicGet(&control->quit)) {
+            serve(control);
+            FlushFileBuffers(control->pipe);
+        }
+        DisconnectNamedPipe(control->pipe);
+#else
+        const int fd = accept(control->listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        // control_stop shuts the client down, unless it comes first
+        SDL_LockMutex(control->lock);
+        const bool quit = SDL_AtomicGet(&control->quit) != 0;
+        if (!quit) control->clientFd = fd;
+        SDL_UnlockMutex(control->lock);
+        if (!quit) serve(control);
+        SDL_LockMutex(control->lock);
+        control->clientFd = -1;
+        SDL_UnlockMutex(control->lock);
+        close(fd);
+#endif
+    }
+    return 0;
+}
+
+bool control_start(CClockControl* control, const char* name, Uint32 eventType) {
+    memset(control, 0, sizeof(*control));
+    control->eventType = eventType;
+    control_path(name, control->path, sizeof(control->path));
+#ifdef _WIN32
+    // One instance, local clients only. FIRST_PIPE_INSTANCE fails if another clock has the name
+    control->pipe = CreateNamedPipeA(control->path, PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, CONTROL_BUFFER_SIZE, CONTROL_BUFFER_SIZE, 0, NULL);
+    if (control->pipe == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Cannot create the control pipe %s (error %lu)\n", control->path, GetLastError());
+        return false;
+    }
+#else
+    control->clientFd = -1;
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(control->path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Control socket path too long: %s\n", control->path);
+        return false;
+    }
+    memcpy(address.sun_path, control->path, strlen(control->path) + 1);
+    control->listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (control->listenFd < 0) {
+        fprintf(stderr, "Cannot create the control socket: %s\n", strerror(errno));
+        return false;
+    }
+    // Only the user: anyone who can connect can drive the clock
+    const mode_t mask = umask(0077);
+    int result = bind(control->listenFd, (struct sockaddr*)&address, sizeof(address));
+    if (result != 0 && errno == EADDRINUSE) {
+        const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool alive = probe >= 0 && connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (!alive) {
+            unlink(control->path);
+            result = bind(control->listenFd, (struct sockaddr*)&address, sizeof(address));
+        }
+        else errno = EADDRINUSE;
+    }
+    umask(mask);
+    if (result != 0 || listen(control->listenFd, 4) != 0) {
+        fprintf(stderr, "Cannot listen on %s: %s\n", control->path, strerror(errno));
+        close(control->listenFd);
+        return false;
+    }
+#endif
+    control->lock = SDL_CreateMutex();
+    control->done = SDL_CreateCond();
+    control->thread = control->lock && control->done ? SDL_CreateThread(control_main, "control", control) : NULL;
+    if (!control->thread) {
+        control_stop(control);
+        return false;
+    }
+    return true;
+}
+
+CClockControlCommand* control_take(CClockControl* control, int* count) {
+    SDL_LockMutex(control->lock);
+    const bool pending = control->batchPending;
+    *count = pending ? control->batchCount : 0;
+    SDL_UnlockMutex(control->lock);
+    // The thread waits on it until control_complete
+    return pending ? control->batch : NULL;
+}
+
+void control_complete(CClockControl* control) {
+    SDL_LockMutex(control->lock);
+    control->batchPending = false;
+    SDL_CondSignal(control->done);
+    SDL_UnlockMutex(control->lock);
+}
+
+void control_stop(CClockControl* control) {
+    SDL_AtomicSet(&control->quit, 1);
+    if (control->lock) {
+        SDL_LockMutex(control->lock);
+#ifndef _WIN32
+        if (control->clientFd >= 0) shutdown(control->clientFd, SHUT_RDWR);
+#endif
+        SDL_CondSignal(control->done);
+        SDL_UnlockMutex(control->lock);
+    }
+    if (control->thread) {
+#ifdef _WIN32
+        // Out of ReadFile, or out of ConnectNamedPipe by connecting to it
+        HANDLE thread = OpenThread(THREAD_TERMINATE, FALSE, (DWORD)SDL_GetThreadID(control->thread));
+        if (thread) {
+            CancelSynchronousIo(thread);
+            CloseHandle(thread);
+        }
+        HANDLE wake = CreateFileA(control->path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        if (wake != INVALID_HANDLE_VALUE) CloseHandle(wake);
+#else
+        // accept returns at once on a shut down socket
+        shutdown(control->listenFd, SHUT_RDWR);
+#endif
+        SDL_WaitThread(control->thread, NULL);
+    }
+#ifdef _WIN32
+    if (control->pipe && control->pipe != INVALID_HANDLE_VALUE) CloseHandle(control->pipe);
+#else
+    if (control->listenFd > 0) {
+        close(control->listenFd);
+        unlink(control->path);
+    }
+#endif
+    if (control->done) SDL_DestroyCond(control->done);
+    if (control->lock) SDL_DestroyMutex(control->lock);
+    memset(control, 0, sizeof(*control));
+}
+
+int control_send(const char* name, const char* const* commands, int count, FILE* out) {
+    char path[260];
+    control_path(name, path, sizeof(path));
+    char request[CONTROL_BUFFER_SIZE];
+    size_t length = 0;
+    for (int i = 0; i < count && length < sizeof(request); ++i) length += (size_t)snprintf(request + length, sizeof(request) - length, "%s\n", commands[i]);
+    if (length > sizeof(request)) length = sizeof(request);
+
+    char reply[CONTROL_MAX_BATCH * (CONTROL_REPLY_MAX + 1) + 1];
+    size_t replyLength = 0;
+    int lines = 0;
+#ifdef _WIN32
+    HANDLE pipe = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY && WaitNamedPipeA(path, 1000)) {
+        pipe = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    }
+    if (pipe == INVALID_HANDLE_VALUE) return -1;
+    DWORD transferred;
+    WriteFile(pipe, request, (DWORD)length, &transferred, NULL);
+    // No half close on a pipe: read until every command has its line
+    while (lines < count && replyLength < sizeof(reply) - 1
+        && ReadFile(pipe, reply + replyLength, (DWORD)(sizeof(reply) - 1 - replyLength), &transferred, NULL) && transferred > 0) {
+        for (DWORD i = 0; i < transferred; ++i) lines += reply[replyLength + i] == '\n';
+        replyLength += transferred;
+    }
+    CloseHandle(pipe);
+#else
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(address.sun_path)) return -1;
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    for (size_t sent = 0; sent < length;) {
+        const ssize_t result = send(fd, request + sent, length - sent, 0);
+        if (result <= 0) break;
+        sent += (size_t)result;
+    }
+    // The clock answers everything it got, then closes
+    shutdown(fd, SHUT_WR);
+    for (ssize_t result; replyLength < sizeof(reply) - 1 && (result = recv(fd, reply + replyLength, sizeof(reply) - 1 - replyLength, 0)) > 0;) {
+        replyLength += (size_t)result;
+    }
+    close(fd);
+#endif
+    reply[replyLength] = '\0';
+    fputs(reply, out);
+
+    int failed = 0;
+    lines = 0;
+    for (const char* line = reply; *line; ++lines) {
+        failed += strncmp(line, "error", 5) == 0;
+        const char* next = strchr(line, '\n');
+        if (!next) break;
+        line = next + 1;
+    }
+    return failed + (lines < count ? count - lines : 0);
+}
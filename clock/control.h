@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <SDL.h>
+
+#include "cclock.h"
+
+// Local control interface for scripts and bots on the same machine: a Unix domain socket
+// ($XDG_RUNTIME_DIR/<name>.sock, /tmp/<name>-<uid>.sock without it) or the named pipe \\.\pipe\<name>.
+// One command per line, one reply line per command:
+//
+//   start <duration>          count down "90", "90s", "25m", "2h"... (the countdown of the menu)
+//   cancel                    back to the clock
+//   list                      mode=chrono style=hh:mm:ss left=1499 total=1500
+//   mode clock|world
+//   style hh:mm:ss|hh:mm|analog
+//
+// replies are "ok", the list line or "error <reason>". A thread blocks on the socket and
+// parses; every complete line a client has sent by then goes to the event loop as one batch behind a
+// single SDL event, so the loop sleeps in SDL_WaitEventTimeout as usual and wakes once per batch.
+// The thread writes the replies once the loop has applied the batch
+
+#define CONTROL_NAME_DEFAULT "cclock"
+#define CONTROL_MAX_BATCH 32
+#define CONTROL_LINE_MAX 128
+#define CONTROL_REPLY_MAX 96
+
+typedef enum {
+    CONTROL_INVALID,        // reply already set by the parser
+    CONTROL_START,
+    CONTROL_CANCEL,
+    CONTROL_LIST,
+    CONTROL_MODE,
+    CONTROL_STYLE,
+} CClockControlKind;
+
+typedef struct {
+    CClockControlKind kind;
+    long value;             // START: seconds, MODE: enum CClockMode, STYLE: CClockStyle
+    char reply[CONTROL_REPLY_MAX];
+} CClockControlCommand;
+
+typedef struct {
+    Uint32 eventType;       // pushed once per batch, event.user.data1 is the CClockControl
+    char path[260];
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* done;
+    SDL_atomic_t quit;
+    // The batch waiting for the event loop, owned by it between the event and control_complete
+    CClockControlCommand batch[CONTROL_MAX_BATCH];
+    int batchCount;
+    bool batchPending;
+#ifdef _WIN32
+    void* pipe;
+#else
+    int listenFd;
+    int clientFd;
+#endif
+} CClockControl;
+
+// Where the socket or pipe of name is
+void control_path(const char* name, char* out, size_t size);
+
+// Creates the socket (a stale one left by a crash is replaced, a live one is an error) and starts
+// the thread. eventType comes from SDL_RegisterEvents
+bool control_start(CClockControl* control, const char* name, Uint32 eventType);
+
+// Event loop side: the pending batch, NULL when there is none (count set to 0)
+CClockControlCommand* control_take(CClockControl* control, int* count);
+
+// Applies one command to the engine and fills its reply. *style is the style of the clock mode; true
+// when it changed, the caller compiles the formats for it again
+bool control_apply(CClockControlCommand* command, CClockEngine* engine, CClockStyle* style, const CClockSnapshot* now);
+
+// Hands the replies of the batch back to the thread
+void control_complete(CClockControl* control);
+
+// Unblocks and joins the thread, removes the socket
+void control_stop(CClockControl* control);
+
+// Client side (--ctl): sends the commands in one write and prints the replies to out. Returns the
+// number of commands that failed, -1 when nothing listens on name
+int control_send(const char* name, const char* const* commands, int count, FILE* out);
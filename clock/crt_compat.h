@@ -0,0 +1,14 @@
+#pragma once
+
+// The bounded CRT functions the MSVC build requires (SDLCheck turns the plain ones into errors),
+// mapped to their standard counterparts elsewhere. The sizes still bound the copies
+#ifndef _WIN32
+#include <stdio.h>
+#include <time.h>
+
+#define sprintf_s snprintf
+#define sscanf_s sscanf     // numbers only, no %s or %c that would take a size
+#define strcpy_s(dest, size, src) snprintf(dest, size, "%s", src)
+#define fopen_s(file, path, mode) ((*(file) = fopen(path, mode)) ? 0 : -1)
+#define localtime_s(tm, time) localtime_r(time, tm)
+#endif
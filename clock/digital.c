@@ -1,5 +1,11 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // localtime_r
+#endif
+
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <stdbool.h>
 #include <math.h>
@@ -10,13 +16,31 @@
 
 #include <SDL.h>
 #include <SDL_ttf.h>
-#include <SDL_syswm.h>
-
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <windows.h>
 
-#include <Shobjidl.h>
+#include "alarm.h"
+#include "analog.h"
+#include "bench.h"
+#include "cclock.h"
+#include "compositor.h"
+#include "control.h"
+#include "crt_compat.h"
+#include "export.h"
+#include "format.h"
+#include "shm_ring.h"
+#include "glyph_atlas.h"
+#include "profile.h"
+#include "skin.h"
+#include "log.h"
+#include "platform.h"
+#include "replay.h"
+#include "soak.h"
+#include "soak_track.h"
+#include "stream.h"
+#include "term.h"
+#include "text_cache.h"
+#include "time_source.h"
+#include "transition.h"
+#include "worldclock.h"
 
 #define WINDOW_WIDTH 1600
 #define WINDOW_HEIGHT 350
@@ -28,6 +52,28 @@ typedef uint32_t u32;
 #define FPS 24.0
 #define DELTA_TIME 1 / FPS
 
+// Wake a little after the second/minute boundary so time() has already rolled over
+#define TICK_SLACK_MS 2
+// Longest wait when nothing is scheduled, a date-only format changes once a day
+#define TICK_MAX_WAIT_MS (86400u * 1000u + TICK_SLACK_MS)
+// "Monday 3 March 2025", the time format follows the style unless the ini or --time-format sets one
+#define DATE_FORMAT_DEFAULT "%A %-d %B %Y"
+// How long the label of an alarm that fired replaces the date
+#define ALARM_SHOW_SECONDS 60
+// --soak: clock time per frame, one script action per simulated hour, a sample every few hours
+#define SOAK_FRAME_SECONDS 30
+#define SOAK_SAMPLE_HOURS 6
+#define SOAK_RSS_TOLERANCE_MB 8
+#define SOAK_HANDLE_TOLERANCE 16
+#define SOAK_ALLOCATION_TOLERANCE 256
+// Scale change per wheel notch, eased toward with this time constant, within the scale limits
+#define ZOOM_STEP 0.1f
+#define ZOOM_TIME_CONSTANT_MS 40.f
+#define ZOOM_MIN_SCALE 0.5f
+#define ZOOM_MAX_SCALE 1.5f
+// Blur radius of the soft shadow in pixels of the 256px font, the date font gets half
+#define SHADOW_BLUR_RADIUS 8
+
 //https://gcc.gnu.org/onlinedocs/gcc/Optimize-Options.html
 
 //MAYBE:: Make it compatible with Linux/MacoOS ????
@@ -35,33 +81,6 @@ typedef uint32_t u32;
 //TODO:: In some cases the clock may freeze and stop updating, usually it happens when we put we pc sleep and awake it later
 //TODO:: When changing something in the Config we need to update the ini right away instead of only at app close
 //TODO:: Link statically with SDL and SDL_TTF
-enum CClockMode {
-    CCLOCK_CLOCK,
-    CCLOCK_TIMER,
-    CCLOCK_CHRONO,
-};
-
-enum HMenuCClockContextMenuId {
-    HMENU_CLOCK_MODE_HH_MM_SS_ID = 1,
-    HMENU_CLOCK_MODE_HH_MM_ID,
-    HMENU_CHRONO_MODE_10s_ID,
-    HMENU_CHRONO_MODE_10M_ID,
-    HMENU_CHRONO_MODE_15M_ID,
-    HMENU_CHRONO_MODE_30M_ID,
-    HMENU_CHRONO_MODE_1H_ID,
-    HMENU_CHRONO_MODE_2H_ID,
-    HMENU_CHRONO_MODE_3H_ID,
-    HMENU_CHRONO_MODE_4H_ID,
-    HMENU_CHRONO_MODE_5H_ID,
-    HMENU_SHADOW_ID,
-    HMENU_EXIT_ID,
-};
-
-typedef enum {
-    CCLOCK_STYLE_HH_MM_SS,
-    CCLOCK_STYLE_HH_MM,
-} CClockStyle;
-
 
 typedef struct {
     int winX;
@@ -69,61 +88,80 @@ typedef struct {
     f32 clockScale;
     int shadowEffect;
     CClockStyle style;
+    int transition;         // CClockTransitionStyle of the digits
+    char skin[260];         // skin pack directory, empty for digital-mono.ttf
+    char timeFormat[FORMAT_MAX_TEXT]; // see format.h, empty: "%H:%M" or "%H:%M:%S" from the style
+    char dateFormat[FORMAT_MAX_TEXT];
+    char alarms[ALARM_MAX_SPECS][ALARM_SPEC_LENGTH]; // "<rule>|<label>", see alarm.h
+    int alarmCount;
+    CClockZoneSpec zones[WORLD_CLOCK_MAX_ZONES];
+    int zoneCount;
 } CClockConfig;
 
-struct tm get_tm() {
-    time_t currentTime;
-    time(&currentTime);
-    // Convert the current time to a local time structure
-    struct tm localTime = { 0 };
-    localtime_s(&localTime, &currentTime);
-
-    return localTime;
-}
-
-struct tm get_tm_chrono(unsigned long offsetBySeconds) {
-    struct tm tm = get_tm();
-    tm.tm_sec += offsetBySeconds;
-    time_t futureTime = mktime(&tm);
-
-    // Convert the current time to a local time structure
-    struct tm localTime = { 0 };
-    localtime_s(&localTime, &futureTime);
-
-    return localTime;
-}
-
-// return time difference in seconds
-double get_tm_diff(const struct tm* lhs, const struct tm* rhs) {
-
-    const time_t t1 = mktime(lhs);
-    const time_t t2 = mktime(rhs);
-
-    const double diff = difftime(t2, t1);
-
-    return diff;
+typedef struct {
+    bool fixedFps;          // old behaviour: render and present at FPS no matter what changed
+    double profileSeconds;  // > 0: run the idle profile for that long then exit with a report
+    double idleBudget;      // CPU ms per hour allowed during the idle profile, <= 0 disables the check
+    int forceStyle;         // -1 keeps the style from the ini
+    int forceTransition;    // -1 keeps the transition from the ini
+    const char* forceSkin;  // NULL keeps the skin from the ini, "none" goes back to the font
+    const char* forceTimeFormat; // NULL keeps the formats from the ini, "" follows the style again
+    const char* forceDateFormat;
+    const char* addAlarms[ALARM_MAX_SPECS]; // --alarm, appended to the ini
+    int addAlarmCount;
+    bool softwareCompositor; // blend text on the CPU even if the renderer is accelerated
+    int renderThreads;      // software compositor threads, 0 = one per CPU
+    CClockExportOptions exportOptions; // exportOptions.path != NULL: write raw frames instead of opening a window
+    const char* timeSource; // time_source.h spec, NULL for the real time
+    const char* simulateStart;    // != NULL: print the ticks from that local time instead of opening a window
+    const char* simulateDuration; // how much clock time to simulate, "3d", "36h"...
+    const char* simulateChrono;   // optional countdown started with the simulation
+    double soakDays;        // > 0: hidden window, run that many days of clock time through the soak script
+    const char* recordPath; // != NULL: record the input of the session there (replay.h)
+    const char* replayPath; // != NULL: hidden window, replay that recording then print the frame times
+    bool replayFast;        // replay without waiting between the events
+    CClockLogLevel logLevel; // runtime level of log.h, hit tests and relayouts log at debug
+    const char* platform;   // platform.h backend name, NULL: the one of the window's video driver
+    bool term;              // draw in the terminal instead of opening a window (term.h)
+    CClockTermOptions termOptions;
+    const char* termChrono; // optional countdown shown by --term instead of the clock
+    bool stream;            // print the ticks to stdout instead of opening a window (stream.h)
+    CClockStreamOptions streamOptions;
+    const char* streamChrono; // optional countdown streamed instead of the clock
+    bool control;           // accept commands on the control socket (control.h)
+    const char* controlName; // socket or pipe name, CONTROL_NAME_DEFAULT by default
+    const char* ctlCommands[CONTROL_MAX_BATCH]; // --ctl: send those to a running clock and exit
+    int ctlCount;
+    const char* shmRead;    // != NULL: measure the latency of another cclock's --export shm:<name>
+    int benchArgc;          // > 0: run the benchmark named by benchArgv[0] instead of the clock
+    char** benchArgv;
+} CClockOptions;
+
+// Every wall time read of the clock, chrono and alarms goes through it (--time-source, --simulate)
+static CClockTimeSource g_clockTime = { .kind = CCLOCK_TIME_REAL };
+
+// Refresh interval of the display the window is on, used by the smooth second hand
+static u32 get_display_frame_ms(SDL_Window* window) {
+    SDL_DisplayMode displayMode;
+    if (SDL_GetWindowDisplayMode(window, &displayMode) == 0 && displayMode.refresh_rate > 0) {
+        return (u32)(1000 / displayMode.refresh_rate);
+    }
+    return 1000 / 60;
 }
 
-HWND get_hwnd(SDL_Window* window) {
-    // Get window handle (https://stackoverflow.com/a/24118145/3357935)
-    SDL_SysWMinfo wmInfo;
-    // Initialize wmInfo
-    SDL_VERSION(&wmInfo.version);
-    SDL_GetWindowWMInfo(window, &wmInfo);
-    HWND hWnd = wmInfo.info.win.window;
-
-    return hWnd;
+// Real milliseconds to wait until the text can change, the time source may run faster than real time
+static u32 get_ms_until_next_tick(const CClockEngine* engine, u32 limit) {
+    CClockSnapshot now;
+    cclock_snapshot(engine, &now);
+    return time_source_real_ms(&g_clockTime, cclock_wall_ms_until_next_tick(engine, &now) + TICK_SLACK_MS, limit);
 }
 
-// Makes a window transparent by setting a transparency color.
-bool MakeWindowTransparent(SDL_Window* window, COLORREF colorKey) {
-
-    HWND hWnd = get_hwnd(window);
-    // Change window type to layered (https://stackoverflow.com/a/3970218/3357935)
-    SetWindowLong(hWnd, GWL_EXSTYLE, GetWindowLong(hWnd, GWL_EXSTYLE) | WS_EX_LAYERED);
-
-    // Set transparency color
-    return SetLayeredWindowAttributes(hWnd, colorKey, 0, LWA_COLORKEY);
+// Real milliseconds until the wall clock reaches `when`, clamped to `limit`
+static u32 get_ms_until(time_t when, u32 limit) {
+    const int64_t nowNs = time_source_now_ns(&g_clockTime);
+    const int64_t wallMs = (int64_t)when * 1000 - nowNs / 1000000;
+    if (wallMs <= 0) return 0;
+    return time_source_real_ms(&g_clockTime, wallMs + TICK_SLACK_MS, limit);
 }
 
 SDL_HitTestResult MyHitTestCallback(SDL_Window* win, const SDL_Point* point, void* data) {
@@ -133,38 +171,22 @@ SDL_HitTestResult MyHitTestCallback(SDL_Window* win, const SDL_Point* point, voi
     SDL_GetWindowSize(win, &w, &h);
     SDL_Rect rect = { .x = 0, .y = 0, .w = w, .h = h / 2 };
     if (SDL_PointInRect(point, &rect)) {
-        SDL_Log("HIT-TEST: DRAGGABLE\n");
+        LOG_DEBUG("hit test %d,%d: draggable", point->x, point->y);
         return SDL_HITTEST_DRAGGABLE;
     }
-    SDL_Log("HIT-TEST: NORMAL\n");
+    LOG_DEBUG("hit test %d,%d: normal", point->x, point->y);
     return SDL_HITTEST_NORMAL;
 }
 
-static void render_text(SDL_Renderer* renderer, TTF_Font* font, const char* dateStr, int x, int y, float scale, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, dateStr, color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-
-    int textWidth, textHeight;
-    SDL_QueryTexture(texture, NULL, NULL, &textWidth, &textHeight);
-
-    const SDL_Rect textDestRect = {
-        .x = x,
-        .y = y,
-        .w = (int) (textWidth * scale),
-        .h = (int) (textHeight * scale),
-    };
-
-    SDL_RenderCopy(renderer, texture, NULL, &textDestRect);
-
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
-}
-
 static void render_digit_str(SDL_Renderer* renderer, TTF_Font* font, const char* text, int* x, int* y) {
 
     SDL_Surface* surface = TTF_RenderText_Solid(font, text, (SDL_Color) { 255, 255, 255, 255 });
+    if (!surface) return;
     SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-
+    if (!texture) {
+        SDL_FreeSurface(surface);
+        return;
+    }
 
     int textWidth, textHeight;
     SDL_QueryTexture(texture, NULL, NULL, &textWidth, &textHeight);
@@ -207,49 +229,6 @@ void render_digit(SDL_Renderer* renderer, TTF_Font* font, int digit, int* x, int
     render_digit_str(renderer, font, text, x, y);
 }
 
-int show_context_menu(SDL_Window* window, int x, int y, bool isShadowEnabled) {
-    //Create the popup MENU
-    HMENU hmainPopupMenu = CreatePopupMenu();
-    HMENU hClockSubMenu = CreatePopupMenu();
-    HMENU hChronoSubMenu = CreatePopupMenu();
-    //Insert wanted options here
-    //we can use AppendMenuA or InsertMenuA
-    AppendMenuA(hmainPopupMenu, MF_POPUP, (UINT_PTR)hClockSubMenu, "Clock Mode");
-    AppendMenuA(hClockSubMenu,  MF_STRING, HMENU_CLOCK_MODE_HH_MM_SS_ID, "HH:MM:SS");
-    AppendMenuA(hClockSubMenu,  MF_STRING, HMENU_CLOCK_MODE_HH_MM_ID, "HH:MM");
-    AppendMenuA(hmainPopupMenu, MF_POPUP, (UINT_PTR)hChronoSubMenu, "Chrono Mode");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_10s_ID, "10s");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_10M_ID, "10min");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_15M_ID, "15min");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_30M_ID, "30min");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_1H_ID, "1h");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_2H_ID, "2h");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_3H_ID, "3h");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_4H_ID, "4h");
-    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_5H_ID, "5h");
-
-    AppendMenuA(hmainPopupMenu, isShadowEnabled ? MF_CHECKED: MF_UNCHECKED, HMENU_SHADOW_ID, "Shadow");
-    AppendMenuA(hmainPopupMenu, MF_STRING, HMENU_EXIT_ID, "Exit");
-
-    //Get the window HWND from SDL_Window
-    HWND hwnd = get_hwnd(window);
-
-    SetForegroundWindow(hwnd);
-
-    POINT point = { .x = x, .y = y };
-    ClientToScreen(hwnd, &point);
-    const int itemSelected = TrackPopupMenu(hmainPopupMenu,
-        TPM_BOTTOMALIGN | TPM_LEFTALIGN,
-        point.x, point.y, 0, hwnd, NULL);
-
-    // Clean up
-    DestroyMenu(hChronoSubMenu);
-    DestroyMenu(hClockSubMenu);
-    DestroyMenu(hmainPopupMenu);
-
-    return itemSelected;
-}
-
 static SDL_Rect get_clock_position(SDL_Window* window, int textWidth, int textHeight) {
     
     int winW, winH;
@@ -260,14 +239,45 @@ static SDL_Rect get_clock_position(SDL_Window* window, int textWidth, int textHe
         textWidth,
         textHeight
     };
-    printf("win size: %dx%d\n", winW, winH);
-    printf("fnt size: %dx%d\n", textWidth, textHeight);
+    LOG_DEBUG("win size: %dx%d, fnt size: %dx%d", winW, winH, textWidth, textHeight);
 
     return ttfDestRect;
 }
 
+// Same center, new size: the frames of a zoom need neither the window size nor the log lines
+static SDL_Rect resize_centered(SDL_Rect rect, int textWidth, int textHeight) {
+    rect.x += (rect.w - textWidth) / 2;
+    rect.y += (rect.h - textHeight) / 2;
+    rect.w = textWidth;
+    rect.h = textHeight;
+    return rect;
+}
+
+// Size of the clock text at scale 1 per mode and style, the text scales linearly so a zoom only multiplies.
+// Cleared when the skin or the formats change
+#define LAYOUT_CACHE_SIZE 8
+
+typedef struct {
+    int mode;
+    int style;  // -1 outside of the clock mode
+    int width;
+    int height;
+} CClockLayoutEntry;
+
+typedef struct {
+    CClockLayoutEntry entries[LAYOUT_CACHE_SIZE];
+    int count;
+} CClockLayoutCache;
+
+// Digits come from the skin pack instead of the font when one is loaded
+static const CClockSkin* g_skin = NULL;
+
 static void get_text_size(TTF_Font* font, const char* text, float scale, int* textWidth, int* textHeight) {
-    if (TTF_SizeText(font, text, textWidth, textHeight) < 0) {
+    if (g_skin) {
+        cclock_layout_text(&g_skin->images.metrics, text, NULL, 0, textWidth);
+        *textHeight = g_skin->images.metrics.lineHeight;
+    }
+    else if (TTF_SizeText(font, text, textWidth, textHeight) < 0) {
         fprintf(stderr, "Could not retrieve text size\n");
         exit(EXIT_FAILURE);
     }
@@ -275,28 +285,30 @@ static void get_text_size(TTF_Font* font, const char* text, float scale, int* te
     *textHeight *= scale;
 }
 
-static void get_hh_mm_ss_text_size(TTF_Font* font, float scale, int* textWidth, int* textHeight) {
-    const char* placeholder = "00:00:00";
-    get_text_size(font, placeholder, scale, textWidth, textHeight);
-}
-
-static void get_hh_mm_text_size(TTF_Font* font, float scale, int* textWidth, int* textHeight) {
-    const char* placeholder = "00:00";
-    get_text_size(font, placeholder, scale, textWidth, textHeight);
-}
-static void get_clock_text_size(enum CClockMode mode, TTF_Font* font, const CClockConfig* clockConfig, int* textWidth, int* textHeight) {
-    if (mode == CCLOCK_CLOCK) {
-        if (clockConfig->style == CCLOCK_STYLE_HH_MM_SS) {
-            get_hh_mm_ss_text_size(font, clockConfig->clockScale, textWidth, textHeight);
+static void get_clock_text_size(const CClockEngine* engine, TTF_Font* font, const CClockConfig* clockConfig,
+    CClockLayoutCache* layout, int* textWidth, int* textHeight) {
+    const enum CClockMode mode = engine->mode;
+    const int style = mode == CCLOCK_CLOCK ? (int)clockConfig->style : -1;
+    CClockLayoutEntry* entry = NULL;
+    for (int i = 0; i < layout->count && !entry; ++i) {
+        if (layout->entries[i].mode == (int)mode && layout->entries[i].style == style) entry = &layout->entries[i];
+    }
+    if (!entry) {
+        if (layout->count == LAYOUT_CACHE_SIZE) layout->count = 0;
+        entry = &layout->entries[layout->count++];
+        entry->mode = mode;
+        entry->style = style;
+        if (mode == CCLOCK_CLOCK && clockConfig->style == CCLOCK_STYLE_ANALOG) {
+            entry->width = entry->height = ANALOG_DIAMETER;
         }
-        else if (clockConfig->style == CCLOCK_STYLE_HH_MM) {
-            get_hh_mm_text_size(font, clockConfig->clockScale, textWidth, textHeight);
+        else {
+            char placeholder[FORMAT_MAX_TEXT];
+            cclock_placeholder(engine, placeholder, sizeof(placeholder));
+            get_text_size(font, placeholder, 1.f, &entry->width, &entry->height);
         }
     }
-    else {
-        get_hh_mm_ss_text_size(font, clockConfig->clockScale, textWidth, textHeight);
-    }
-
+    *textWidth = (int)(entry->width * clockConfig->clockScale);
+    *textHeight = (int)(entry->height * clockConfig->clockScale);
 }
 
 static int exists(const char* fname) {
@@ -317,11 +329,29 @@ void write_ini(const char* iniFileName, const CClockConfig* conf) {
         fprintf(f, "y=%d\n", conf->winY);
         fprintf(f, "clockScale=%f\n", conf->clockScale);
         fprintf(f, "shadow=%d\n", conf->shadowEffect);
+        fprintf(f, "transition=%d\n", conf->transition);
+        if (conf->skin[0]) fprintf(f, "skin=%s\n", conf->skin);
+        if (conf->timeFormat[0]) fprintf(f, "timeFormat=%s\n", conf->timeFormat);
+        fprintf(f, "dateFormat=%s\n", conf->dateFormat);
+        for (int i = 0; i < conf->alarmCount; ++i) {
+            fprintf(f, "alarm=%s\n", conf->alarms[i]);
+        }
+        for (int i = 0; i < conf->zoneCount; ++i) {
+            fprintf(f, "zone=%s|%s\n", conf->zones[i].label, conf->zones[i].tz);
+        }
         fclose(f);
     }
 }
 
-#define MAX_LINE_LENGTH 100
+#define MAX_LINE_LENGTH 128
+
+// The line can be longer than the format buffer: checked like --time-format, the old format stays otherwise
+static void read_ini_format(char* value, char* out, const char* what) {
+    value[strcspn(value, "\r\n")] = '\0';
+    CClockFormat checkFormat;
+    if (strlen(value) < FORMAT_MAX_TEXT && format_compile(&checkFormat, value)) strcpy_s(out, FORMAT_MAX_TEXT, value);
+    else fprintf(stderr, "Invalid %s format '%s' in the ini file\n", what, value);
+}
 
 void read_ini(const char* iniFileName, CClockConfig* conf) {
     FILE* f = NULL;
@@ -330,99 +360,527 @@ void read_ini(const char* iniFileName, CClockConfig* conf) {
     if (f != NULL) {
         char line[MAX_LINE_LENGTH];
         while (fgets(line, sizeof(line), f)) {
-            if (strstr(line, "x=") != NULL) sscanf_s(line, "x=%d", &conf->winX);
+            // zone= first, the TZ part may contain anything
+            if (strncmp(line, "zone=", 5) == 0) {
+                if (conf->zoneCount < WORLD_CLOCK_MAX_ZONES && world_clock_parse_zone(line + 5, &conf->zones[conf->zoneCount])) {
+                    conf->zoneCount++;
+                }
+            }
+            else if (strncmp(line, "alarm=", 6) == 0) {
+                // Checked like --alarm, the line can be longer than a spec
+                char* spec = line + 6;
+                spec[strcspn(spec, "\r\n")] = '\0';
+                CClockAlarmRule rule;
+                char label[ALARM_LABEL_LENGTH];
+                if (strlen(spec) >= ALARM_SPEC_LENGTH || !alarm_parse_spec(spec, &rule, label, sizeof(label))) {
+                    fprintf(stderr, "Invalid alarm '%s' in the ini file\n", spec);
+                }
+                else if (conf->alarmCount < ALARM_MAX_SPECS) strcpy_s(conf->alarms[conf->alarmCount++], ALARM_SPEC_LENGTH, spec);
+            }
+            else if (strncmp(line, "skin=", 5) == 0) {
+                strcpy_s(conf->skin, sizeof(conf->skin), line + 5);
+                conf->skin[strcspn(conf->skin, "\r\n")] = '\0';
+            }
+            else if (strncmp(line, "timeFormat=", 11) == 0) read_ini_format(line + 11, conf->timeFormat, "time");
+            else if (strncmp(line, "dateFormat=", 11) == 0) read_ini_format(line + 11, conf->dateFormat, "date");
+            else if (strstr(line, "x=") != NULL) sscanf_s(line, "x=%d", &conf->winX);
             else if (strstr(line, "y=") != NULL)            sscanf_s(line, "y=%d", &conf->winY);
             else if (strstr(line, "clockScale=") != NULL)   sscanf_s(line, "clockScale=%f", &conf->clockScale);
             else if (strstr(line, "shadow=") != NULL)       sscanf_s(line, "shadow=%d", &conf->shadowEffect);
+            else if (strstr(line, "transition=") != NULL)   sscanf_s(line, "transition=%d", &conf->transition);
         }
 
         fclose(f);
     }
 }
 
-static ITaskbarList3* g_taskBar = NULL;
+static const char* get_time_format(const CClockConfig* config) {
+    if (config->timeFormat[0]) return config->timeFormat;
+    return config->style == CCLOCK_STYLE_HH_MM ? "%H:%M" : "%H:%M:%S";
+}
 
-static void taskbar_init(SDL_Window* window) {
-    HWND hwnd = get_hwnd(window);
-    HRESULT hr;
-    
-    hr = CoInitialize(NULL); //Needed to be able to use CoCreateInstance
-    if (!SUCCEEDED(hr)) {
-        fprintf(stderr, "Failed to initialize COM lib");
-        //MessageBox flags: https://learn.microsoft.com/fr-fr/windows/win32/api/winuser/nf-winuser-messagebox
-        MessageBox(hwnd, L"Failed to initialize COM lib", L"Error", MB_OK | MB_ICONERROR | MB_APPLMODAL);
-        exit(-1);
+// Parsed once here, the loop only runs the op lists. Broken formats from the ini fall back to the defaults
+static void compile_formats(CClockConfig* config, CClockEngine* engine) {
+    engine->style = config->style;
+    if (!format_compile(&engine->timeFormat, get_time_format(config))) {
+        config->timeFormat[0] = '\0';
+        format_compile(&engine->timeFormat, get_time_format(config));
+    }
+    if (!format_compile(&engine->dateFormat, config->dateFormat)) {
+        strcpy_s(config->dateFormat, sizeof(config->dateFormat), DATE_FORMAT_DEFAULT);
+        format_compile(&engine->dateFormat, config->dateFormat);
     }
+}
 
-    // We should always call CoInitialize before using any Co function: https://devblogs.microsoft.com/oldnewthing/20130419-00/?p=4613
-    hr = CoCreateInstance(&CLSID_TaskbarList, NULL,
-        CLSCTX_INPROC_SERVER,
-        &IID_ITaskbarList3,
-        (void**)&g_taskBar);
+// Alarm labels and finished countdowns in orange
+static SDL_Color get_text_color(const CClockText* text) {
+    return text->alert ? (SDL_Color){ 255, 87, 51, 255 } : (SDL_Color){ 245, 245, 245, 255 };
+}
 
-    if (SUCCEEDED(hr)) {
-        g_taskBar->lpVtbl->HrInit(g_taskBar);
+const char* iniFileName = "CClock.ini";
+
+static void parse_args(int argc, char** argv, CClockOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--fixed-fps") == 0) {
+            options->fixedFps = true;
+        }
+        else if (strcmp(argv[i], "--profile-idle") == 0 && i + 1 < argc) {
+            options->profileSeconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--idle-budget") == 0 && i + 1 < argc) {
+            options->idleBudget = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--software-compositor") == 0) {
+            options->softwareCompositor = true;
+        }
+        else if (strcmp(argv[i], "--render-threads") == 0 && i + 1 < argc) {
+            options->renderThreads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            options->exportOptions.path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--export-fps") == 0 && i + 1 < argc) {
+            options->exportOptions.fps = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--export-size") == 0 && i + 1 < argc) {
+            if (sscanf_s(argv[++i], "%dx%d", &options->exportOptions.width, &options->exportOptions.height) != 2) {
+                fprintf(stderr, "Invalid export size '%s', expected WxH\n", argv[i]);
+            }
+        }
+        else if (strcmp(argv[i], "--export-frames") == 0 && i + 1 < argc) {
+            options->exportOptions.frames = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--alarm") == 0 && i + 1 < argc) {
+            ++i;
+            if (options->addAlarmCount < ALARM_MAX_SPECS) options->addAlarms[options->addAlarmCount++] = argv[i];
+        }
+        else if (strcmp(argv[i], "--skin") == 0 && i + 1 < argc) {
+            options->forceSkin = argv[++i];
+        }
+        else if (strcmp(argv[i], "--time-format") == 0 && i + 1 < argc) {
+            options->forceTimeFormat = argv[++i];
+        }
+        else if (strcmp(argv[i], "--date-format") == 0 && i + 1 < argc) {
+            options->forceDateFormat = argv[++i];
+        }
+        else if (strcmp(argv[i], "--time-source") == 0 && i + 1 < argc) {
+            options->timeSource = argv[++i];
+        }
+        else if (strcmp(argv[i], "--simulate") == 0 && i + 2 < argc) {
+            options->simulateStart = argv[++i];
+            options->simulateDuration = argv[++i];
+        }
+        else if (strcmp(argv[i], "--simulate-chrono") == 0 && i + 1 < argc) {
+            options->simulateChrono = argv[++i];
+        }
+        else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            options->soakDays = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options->recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options->replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay-fast") == 0) {
+            options->replayFast = true;
+        }
+        else if (strcmp(argv[i], "--platform") == 0 && i + 1 < argc) {
+            options->platform = argv[++i];
+        }
+        else if (strcmp(argv[i], "--term") == 0) {
+            options->term = true;
+        }
+        else if (strcmp(argv[i], "--term-ascii") == 0) {
+            options->term = true;
+            options->termOptions.ascii = true;
+        }
+        else if (strcmp(argv[i], "--term-chrono") == 0 && i + 1 < argc) {
+            options->term = true;
+            options->termChrono = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stream") == 0) {
+            options->stream = true;
+        }
+        else if (strcmp(argv[i], "--stream-json") == 0) {
+            options->stream = true;
+            options->streamOptions.json = true;
+        }
+        else if (strcmp(argv[i], "--stream-chrono") == 0 && i + 1 < argc) {
+            options->stream = true;
+            options->streamChrono = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stream-count") == 0 && i + 1 < argc) {
+            options->stream = true;
+            options->streamOptions.count = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--control") == 0) {
+            options->control = true;
+        }
+        else if (strcmp(argv[i], "--control-name") == 0 && i + 1 < argc) {
+            options->controlName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--ctl") == 0 && i + 1 < argc) {
+            ++i;
+            if (options->ctlCount < CONTROL_MAX_BATCH) options->ctlCommands[options->ctlCount++] = argv[i];
+        }
+        else if (strcmp(argv[i], "--shm-read") == 0 && i + 1 < argc) {
+            options->shmRead = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            // Everything after --bench belongs to the benchmark
+            options->benchArgc = argc - (i + 1);
+            options->benchArgv = argv + i + 1;
+            return;
+        }
+        else if (strcmp(argv[i], "--style") == 0 && i + 1 < argc) {
+            ++i;
+            if (strcmp(argv[i], "hh:mm") == 0)          options->forceStyle = CCLOCK_STYLE_HH_MM;
+            else if (strcmp(argv[i], "hh:mm:ss") == 0)  options->forceStyle = CCLOCK_STYLE_HH_MM_SS;
+            else if (strcmp(argv[i], "analog") == 0)    options->forceStyle = CCLOCK_STYLE_ANALOG;
+            else fprintf(stderr, "Unknown style '%s'\n", argv[i]);
+        }
+        else if (strcmp(argv[i], "--transition") == 0 && i + 1 < argc) {
+            const CClockTransitionStyle transition = transition_style_from_name(argv[++i]);
+            if (transition != CCLOCK_TRANSITION_COUNT) options->forceTransition = transition;
+            else fprintf(stderr, "Unknown transition '%s'\n", argv[i]);
+        }
+        else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!log_parse_level(argv[++i], &options->logLevel)) fprintf(stderr, "Unknown log level '%s'\n", argv[i]);
+        }
+        else {
+            fprintf(stderr, "Unknown argument '%s'\n", argv[i]);
+        }
     }
 }
 
-static void taskbar_set_progress(SDL_Window* window, uint64_t completed, uint64_t total) {
-    HWND hwnd = get_hwnd(window);
-    if (!g_taskBar) return;
-    enum TBPFLAG flag = TBPF_NORMAL;
-    g_taskBar->lpVtbl->SetProgressState(g_taskBar, hwnd, flag);
-    g_taskBar->lpVtbl->SetProgressValue(g_taskBar, hwnd, completed, total);
-}
+// Context menu commands coming from elsewhere than the menu, event.user.code is the HMENU id
+static Uint32 g_commandEvent = (Uint32)-1;
 
-static void taskbar_stop_progress(SDL_Window* window) {
-    HWND hwnd = get_hwnd(window);
-    if (!g_taskBar) return;
-    g_taskBar->lpVtbl->SetProgressState(g_taskBar, hwnd, TBPF_NOPROGRESS);
+static void push_command(int commandId) {
+    SDL_Event event = { .type = g_commandEvent };
+    event.user.code = commandId;
+    SDL_PushEvent(&event);
 }
 
-static void taskbar_flash_done(SDL_Window* window) {
-    FLASHWINFO fi;
-    fi.cbSize = sizeof(FLASHWINFO);
-    fi.hwnd = get_hwnd(window);
-    fi.dwFlags = FLASHW_ALL | FLASHW_TIMERNOFG;
-    fi.uCount = 0;
-    fi.dwTimeout = 0;
-    FlashWindowEx(&fi);
+// --soak script, one action per simulated hour: a menu command, wheel notches or a render reset
+typedef struct {
+    int command;
+    int wheel;
+    Uint32 event;
+} CClockSoakAction;
+
+static const CClockSoakAction g_soakScript[] = {
+    { HMENU_CLOCK_MODE_HH_MM_SS_ID, 0, 0 },
+    { HMENU_CLOCK_MODE_HH_MM_ID, 0, 0 },
+    { 0, 5, 0 },                            // up to the largest scale
+    { HMENU_CLOCK_MODE_ANALOG_ID, 0, 0 },
+    { 0, -10, 0 },                          // down to the smallest
+    { HMENU_WORLD_CLOCK_ID, 0, 0 },
+    { HMENU_CHRONO_MODE_10s_ID, 0, 0 },     // completes on the next frame
+    { HMENU_SHADOW_ID, 0, 0 },
+    { HMENU_CLOCK_MODE_HH_MM_SS_ID, 0, 0 },
+    { 0, 5, 0 },
+    { HMENU_SHADOW_ID, 0, 0 },
+    { HMENU_CHRONO_MODE_30M_ID, 0, 0 },
+    { 0, 0, SDL_RENDER_TARGETS_RESET },
+    { HMENU_CLOCK_MODE_ANALOG_ID, 0, 0 },
+    { 0, 0, SDL_RENDER_DEVICE_RESET },
+    { HMENU_SKIN_DEFAULT_ID, 0, 0 },        // atlas rebuilt
+    { HMENU_CLOCK_MODE_HH_MM_ID, 0, 0 },
+    { 0, -5, 0 },
+};
+
+static void soak_push_action(const CClockSoakAction* action) {
+    if (action->command) push_command(action->command);
+    for (int i = 0; i < abs(action->wheel); ++i) {
+        SDL_Event event = { .type = SDL_MOUSEWHEEL };
+        event.wheel.y = action->wheel > 0 ? 1 : -1;
+        event.wheel.preciseY = (float)event.wheel.y;
+        SDL_PushEvent(&event);
+    }
+    if (action->event) {
+        SDL_Event event = { .type = action->event };
+        SDL_PushEvent(&event);
+    }
 }
 
-static void taskbar_deinit() {
-    if (g_taskBar) {
-        g_taskBar->lpVtbl->Release(g_taskBar);
-        g_taskBar = NULL;
+// Rasterized glyph bytes the caches hold, the texture and surface counts come from soak_track.h
+static void soak_sample_caches(CClockSoakSample* sample, const CClockGlyphAtlas* atlas, const CClockTextCache* textCache,
+    const CClockAnalogFace* analogFace, const CClockCompositor* compositor) {
+    sample->glyphCacheBytes = (size_t)atlas->width * (atlas->height + atlas->shadowHeight) * 4 + textCache->pool.residentBytes
+        + analogFace->numerals.pool.residentBytes;
+    for (int f = 0; f < COMPOSITOR_MAX_FACES; ++f) {
+        for (int ch = 0; ch < COMPOSITOR_CHAR_COUNT; ++ch) {
+            sample->glyphCacheBytes += (size_t)compositor->faces[f].glyphs[ch].w * compositor->faces[f].glyphs[ch].h;
+        }
     }
-    CoUninitialize();
 }
 
+// Input that can change what or how the clock renders, the commands already resolved from the menu
+static void record_event(CClockReplay* recording, uint32_t ms, const SDL_Event* e, int commandId) {
+    if (commandId != 0) {
+        replay_record(recording, ms, CCLOCK_REPLAY_COMMAND, commandId, 0, 0);
+    }
+    else if (e->type == SDL_MOUSEWHEEL) {
+        replay_record(recording, ms, CCLOCK_REPLAY_WHEEL, 0, (int)(e->wheel.preciseY * 1000.f), e->wheel.y);
+    }
+    else if (e->type == SDL_MOUSEMOTION) {
+        replay_record(recording, ms, CCLOCK_REPLAY_MOUSE_MOTION, 0, e->motion.x, e->motion.y);
+    }
+    else if (e->type == SDL_MOUSEBUTTONDOWN || e->type == SDL_MOUSEBUTTONUP) {
+        replay_record(recording, ms, e->type == SDL_MOUSEBUTTONDOWN ? CCLOCK_REPLAY_MOUSE_DOWN : CCLOCK_REPLAY_MOUSE_UP,
+            e->button.button, e->button.x, e->button.y);
+    }
+    else if (e->type == SDL_WINDOWEVENT && e->window.event == SDL_WINDOWEVENT_MOVED) {
+        replay_record(recording, ms, CCLOCK_REPLAY_WINDOW_MOVED, 0, e->window.data1, e->window.data2);
+    }
+    else if (e->type == SDL_WINDOWEVENT && e->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        replay_record(recording, ms, CCLOCK_REPLAY_WINDOW_RESIZED, 0, e->window.data1, e->window.data2);
+    }
+    else if (e->type == SDL_KEYDOWN) {
+        replay_record(recording, ms, CCLOCK_REPLAY_KEY, 0, e->key.keysym.sym, 0);
+    }
+}
 
-const char* dayName[] = { "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday" };
+// Window moves and sizes are applied to the window so SDL sends the same events back
+static void replay_event(SDL_Window* window, const CClockReplayEvent* event) {
+    SDL_Event e = { 0 };
+    switch (event->kind) {
+    case CCLOCK_REPLAY_WHEEL:
+        e.type = SDL_MOUSEWHEEL;
+        e.wheel.y = event->y;
+        e.wheel.preciseY = event->x / 1000.f;
+        break;
+    case CCLOCK_REPLAY_MOUSE_MOTION:
+        e.type = SDL_MOUSEMOTION;
+        e.motion.x = event->x;
+        e.motion.y = event->y;
+        break;
+    case CCLOCK_REPLAY_MOUSE_DOWN:
+    case CCLOCK_REPLAY_MOUSE_UP:
+        // The context menu would block, the item picked in it follows as a command
+        if (event->kind == CCLOCK_REPLAY_MOUSE_DOWN && event->code == SDL_BUTTON_RIGHT) return;
+        e.type = event->kind == CCLOCK_REPLAY_MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        e.button.button = (Uint8)event->code;
+        e.button.state = event->kind == CCLOCK_REPLAY_MOUSE_DOWN ? SDL_PRESSED : SDL_RELEASED;
+        e.button.x = event->x;
+        e.button.y = event->y;
+        break;
+    case CCLOCK_REPLAY_WINDOW_MOVED:
+        SDL_SetWindowPosition(window, event->x, event->y);
+        return;
+    case CCLOCK_REPLAY_WINDOW_RESIZED:
+        SDL_SetWindowSize(window, event->x, event->y);
+        return;
+    case CCLOCK_REPLAY_COMMAND:
+        push_command(event->code);
+        return;
+    case CCLOCK_REPLAY_KEY:
+        e.type = SDL_KEYDOWN;
+        e.key.keysym.sym = event->x;
+        break;
+    default:
+        return;
+    }
+    SDL_PushEvent(&e);
+}
 
-const char* monthName[] = { "January", "February", "March", "April", "May", "June", "July",
-                 "August", "September", "October", "November", "December" };
+// --simulate: no window, a fixed time source jumps from one tick to the next exactly like the event loop
+// would wake up, so days of clock time (DST changes, month ends, long countdowns) run in a moment.
+// One line per tick with what the window would show
+static int simulate_run(const CClockOptions* options, const CClockConfig* config, const CClockEngine* clockEngine) {
+    time_t start;
+    long duration, chronoSeconds = 0;
+    if (!time_source_parse_datetime(options->simulateStart, &start) || !time_source_parse_duration(options->simulateDuration, &duration)
+        || (options->simulateChrono && !time_source_parse_duration(options->simulateChrono, &chronoSeconds))) {
+        fprintf(stderr, "Invalid simulation, expected --simulate <YYYY-MM-DD[THH:MM[:SS]]> <duration> [--simulate-chrono <duration>]\n");
+        return 1;
+    }
+    g_clockTime = (CClockTimeSource){ .kind = CCLOCK_TIME_FIXED, .originNs = (int64_t)start * 1000000000 };
+
+    CClockEngine engine = *clockEngine;
+    CClockSnapshot snapshot;
+    cclock_snapshot(&engine, &snapshot);
+    if (chronoSeconds > 0) cclock_chrono_start(&engine, &snapshot, chronoSeconds);
+
+    CClockAlarms alarms = { 0 };
+    for (int i = 0; i < config->alarmCount; ++i) {
+        CClockAlarmRule rule;
+        char label[ALARM_LABEL_LENGTH];
+        if (alarm_parse_spec(config->alarms[i], &rule, label, sizeof(label))) alarms_add(&alarms, &rule, label, start);
+    }
+    char alarmText[ALARM_LABEL_LENGTH + 8] = "";
+    time_t alarmShownUntil = 0;
+
+    unsigned long ticks = 0, unchanged = 0, fired = 0;
+    CClockText last = { 0 };
+    const Uint64 realStart = SDL_GetPerformanceCounter();
+    for (time_t now = start; now <= start + duration; now = time_source_now(&g_clockTime)) {
+        int firedAlarms[4];
+        const int firedCount = alarms_fire_due(&alarms, now, firedAlarms, 4);
+        if (firedCount > 0) {
+            const CClockAlarm* alarm = &alarms.alarms[firedAlarms[0]];
+            sprintf_s(alarmText, sizeof(alarmText), "%s%s", alarm->label[0] ? alarm->label : "Alarm", firedCount > 1 ? " (+)" : "");
+            alarmShownUntil = now + ALARM_SHOW_SECONDS;
+            fired += firedCount;
+        }
 
-const char* iniFileName = "CClock.ini";
+        cclock_snapshot(&engine, &snapshot);
+        CClockText text;
+        cclock_build_text(&engine, &snapshot, now < alarmShownUntil ? alarmText : NULL, &text);
+        const bool changed = strcmp(text.timeStr, last.timeStr) != 0 || strcmp(text.dateStr, last.dateStr) != 0;
+        char stamp[64];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S %Z", &snapshot.local);
+        printf("%s  %s | %s%s\n", stamp, text.timeStr, text.dateStr, changed ? "" : "  (unchanged)");
+        ticks++;
+        if (!changed) unchanged++;
+        last = text;
+
+        // Next wakeup as the event loop computes it, without the slack real sleeps need
+        int64_t wallMs = cclock_wall_ms_until_next_tick(&engine, &snapshot);
+        if (alarms_next(&alarms) != ALARM_NEVER && (alarms_next(&alarms) - now) * 1000 < wallMs) wallMs = (alarms_next(&alarms) - now) * 1000;
+        if (alarmShownUntil > now && (alarmShownUntil - now) * 1000 < wallMs) wallMs = (alarmShownUntil - now) * 1000;
+        time_source_set(&g_clockTime, time_source_now_ns(&g_clockTime) + (wallMs > 0 ? wallMs : 1000) * 1000000);
+    }
+    const double realMs = (double)(SDL_GetPerformanceCounter() - realStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    fprintf(stderr, "simulated %.1f hours in %.0f ms: %lu ticks, %lu without a visible change, %lu alarms fired\n",
+        duration / 3600.0, realMs, ticks, unchanged, fired);
+    alarms_destroy(&alarms);
+    return 0;
+}
 
 int main(int argc, char** argv) {
 
+    CClockOptions options = {
+        .fixedFps = false,
+        .profileSeconds = 0.0,
+        .idleBudget = 0.0,
+        .forceStyle = -1,
+        .forceTransition = -1,
+        .logLevel = LOG_LEVEL_INFO,
+        .exportOptions = { .fps = 30.0, .width = WINDOW_WIDTH, .height = WINDOW_HEIGHT },
+    };
+    parse_args(argc, argv, &options);
+    if (options.benchArgc > 0) {
+        return bench_run(options.benchArgc, options.benchArgv);
+    }
+    const char* const controlName = options.controlName ? options.controlName : CONTROL_NAME_DEFAULT;
+    if (options.ctlCount > 0) {
+        const int failed = control_send(controlName, options.ctlCommands, options.ctlCount, stdout);
+        if (failed < 0) {
+            char path[260];
+            control_path(controlName, path, sizeof(path));
+            fprintf(stderr, "No clock listening on %s, start one with --control\n", path);
+        }
+        return failed < 0 ? 1 : failed > 0 ? 2 : 0;
+    }
+    if (options.timeSource) time_source_parse(&g_clockTime, options.timeSource);
+    // The soak steps the clock itself, frame after frame
+    if (options.soakDays > 0) g_clockTime = (CClockTimeSource){ .kind = CCLOCK_TIME_FIXED, .originNs = time_source_now_ns(&g_clockTime) };
+    CClockReplay replay = { 0 };
+    if (options.replayPath) {
+        if (!replay_load(&replay, options.replayPath)) return 1;
+        // The clock starts where the recording did, at real speed or stepped from event to event
+        g_clockTime = (CClockTimeSource){
+            .kind = options.replayFast ? CCLOCK_TIME_FIXED : CCLOCK_TIME_ACCELERATED,
+            .originNs = replay.header.startWallNs,
+            .speed = 1,
+        };
+    }
+    // Nobody looks at a soak or a replay, the window stays hidden and renders anyway
+    const bool headless = options.soakDays > 0 || options.replayPath;
+    if (options.shmRead) {
+        return shm_ring_latency_run(options.shmRead, options.exportOptions.frames);
+    }
+
     CClockConfig config = {
         .winX = SDL_WINDOWPOS_CENTERED,
         .winY = SDL_WINDOWPOS_CENTERED,
         .clockScale = 1.f,
         .shadowEffect = true,
         .style = CCLOCK_STYLE_HH_MM,
+        .dateFormat = DATE_FORMAT_DEFAULT,
     };
     //before creating the window we check if the .ini file exist and or create it
     if (exists(iniFileName)) read_ini(iniFileName, &config);
     else                     write_ini(iniFileName, &config);
-    
+    if (options.forceStyle >= 0) config.style = (CClockStyle)options.forceStyle;
+    if (options.forceTransition >= 0) config.transition = options.forceTransition;
+    if (config.transition < 0 || config.transition >= CCLOCK_TRANSITION_COUNT) config.transition = CCLOCK_TRANSITION_NONE;
+    if (config.zoneCount == 0) config.zoneCount = world_clock_default_zones(config.zones, WORLD_CLOCK_MAX_ZONES);
+    for (int i = 0; i < options.addAlarmCount && config.alarmCount < ALARM_MAX_SPECS; ++i) {
+        CClockAlarmRule rule;
+        char label[ALARM_LABEL_LENGTH];
+        if (strlen(options.addAlarms[i]) < ALARM_SPEC_LENGTH && alarm_parse_spec(options.addAlarms[i], &rule, label, sizeof(label))) {
+            strcpy_s(config.alarms[config.alarmCount++], ALARM_SPEC_LENGTH, options.addAlarms[i]);
+        }
+        else fprintf(stderr, "Invalid alarm '%s'\n", options.addAlarms[i]);
+    }
+    CClockFormat checkFormat;
+    if (options.forceTimeFormat && strlen(options.forceTimeFormat) < FORMAT_MAX_TEXT && format_compile(&checkFormat, options.forceTimeFormat)) {
+        strcpy_s(config.timeFormat, sizeof(config.timeFormat), options.forceTimeFormat);
+    }
+    else if (options.forceTimeFormat) fprintf(stderr, "Invalid time format '%s'\n", options.forceTimeFormat);
+    if (options.forceDateFormat && strlen(options.forceDateFormat) < FORMAT_MAX_TEXT && format_compile(&checkFormat, options.forceDateFormat)) {
+        strcpy_s(config.dateFormat, sizeof(config.dateFormat), options.forceDateFormat);
+    }
+    else if (options.forceDateFormat) fprintf(stderr, "Invalid date format '%s'\n", options.forceDateFormat);
+    CClockEngine engine;
+    cclock_engine_init(&engine, &g_clockTime);
+    compile_formats(&config, &engine);
+    if (options.simulateStart) {
+        return simulate_run(&options, &config, &engine);
+    }
+    if (options.stream) {
+        if (options.streamChrono && !time_source_parse_duration(options.streamChrono, &options.streamOptions.chronoSeconds)) {
+            fprintf(stderr, "Invalid countdown '%s', expected a duration like 90m or 2h\n", options.streamChrono);
+            return 1;
+        }
+        CClockAlarms alarms = { 0 };
+        for (int i = 0; i < config.alarmCount; ++i) {
+            CClockAlarmRule rule;
+            char label[ALARM_LABEL_LENGTH];
+            if (alarm_parse_spec(config.alarms[i], &rule, label, sizeof(label))) alarms_add(&alarms, &rule, label, time_source_now(&g_clockTime));
+        }
+        CClockStreamStats stats;
+        const int exitCode = stream_run(&engine, &alarms, &options.streamOptions, stdout, &stats);
+        fprintf(stderr, "stream: %lu ticks, %lu alarms, first line after %.2f ms, wakeups %.0f us late on average, %.0f us at most\n",
+            stats.ticks, stats.alarms, stats.startupUs / 1000.0, stats.meanLateUs, stats.maxLateUs);
+        alarms_destroy(&alarms);
+        return exitCode;
+    }
+    if (options.term) {
+        if (options.termChrono && !time_source_parse_duration(options.termChrono, &options.termOptions.chronoSeconds)) {
+            fprintf(stderr, "Invalid countdown '%s', expected a duration like 90m or 2h\n", options.termChrono);
+            return 1;
+        }
+        return term_run(&engine, &options.termOptions);
+    }
+    if (options.forceSkin) strcpy_s(config.skin, sizeof(config.skin), strcmp(options.forceSkin, "none") == 0 ? "" : options.forceSkin);
+
+    if (options.exportOptions.path) {
+        if (options.exportOptions.fps <= 0 || options.exportOptions.width <= 0 || options.exportOptions.height <= 0) {
+            fprintf(stderr, "Invalid export rate or size\n");
+            return 1;
+        }
+        options.exportOptions.timeFormat = &engine.timeFormat;
+        options.exportOptions.dateFormat = &engine.dateFormat;
+        options.exportOptions.timeSource = &g_clockTime;
+        options.exportOptions.shadowEffect = config.shadowEffect;
+        options.exportOptions.skin = config.skin[0] ? config.skin : NULL;
+        return export_run(&options.exportOptions);
+    }
+
+
+    // Hit tests run on every mouse move: the window loop never writes to the console itself
+    log_start(stderr, options.logLevel);
 
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
         fprintf(stderr, "SDL failed to initialise: %s\n", SDL_GetError());
         return 1;
     }
+    g_commandEvent = SDL_RegisterEvents(1);
 
     /* Creates a SDL window */
     SDL_Window* window = SDL_CreateWindow("CClock", /* Title of the SDL window */
@@ -430,7 +888,7 @@ int main(int argc, char** argv) {
         config.winY, /* Position y of the window */
         WINDOW_WIDTH, /* Width of the window in pixels */
         WINDOW_HEIGHT, /* Height of the window in pixels */
-        SDL_WINDOW_RESIZABLE | SDL_WINDOW_BORDERLESS); /* Additional flag(s) */
+        SDL_WINDOW_RESIZABLE | SDL_WINDOW_BORDERLESS | (headless ? SDL_WINDOW_HIDDEN : 0)); /* Additional flag(s) */
 
     if (!window) {
         printf("SDL window failed to initialise: %s\n", SDL_GetError());
@@ -441,21 +899,31 @@ int main(int argc, char** argv) {
         printf("Error with SDL_SetWindowHitTest: %s", SDL_GetError());
     }
 
+    // Scripts start countdowns and switch modes through the event loop, see control.h
+    CClockControl control = { 0 };
+    const bool controlRunning = options.control && control_start(&control, controlName, SDL_RegisterEvents(1));
+    bool controlPending = false;
+
     bool isRunning = true;
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+    // No GPU driver at all (headless soak, some VMs): the software renderer, drawn by the compositor
+    if (!renderer) renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
 
     if (!renderer) {
         printf("SDL renderer failed to initialise: %s\n", SDL_GetError());
         return 1;
     }
 
+    // Native window services, headless when nothing is on screen
+    const CClockPlatform* platform = platform_attach(window, options.platform ? options.platform : headless ? "headless" : NULL);
+
     // Add window transparency (Black will be see-through)
-    MakeWindowTransparent(window, RGB(0, 0, 0));
+    const bool colorKeyed = platform->set_color_key((SDL_Color) { 0, 0, 0, 255 });
 
 #ifdef FEATURE_HOTKEY_SUPPORT
 #define HOTKEY_LCTRLT 1
-    if (RegisterHotKey(get_hwnd(window), HOTKEY_LCTRLT, MOD_CONTROL | MOD_NOREPEAT, (UINT)'T') < 0) {
-        exit(-1);
+    if (!platform->register_hotkey(HOTKEY_LCTRLT, 'T')) {
+        fprintf(stderr, "Could not register the Ctrl+T hotkey\n");
     }
 #endif
 
@@ -474,229 +942,617 @@ int main(int argc, char** argv) {
         return 1;
     }
     
-    enum CClockMode mode = CCLOCK_CLOCK;
-    struct tm chronoTargetTm = get_tm();
-    struct tm startTimeTm = get_tm();
 
 
+    // The skin only replaces the digits, fonts stay loaded for the date, the analog face and the fallbacks
+    CClockSkin skin = { 0 };
+    if (config.skin[0] && skin_load(&skin, config.skin)) g_skin = &skin;
+    char skinNames[SKIN_MAX_LISTED][64];
+    const int skinCount = skin_list(SKIN_ROOT, skinNames, SKIN_MAX_LISTED);
+
     int textWidth = 0, textHeight = 0;
-    
-    get_clock_text_size(mode, font256, &config, &textWidth, &textHeight);
+    CClockLayoutCache layout = { 0 };
+    get_clock_text_size(&engine, font256, &config, &layout, &textWidth, &textHeight);
     SDL_Rect ttfDestRect = get_clock_position(window, textWidth, textHeight);
 
+    // Wheel notches of one wakeup are summed, the scale then eases toward zoomTarget at display rate
+    float wheelNotches = 0.f;
+    float zoomTarget = config.clockScale;
+    uint64_t zoomLastMs = 0;
+
+    CClockAnalogFace analogFace = { 0 };
+
+    // ACCELERATED silently falls back to the software renderer (VDI, no driver), text is then
+    // blended in one framebuffer instead of a surface + texture per string
+    CClockCompositor compositor = { 0 };
+    CClockWorkerPool renderPool = { 0 };
+    if (options.softwareCompositor || compositor_renderer_is_software(renderer)) {
+        int outW, outH;
+        SDL_GetRendererOutputSize(renderer, &outW, &outH);
+        CClockWorkerPool* pool = worker_pool_init(&renderPool, options.renderThreads) ? &renderPool : NULL;
+        if (compositor_init(&compositor, renderer, outW, outH, pool)) {
+            printf("Software compositor: %s blend kernel, %d threads\n", blend_span_name(compositor.blendSpan), pool ? pool->threadCount : 1);
+        }
+    }
+
+    // Glyphs of the digital and world clocks with their blurred shadows, built on first use
+    CClockGlyphAtlas textAtlas = { 0 };
+    CClockGlyphBatch textBatch = { 0 };
+    CClockGlyphBatch shadowBatch = { 0 };
+    bool textAtlasFailed = false;
+    // Fallback when the atlas cannot be built, reuses pooled streaming textures
+    CClockTextCache textCache = { 0 };
+    CClockTransitions transitions = { .style = (CClockTransitionStyle)config.transition };
+    CClockWorldClock worldClock;
+    world_clock_init(&worldClock, config.zones, config.zoneCount);
+    u32 displayFrameMs = get_display_frame_ms(window);
+
+    // Compiled once, the loop only looks at the earliest fire time
+    CClockAlarms alarms = { 0 };
+    for (int i = 0; i < config.alarmCount; ++i) {
+        CClockAlarmRule rule;
+        char label[ALARM_LABEL_LENGTH];
+        if (alarm_parse_spec(config.alarms[i], &rule, label, sizeof(label))) alarms_add(&alarms, &rule, label, time_source_now(&g_clockTime));
+        else fprintf(stderr, "Ignoring invalid alarm '%s'\n", config.alarms[i]);
+    }
+    time_t lastAlarmCheck = time_source_now(&g_clockTime);
+    char alarmText[ALARM_LABEL_LENGTH + 8] = "";
+    time_t alarmShownUntil = 0;
+
+
+    CClockProfile profile;
+    profile_begin(&profile);
+
+    // Only present when the text changed or something invalidated the window
+    bool needsRedraw = true;
+    char lastTitle[FORMAT_MAX_TEXT + 32] = "";
+    char lastTimeStr[80] = "";
+    char lastDateStr[80] = "";
+    SDL_Color lastColor = { 0 };
+
+    // Rendering is suspended while the window cannot be seen, the time engine keeps running
+    bool windowHidden = false;
+    bool displayOff = false;
+
+    // --soak: the first pass of the script is the baseline
+    CClockSoak soak = {
+        .days = options.soakDays,
+        .cycleHours = (double)(sizeof(g_soakScript) / sizeof(g_soakScript[0])),
+        .rssToleranceBytes = (size_t)SOAK_RSS_TOLERANCE_MB * 1024 * 1024,
+        .handleTolerance = SOAK_HANDLE_TOLERANCE,
+        .allocationTolerance = SOAK_ALLOCATION_TOLERANCE,
+    };
+    const int64_t soakStartNs = time_source_now_ns(&g_clockTime);
+    long soakHours = 0;
+    long soakNextSample = SOAK_SAMPLE_HOURS;
+
+    CClockReplay recording = { 0 };
+    if (options.recordPath) replay_record_open(&recording, options.recordPath, time_source_now_ns(&g_clockTime));
+    CClockFrameStats frameStats = { 0 };
+    uint32_t replayMs = 0;
+    if (replay.events) time_source_start(&g_clockTime);
+    const uint64_t loopStartTicks = SDL_GetTicks64();
 
-    taskbar_init(window);
-    
-    SDL_EventState(SDL_SYSWMEVENT, SDL_ENABLE);
     while (isRunning) {
+        if (replay.events) {
+            if (options.replayFast) {
+                // Straight to the next event, a second at most so every tick in between still renders
+                const uint32_t nextMs = replay_next_ms(&replay);
+                replayMs = nextMs > replayMs + 1000 ? replayMs + 1000 : nextMs > replayMs ? nextMs : replayMs;
+                time_source_set(&g_clockTime, replay.header.startWallNs + (int64_t)replayMs * 1000000);
+            }
+            else {
+                replayMs = (uint32_t)(SDL_GetTicks64() - loopStartTicks);
+            }
+            for (const CClockReplayEvent* event = replay_next_due(&replay, replayMs); event; event = replay_next_due(&replay, replayMs)) {
+                replay_event(window, event);
+            }
+        }
 
         SDL_Event e;
-        while (SDL_PollEvent(&e)) {
+        int hasEvent;
+        if (options.soakDays > 0) {
+            // No waiting: every frame is SOAK_FRAME_SECONDS later, every hour the next script action
+            time_source_set(&g_clockTime, time_source_now_ns(&g_clockTime) + SOAK_FRAME_SECONDS * 1000000000LL);
+            const long hours = (long)((time_source_now_ns(&g_clockTime) - soakStartNs) / 3600000000000LL);
+            for (; soakHours < hours; ++soakHours) {
+                soak_push_action(&g_soakScript[soakHours % (long)(sizeof(g_soakScript) / sizeof(g_soakScript[0]))]);
+            }
+            needsRedraw = true;
+            hasEvent = SDL_PollEvent(&e);
+        }
+        else if (options.fixedFps || (replay.events && options.replayFast)) {
+            hasEvent = SDL_PollEvent(&e);
+        }
+        else {
+            // Display rate only while the second hand sweeps or a digit transition runs, and only when
+            // the frames are seen: a hidden window or a display that is off waits for the next tick
+            const bool isShown = (!windowHidden && !displayOff) || headless;
+            const bool isSweeping = isShown && ((engine.mode == CCLOCK_CLOCK && config.style == CCLOCK_STYLE_ANALOG) || transitions_running(&transitions)
+                || config.clockScale != zoomTarget);
+            u32 timeoutMs = isSweeping ? displayFrameMs : get_ms_until_next_tick(&engine, TICK_MAX_WAIT_MS);
+            if (alarms_next(&alarms) != ALARM_NEVER) timeoutMs = get_ms_until(alarms_next(&alarms), timeoutMs);
+            // A date format without the day changing would keep the alarm label until midnight
+            if (alarmShownUntil > time_source_now(&g_clockTime)) timeoutMs = get_ms_until(alarmShownUntil, timeoutMs);
+            if (replay.events && !replay_finished(&replay)) {
+                const int64_t untilEvent = (int64_t)(loopStartTicks + replay_next_ms(&replay)) - (int64_t)SDL_GetTicks64();
+                if (untilEvent < (int64_t)timeoutMs) timeoutMs = untilEvent > 0 ? (u32)untilEvent : 0;
+            }
+            if (options.profileSeconds > 0) {
+                const double remainingMs = (options.profileSeconds - profile_elapsed_seconds(&profile)) * 1000.0;
+                if (remainingMs < timeoutMs) timeoutMs = remainingMs > 0 ? (u32)remainingMs : 0;
+            }
+            // Sleep until the next visible change or until something happens
+            hasEvent = SDL_WaitEventTimeout(&e, (int)timeoutMs);
+        }
+        profile.wakeups++;
+
+        while (hasEvent) {
+            int commandId = 0;
             if (e.type == SDL_KEYDOWN) {
                 if (e.key.keysym.sym == SDLK_ESCAPE) {
                     isRunning = false;
                 }
             }
             else if (e.type == SDL_WINDOWEVENT) {
-                if (e.window.event == SDL_WINDOWEVENT_MOVED) {
+                switch (e.window.event) {
+                case SDL_WINDOWEVENT_MOVED:
                     config.winX = e.window.data1;
                     config.winY = e.window.data2;
+                    displayFrameMs = get_display_frame_ms(window);
+                    break;
+                case SDL_WINDOWEVENT_SIZE_CHANGED:
+                    if (compositor.pixels) {
+                        int outW, outH;
+                        SDL_GetRendererOutputSize(renderer, &outW, &outH);
+                        compositor_resize(&compositor, renderer, outW, outH);
+                    }
+                    break;
+                case SDL_WINDOWEVENT_HIDDEN:
+                case SDL_WINDOWEVENT_MINIMIZED:
+                    windowHidden = true;
+                    break;
+                case SDL_WINDOWEVENT_SHOWN:
+                case SDL_WINDOWEVENT_EXPOSED:
+                case SDL_WINDOWEVENT_RESTORED:
+                case SDL_WINDOWEVENT_MAXIMIZED:
+                    windowHidden = false;
+                    break;
                 }
+                needsRedraw = true;
             }
             else if (e.type == SDL_MOUSEBUTTONDOWN) {
                 if (e.button.button == SDL_BUTTON_RIGHT) {
                     int x, y;
                     SDL_GetMouseState(&x, &y);
-                    const bool itemSelected = show_context_menu(window, x, y, config.shadowEffect);
-                    if (!itemSelected) {
-                        fprintf(stderr, "Context menu failed to show\n");
+                    int activeSkin = -1;
+                    for (int i = 0; i < skinCount && g_skin; ++i) {
+                        char dir[260];
+                        SDL_snprintf(dir, sizeof(dir), "%s/%s", SKIN_ROOT, skinNames[i]);
+                        if (strcmp(dir, config.skin) == 0) activeSkin = i;
                     }
+                    commandId = platform->show_menu(x, y, &(CClockMenuState) {
+                        .shadowEnabled = config.shadowEffect,
+                        .skins = skinNames,
+                        .skinCount = skinCount,
+                        .activeSkin = activeSkin,
+                    });
                 }
             }
             else if (e.type == SDL_MOUSEWHEEL) {
-                if (e.wheel.y > 0) // scroll up
-                {
-                    if ((config.clockScale += .1f) > 1.5) config.clockScale = 1.5f;
-                    // Put code for handling "scroll up" here!
-                }
-                else if (e.wheel.y < 0) // scroll down
-                {
-                    if ((config.clockScale -= .1f) < 0.5f) config.clockScale = 0.5f;
-                    // Put code for handling "scroll down" here!
-                }
-
-                get_clock_text_size(mode, font256, &config, &textWidth, &textHeight);
-                ttfDestRect = get_clock_position(window, textWidth, textHeight);
+                // Trackpads send fractions of a notch, dozens per frame
+                wheelNotches += e.wheel.preciseY != 0.f ? e.wheel.preciseY : (float)e.wheel.y;
             }
             else if (e.type == SDL_SYSWMEVENT) {
+                CClockPlatformEvent platformEvent;
+                if (platform->translate(&e, &platformEvent)) {
+                    switch (platformEvent.kind) {
+                    case CCLOCK_PLATFORM_COMMAND:
+                        commandId = platformEvent.id;
+                        break;
+                    case CCLOCK_PLATFORM_HOTKEY:
 #ifdef FEATURE_HOTKEY_SUPPORT
-                if (e.syswm.msg->msg.win.msg == WM_HOTKEY) {
-                    if (e.syswm.msg->msg.win.wParam == HOTKEY_LCTRLT) {
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(10);
-                    }
-                }
-                else 
+                        if (platformEvent.id == HOTKEY_LCTRLT) commandId = HMENU_CHRONO_MODE_10s_ID;
 #endif
-                if (e.syswm.msg->msg.win.msg == WM_COMMAND) {
-                    switch (LOWORD(e.syswm.msg->msg.win.wParam)) {
-                    case HMENU_EXIT_ID:
-                        isRunning = false;
-                        break;
-                    case HMENU_SHADOW_ID:
-                        config.shadowEffect = !config.shadowEffect;
-                        break;
-                    case HMENU_CHRONO_MODE_10s_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(10);
-                        break;
-                    case HMENU_CHRONO_MODE_10M_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(60 * 10);
-                        break;
-                    case HMENU_CHRONO_MODE_15M_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(60 * 15);
-                        break;
-                    case HMENU_CHRONO_MODE_30M_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(60 * 30);
-                        break;
-                    case HMENU_CHRONO_MODE_1H_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(3600);
-                        break;
-                    case HMENU_CHRONO_MODE_2H_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(2 * 3600);
                         break;
-                    case HMENU_CHRONO_MODE_3H_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(3 * 3600);
+                    case CCLOCK_PLATFORM_DISPLAY_OFF:
+                    case CCLOCK_PLATFORM_DISPLAY_ON:
+                        displayOff = platformEvent.kind == CCLOCK_PLATFORM_DISPLAY_OFF;
+                        needsRedraw = true;
                         break;
-                    case HMENU_CHRONO_MODE_4H_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(4 * 3600);
-                        break;
-                    case HMENU_CHRONO_MODE_5H_ID:
-                        mode = CCLOCK_CHRONO;
-                        chronoTargetTm = get_tm_chrono(5 * 3600);
-                        break;
-                    case HMENU_CLOCK_MODE_HH_MM_SS_ID:
-                        mode = CCLOCK_CLOCK;
-                        config.style = CCLOCK_STYLE_HH_MM_SS;
-                        break;
-                    case HMENU_CLOCK_MODE_HH_MM_ID:
-                        mode = CCLOCK_CLOCK;
-                        config.style = CCLOCK_STYLE_HH_MM;
-                        break;
-                    }
-                    
-                    if (mode == CCLOCK_CHRONO) {
-                        startTimeTm = get_tm();
                     }
-                    else {
-                        taskbar_stop_progress(window);
-                    }
-                    
-                    get_clock_text_size(mode, font256, &config, &textWidth, &textHeight);
+                }
+            }
+            else if (controlRunning && e.type == control.eventType) {
+                // Every command the client had sent by this wakeup, one relayout for all of them
+                int controlCount;
+                CClockControlCommand* commands = control_take(&control, &controlCount);
+                CClockSnapshot controlNow;
+                cclock_snapshot(&engine, &controlNow);
+                bool styleChanged = false;
+                for (int i = 0; i < controlCount; ++i) styleChanged |= control_apply(&commands[i], &engine, &config.style, &controlNow);
+                if (styleChanged) compile_formats(&config, &engine);
+                if (controlCount > 0) {
+                    if (engine.mode != CCLOCK_CHRONO) platform->stop_progress();
+                    layout.count = 0;
+                    get_clock_text_size(&engine, font256, &config, &layout, &textWidth, &textHeight);
                     ttfDestRect = get_clock_position(window, textWidth, textHeight);
-                    
-
+                    needsRedraw = true;
                 }
+                controlPending = commands != NULL;
+            }
+            else if (e.type == g_commandEvent) {
+                // Same ids as the context menu, pushed by --soak
+                commandId = e.user.code;
+            }
+            else if (e.type == SDL_RENDER_TARGETS_RESET || e.type == SDL_RENDER_DEVICE_RESET) {
+                analog_face_invalidate(&analogFace);
+                if (e.type == SDL_RENDER_DEVICE_RESET) {
+                    glyph_atlas_destroy(&textAtlas);
+                    text_cache_clear(&textCache);
+                    textAtlasFailed = false;
+                    if (compositor.pixels) {
+                        // The streaming texture is gone, the framebuffer is rebuilt with it
+                        int outW, outH;
+                        SDL_GetRendererOutputSize(renderer, &outW, &outH);
+                        compositor_destroy(&compositor);
+                        compositor_init(&compositor, renderer, outW, outH, renderPool.threadCount > 0 ? &renderPool : NULL);
+                    }
+                }
+                needsRedraw = true;
             }
             else if (e.type == SDL_QUIT) {
                 isRunning = false;
             }
+
+            if (recording.file) record_event(&recording, (uint32_t)(SDL_GetTicks64() - loopStartTicks), &e, commandId);
+
+            if (commandId != 0) {
+                CClockSnapshot commandNow;
+                cclock_snapshot(&engine, &commandNow);
+                switch (commandId) {
+                case HMENU_EXIT_ID:
+                    isRunning = false;
+                    break;
+                case HMENU_SHADOW_ID:
+                    config.shadowEffect = !config.shadowEffect;
+                    break;
+                case HMENU_CHRONO_MODE_10s_ID:
+                    cclock_chrono_start(&engine, &commandNow, 10);
+                    break;
+                case HMENU_CHRONO_MODE_10M_ID:
+                    cclock_chrono_start(&engine, &commandNow, 60 * 10);
+                    break;
+                case HMENU_CHRONO_MODE_15M_ID:
+                    cclock_chrono_start(&engine, &commandNow, 60 * 15);
+                    break;
+                case HMENU_CHRONO_MODE_30M_ID:
+                    cclock_chrono_start(&engine, &commandNow, 60 * 30);
+                    break;
+                case HMENU_CHRONO_MODE_1H_ID:
+                    cclock_chrono_start(&engine, &commandNow, 3600);
+                    break;
+                case HMENU_CHRONO_MODE_2H_ID:
+                    cclock_chrono_start(&engine, &commandNow, 2 * 3600);
+                    break;
+                case HMENU_CHRONO_MODE_3H_ID:
+                    cclock_chrono_start(&engine, &commandNow, 3 * 3600);
+                    break;
+                case HMENU_CHRONO_MODE_4H_ID:
+                    cclock_chrono_start(&engine, &commandNow, 4 * 3600);
+                    break;
+                case HMENU_CHRONO_MODE_5H_ID:
+                    cclock_chrono_start(&engine, &commandNow, 5 * 3600);
+                    break;
+                case HMENU_CLOCK_MODE_HH_MM_SS_ID:
+                    engine.mode = CCLOCK_CLOCK;
+                    config.style = CCLOCK_STYLE_HH_MM_SS;
+                    compile_formats(&config, &engine);
+                    layout.count = 0;
+                    break;
+                case HMENU_CLOCK_MODE_HH_MM_ID:
+                    engine.mode = CCLOCK_CLOCK;
+                    config.style = CCLOCK_STYLE_HH_MM;
+                    compile_formats(&config, &engine);
+                    layout.count = 0;
+                    break;
+                case HMENU_CLOCK_MODE_ANALOG_ID:
+                    engine.mode = CCLOCK_CLOCK;
+                    config.style = engine.style = CCLOCK_STYLE_ANALOG;
+                    break;
+                case HMENU_WORLD_CLOCK_ID:
+                    engine.mode = CCLOCK_WORLD;
+                    break;
+                default: {
+                    // Skins: only the atlas is rebuilt, the window and renderer stay
+                    const int skinIndex = commandId - HMENU_SKIN_FIRST_ID;
+                    if (commandId != HMENU_SKIN_DEFAULT_ID && (skinIndex < 0 || skinIndex >= skinCount)) break;
+                    skin_free(&skin);
+                    g_skin = NULL;
+                    config.skin[0] = '\0';
+                    if (skinIndex >= 0) {
+                        SDL_snprintf(config.skin, sizeof(config.skin), "%s/%s", SKIN_ROOT, skinNames[skinIndex]);
+                        if (skin_load(&skin, config.skin)) g_skin = &skin;
+                        else config.skin[0] = '\0';
+                    }
+                    glyph_atlas_destroy(&textAtlas);
+                    textAtlasFailed = false;
+                    transitions_reset(&transitions);
+                    layout.count = 0;
+                    break;
+                }
+                }
+
+                if (engine.mode != CCLOCK_CHRONO) {
+                    platform->stop_progress();
+                }
+
+                get_clock_text_size(&engine, font256, &config, &layout, &textWidth, &textHeight);
+                ttfDestRect = get_clock_position(window, textWidth, textHeight);
+                needsRedraw = true;
+            }
+            hasEvent = SDL_PollEvent(&e);
+        }
+
+        if (wheelNotches != 0.f) {
+            zoomTarget += ZOOM_STEP * wheelNotches;
+            if (zoomTarget > ZOOM_MAX_SCALE) zoomTarget = ZOOM_MAX_SCALE;
+            if (zoomTarget < ZOOM_MIN_SCALE) zoomTarget = ZOOM_MIN_SCALE;
+            // A zoom starting now moves on this very frame
+            if (zoomLastMs == 0) zoomLastMs = SDL_GetTicks64() - displayFrameMs;
+            wheelNotches = 0.f;
+        }
+        if (config.clockScale != zoomTarget) {
+            const uint64_t zoomNowMs = SDL_GetTicks64();
+            config.clockScale += (zoomTarget - config.clockScale) * (1.f - expf(-(float)(zoomNowMs - zoomLastMs) / ZOOM_TIME_CONSTANT_MS));
+            zoomLastMs = zoomNowMs;
+            if (fabsf(zoomTarget - config.clockScale) < 0.002f) {
+                config.clockScale = zoomTarget;
+                zoomLastMs = 0;
+            }
+            get_clock_text_size(&engine, font256, &config, &layout, &textWidth, &textHeight);
+            // Rounding drifts while it moves, the last frame is placed from the window size again
+            ttfDestRect = zoomLastMs == 0 ? get_clock_position(window, textWidth, textHeight) : resize_centered(ttfDestRect, textWidth, textHeight);
+            needsRedraw = true;
+        }
+        analogFace.stretchNearest = config.clockScale != zoomTarget;
+
+        const bool isVisible = (!windowHidden && !displayOff) || headless;
+        profile_set_suspended(&profile, !isVisible);
+        // A transition only ends in a presented frame: hidden in the middle of one, drop it so the next
+        // frame shows the text as it is
+        if (!isVisible && transitions_running(&transitions)) transitions_reset(&transitions);
+
+        // Wall clock set back: the heap was computed from a future that did not happen
+        const time_t alarmNow = time_source_now(&g_clockTime);
+        if (alarmNow < lastAlarmCheck) alarms_reschedule(&alarms, alarmNow);
+        lastAlarmCheck = alarmNow;
+        int firedAlarms[4];
+        const int firedCount = alarms_fire_due(&alarms, alarmNow, firedAlarms, 4);
+        if (firedCount > 0) {
+            const CClockAlarm* alarm = &alarms.alarms[firedAlarms[0]];
+            sprintf_s(alarmText, sizeof(alarmText), "%s%s", alarm->label[0] ? alarm->label : "Alarm", firedCount > 1 ? " (+)" : "");
+            alarmShownUntil = alarmNow + ALARM_SHOW_SECONDS;
+            platform->flash();
         }
 
-        // Set the draw color to red
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);        // Create a rectangle for the square
-        // Clear the screen
-        SDL_RenderClear(renderer);
-        //SDL_RenderCopy(renderer, placeholderTex, NULL, &ttfDestRect);
+        if (options.profileSeconds > 0 && profile_elapsed_seconds(&profile) >= options.profileSeconds) {
+            isRunning = false;
+        }
 
-        char windowTitle[80];
-        char timeStr[80];
-        char dateStr[80];
+        CClockSnapshot snapshot;
+        cclock_snapshot(&engine, &snapshot);
+        CClockText text;
+        cclock_build_text(&engine, &snapshot, alarmNow < alarmShownUntil ? alarmText : NULL, &text);
+        const char* const windowTitle = text.windowTitle;
+        const char* const timeStr = text.timeStr;
+        const char* const dateStr = text.dateStr;
+        const SDL_Color clockColor = get_text_color(&text);
 
         const int shadowOffset = 4;
         const int shadowDateOffset = shadowOffset / 2;
         const SDL_Color shadowColor = (SDL_Color){ 1, 1, 1, 255 };
-        SDL_Color clockColor = (SDL_Color){ 245, 245, 245, 255 };
 
-        if (mode == CCLOCK_CLOCK) {
-            const struct tm tm = get_tm();
-            const int hour = tm.tm_hour;
-            const int min = tm.tm_min;
-            const int sec = tm.tm_sec;
+        if (engine.mode == CCLOCK_CHRONO) {
+            uint64_t completed, total;
+            cclock_chrono_progress(&engine, &snapshot, &completed, &total);
+            platform->set_progress(completed, total);
 
-            clockColor = (SDL_Color){ 245, 245, 245, 255 };
-            sprintf_s(windowTitle, 80, "%d%d:%d%d:%d%d - CClock", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
-            SDL_SetWindowTitle(window, windowTitle);
-            if (config.style == CCLOCK_STYLE_HH_MM) {
-                sprintf_s(timeStr, 80, "%d%d:%d%d", hour / 10, hour % 10, min / 10, min % 10);
-            }
-            else {
-                sprintf_s(timeStr, 80, "%d%d:%d%d:%d%d", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
+            if (completed >= total) {
+                platform->flash();
             }
+        }
 
-            sprintf_s(dateStr, 80, "%s %d %s %d", dayName[tm.tm_wday], tm.tm_mday, monthName[tm.tm_mon], 1900 + tm.tm_year);
+        // The second hand sweeps, every wakeup is a new frame, same while digits are animating
+        if ((engine.mode == CCLOCK_CLOCK && config.style == CCLOCK_STYLE_ANALOG) || transitions_running(&transitions)) {
+            needsRedraw = true;
+        }
 
+        if (strcmp(windowTitle, lastTitle) != 0) {
+            SDL_SetWindowTitle(window, windowTitle);
+            strcpy_s(lastTitle, sizeof(lastTitle), windowTitle);
         }
-        else if (mode == CCLOCK_CHRONO) {
-            const struct tm currentTm = get_tm();
-            double diff = get_tm_diff(&currentTm, &chronoTargetTm);
-            if (diff <= 0) {
-                clockColor = (SDL_Color){ 255, 87, 51, 255 };
-                diff = 0;
+
+        const bool contentChanged = strcmp(timeStr, lastTimeStr) != 0 || strcmp(dateStr, lastDateStr) != 0
+            || clockColor.r != lastColor.r || clockColor.g != lastColor.g || clockColor.b != lastColor.b;
+
+        // needsRedraw is still set from the event that made us visible again, so restoring renders exactly one catch-up frame
+        if (isVisible && (contentChanged || needsRedraw || options.fixedFps)) {
+            const Uint64 renderStart = SDL_GetPerformanceCounter();
+            const uint64_t nowMs = SDL_GetTicks64();
+            bool animatedDigits = false;
+            // Set the draw color to red
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);        // Create a rectangle for the square
+            // Clear the screen
+            SDL_RenderClear(renderer);
+            //SDL_RenderCopy(renderer, placeholderTex, NULL, &ttfDestRect);
+
+            const bool isAnalog = engine.mode == CCLOCK_CLOCK && config.style == CCLOCK_STYLE_ANALOG;
+            if (!isAnalog && !textAtlas.texture && !textAtlasFailed) {
+                TTF_Font* const fonts[] = { font256, font64 };
+                // Names or AM/PM in the time format need their glyphs in the time face
+                char timeCharset[128] = WORLD_CLOCK_TIME_CHARSET;
+                const size_t digitsLength = strlen(timeCharset);
+                format_charset(&engine.timeFormat, timeCharset + digitsLength, sizeof(timeCharset) - digitsLength);
+                const char* const charsets[] = { timeCharset, WORLD_CLOCK_LABEL_CHARSET };
+                const CClockGlyphImages* const images[] = { g_skin ? &g_skin->images : NULL, NULL };
+                const int shadowRadii[] = { SHADOW_BLUR_RADIUS, SHADOW_BLUR_RADIUS / 2 };
+                // Keyed on black: Solid glyphs and a shadow baked in opaque grays, see glyph_atlas_build
+                if (!glyph_atlas_build_images(&textAtlas, renderer, fonts, charsets, images, shadowRadii, 2, colorKeyed)) {
+                    fprintf(stderr, "Could not build the text atlas\n");
+                    textAtlasFailed = true;
+                }
             }
-            const int hour = (int)diff / 3600;
-            const int min = ((int)diff % 3600) / 60;
-            const int sec = (int)diff % 60;
 
-            sprintf_s(windowTitle, 80, "%d%d:%d%d:%d%d - CClock (Timer Mode)", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
-            SDL_SetWindowTitle(window, windowTitle);
+            if (isAnalog) {
+                analog_face_render(renderer, &analogFace, font64, &ttfDestRect, snapshot.secondsOfDay, clockColor, config.shadowEffect);
+            }
+            else if (engine.mode == CCLOCK_WORLD) {
+                if (textAtlas.texture) {
+                    int winW, winH;
+                    SDL_GetWindowSize(window, &winW, &winH);
+                    const SDL_Rect area = { 0, 0, winW, winH };
+                    world_clock_render(renderer, &worldClock, &textAtlas, &area, time_source_now(&g_clockTime),
+                        config.style == CCLOCK_STYLE_HH_MM_SS, clockColor, config.shadowEffect);
+                }
+            }
+            else if (compositor.pixels && !g_skin) {
+                compositor_clear(&compositor, 0xFF000000);
+                if (config.shadowEffect) {
+                    compositor_draw_text(&compositor, font64, dateStr, ttfDestRect.x + 15 + shadowDateOffset, ttfDestRect.y - 40 + shadowDateOffset, config.clockScale, shadowColor);
+                    compositor_draw_text(&compositor, font256, timeStr, ttfDestRect.x + shadowOffset, ttfDestRect.y + shadowOffset, config.clockScale, shadowColor);
+                }
+
+                compositor_draw_text(&compositor, font64, dateStr, ttfDestRect.x + 15, ttfDestRect.y - 40, config.clockScale, clockColor);
+                compositor_draw_text(&compositor, font256, timeStr, ttfDestRect.x, ttfDestRect.y, config.clockScale, clockColor);
+                compositor_present(&compositor, renderer);
+            }
+            else if (textAtlas.texture) {
+                const float x = (float)ttfDestRect.x;
+                const float y = (float)ttfDestRect.y;
+                const float scale = config.clockScale;
+                transitions_update(&transitions, timeStr, nowMs);
+                animatedDigits = true;
+                if (config.shadowEffect && textAtlas.shadowTexture) {
+                    // Pre-blurred, same cost per frame as the hard shadow
+                    glyph_batch_push_shadow(&shadowBatch, &textAtlas, WORLD_CLOCK_LABEL_FACE, dateStr, x + 15 + shadowDateOffset, y - 40 + shadowDateOffset, scale, shadowColor);
+                    transitions_push_text(&transitions, &shadowBatch, &textAtlas, WORLD_CLOCK_TIME_FACE, true, x + shadowOffset, y + shadowOffset, scale, shadowColor, nowMs);
+                    glyph_batch_flush_shadow(renderer, &textAtlas, &shadowBatch);
+                }
+                else if (config.shadowEffect) {
+                    glyph_batch_push_text(&textBatch, &textAtlas, WORLD_CLOCK_LABEL_FACE, dateStr, x + 15 + shadowDateOffset, y - 40 + shadowDateOffset, scale, shadowColor);
+                    transitions_push_text(&transitions, &textBatch, &textAtlas, WORLD_CLOCK_TIME_FACE, false, x + shadowOffset, y + shadowOffset, scale, shadowColor, nowMs);
+                }
+
+                glyph_batch_push_text(&textBatch, &textAtlas, WORLD_CLOCK_LABEL_FACE, dateStr, x + 15, y - 40, scale, clockColor);
+                // Colored skins are drawn as is, only the fade applies
+                const SDL_Color timeColor = g_skin && !g_skin->tint ? (SDL_Color){ 255, 255, 255, clockColor.a } : clockColor;
+                transitions_push_text(&transitions, &textBatch, &textAtlas, WORLD_CLOCK_TIME_FACE, false, x, y, scale, timeColor, nowMs);
+                glyph_batch_flush(renderer, &textAtlas, &textBatch);
+            }
+            else {
+                if (config.shadowEffect) {
+                    text_cache_draw(&textCache, renderer, font64, dateStr, ttfDestRect.x + 15 + shadowDateOffset, ttfDestRect.y - 40 + shadowDateOffset, config.clockScale, shadowColor);
+                    text_cache_draw(&textCache, renderer, font256, timeStr, ttfDestRect.x + shadowOffset, ttfDestRect.y + shadowOffset, config.clockScale, shadowColor);
+                }
 
-            strcpy_s(dateStr, 13, "Timer Mode: ");
-            sprintf_s(timeStr, 80, "%d%d:%d%d:%d%d", hour / 10, hour % 10, min / 10, min % 10, sec / 10, sec % 10);
+                text_cache_draw(&textCache, renderer, font64, dateStr, ttfDestRect.x + 15, ttfDestRect.y - 40, config.clockScale, clockColor);
+                text_cache_draw(&textCache, renderer, font256, timeStr, ttfDestRect.x, ttfDestRect.y, config.clockScale, clockColor);
+            }
 
-            double total = get_tm_diff(&startTimeTm, &chronoTargetTm);
-            double completed = total - diff;
-            taskbar_set_progress(window, (uint64_t)completed, (uint64_t)total);
+            // Update the screen
+            SDL_RenderPresent(renderer);
 
-            if (completed >= total) {
-                taskbar_flash_done(window);
+            const double renderMs = (double)(SDL_GetPerformanceCounter() - renderStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+            if (replay.events) frame_stats_add(&frameStats, renderMs);
+            if (animatedDigits) {
+                transitions_frame_presented(&transitions, renderMs, nowMs);
+            }
+            else {
+                // Other views do not animate, coming back shows the digits without a transition
+                transitions_reset(&transitions);
             }
-        }
 
-        if (config.shadowEffect) {
-            render_text(renderer, font64, dateStr, ttfDestRect.x + 15 + shadowDateOffset, ttfDestRect.y - 40 + shadowDateOffset, config.clockScale, shadowColor);
-            render_text(renderer, font256, timeStr, ttfDestRect.x + shadowOffset, ttfDestRect.y + shadowOffset, config.clockScale, shadowColor);
+            profile.framesPresented++;
+            if (contentChanged) profile.framesChanged++;
+            strcpy_s(lastTimeStr, 80, timeStr);
+            strcpy_s(lastDateStr, 80, dateStr);
+            lastColor = clockColor;
+            needsRedraw = false;
+        }
+        // The replies go out once the change is on screen, right away while nothing is
+        if (controlPending) {
+            control_complete(&control);
+            controlPending = false;
         }
 
-        render_text(renderer, font64, dateStr, ttfDestRect.x + 15, ttfDestRect.y - 40, config.clockScale, clockColor);
-        render_text(renderer, font256, timeStr, ttfDestRect.x, ttfDestRect.y, config.clockScale, clockColor);
+        if (options.fixedFps) {
+            SDL_Delay((u32)floor(DELTA_TIME * 1000.0));
+        }
 
-        // Update the screen
-        SDL_RenderPresent(renderer);
+        if (options.soakDays > 0 && soakHours >= soakNextSample) {
+            CClockSoakSample sample = { 0 };
+            soak_sample_process(&sample);
+            soak_sample_caches(&sample, &textAtlas, &textCache, &analogFace, &compositor);
+            soak_record(&soak, &sample, (double)soakHours, stdout);
+            soakNextSample += SOAK_SAMPLE_HOURS;
+            if (soakHours >= options.soakDays * 24) isRunning = false;
+        }
+        // The frame of the last events is in the stats
+        if (replay.events && replay_finished(&replay)) isRunning = false;
+    }
 
-        SDL_Delay((u32)floor(DELTA_TIME * 1000.0));
+    int exitCode = 0;
+    if (options.profileSeconds > 0) {
+        profile_report(&profile, stdout);
+        if (textCache.draws > 0) text_cache_report(&textCache, stdout);
+        if (transitions.style != CCLOCK_TRANSITION_NONE) transitions_report(&transitions, stdout);
+        if (!profile_within_budget(&profile, options.idleBudget)) {
+            fprintf(stderr, "Idle CPU over budget: %.1f ms/hour > %.1f ms/hour\n", profile_cpu_ms_per_hour(&profile), options.idleBudget);
+            exitCode = 2;
+        }
     }
 
-    write_ini(iniFileName, &config);
+    if (options.soakDays > 0 && !soak_report(&soak, stdout)) exitCode = 3;
+    replay_record_close(&recording, (uint32_t)(SDL_GetTicks64() - loopStartTicks));
+    if (replay.events) {
+        printf("replay: %d events over %.1f s%s\n", replay.count, replayMs / 1000.0, options.replayFast ? ", fast" : "");
+        frame_stats_report(&frameStats, stdout);
+    }
+    replay_free(&replay);
+    frame_stats_free(&frameStats);
+
+    // Soak and replay changed modes and scales, those are not the user's
+    config.clockScale = zoomTarget;
+    if (!headless) write_ini(iniFileName, &config);
+
+    analog_face_destroy(&analogFace);
+    world_clock_destroy(&worldClock);
+    alarms_destroy(&alarms);
+    glyph_batch_destroy(&textBatch);
+    glyph_batch_destroy(&shadowBatch);
+    glyph_atlas_destroy(&textAtlas);
+    skin_free(&skin);
+    text_cache_clear(&textCache);
+    compositor_destroy(&compositor);
+    worker_pool_destroy(&renderPool);
+    SDL_DestroyRenderer(renderer);
 
     TTF_CloseFont(font256);
     TTF_CloseFont(font64);
 
     TTF_Quit();
 
-    taskbar_deinit();
+    if (controlRunning) control_stop(&control);
+    platform->detach();
 
     /* Frees memory */
     SDL_DestroyWindow(window);
 
+    log_stop();
+    if (log_dropped() > 0) fprintf(stderr, "log: %lu messages dropped\n", log_dropped());
+
     /* Shuts down all SDL subsystems */
     SDL_Quit();
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,273 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // SIGPIPE
+#endif
+
+#include "export.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <signal.h>
+#endif
+
+#include "glyph_atlas.h"
+#include "monotonic.h"
+#include "shm_ring.h"
+#include "skin.h"
+#include "soak_track.h"
+#include "worldclock.h"
+
+// Frames rendered but not written yet, more than that and new frames are dropped
+#define EXPORT_QUEUE_SLOTS 3
+
+// Bounded pipeline between the render loop and the writer thread
+typedef struct {
+    uint8_t* slots[EXPORT_QUEUE_SLOTS];
+    int head;           // oldest frame waiting for the writer
+    int count;          // slots holding a frame, including the one being written
+    size_t frameBytes;
+    FILE* out;
+    SDL_mutex* mutex;
+    SDL_cond* ready;
+    bool stop;
+    bool failed;        // write error, typically the reader closed the pipe
+    unsigned long written;
+    unsigned long dropped;
+} ExportQueue;
+
+static int writer_main(void* data) {
+    ExportQueue* queue = data;
+    for (;;) {
+        SDL_LockMutex(queue->mutex);
+        while (queue->count == 0 && !queue->stop) SDL_CondWait(queue->ready, queue->mutex);
+        if (queue->count == 0) {
+            SDL_UnlockMutex(queue->mutex);
+            return 0;
+        }
+        const uint8_t* frame = queue->slots[queue->head];
+        SDL_UnlockMutex(queue->mutex);
+
+        // The slot stays counted while it is written so the renderer cannot reuse it
+        const bool ok = fwrite(frame, 1, queue->frameBytes, queue->out) == queue->frameBytes && fflush(queue->out) == 0;
+
+        SDL_LockMutex(queue->mutex);
+        queue->head = (queue->head + 1) % EXPORT_QUEUE_SLOTS;
+        queue->count--;
+        if (ok) queue->written++;
+        else queue->failed = true;
+        SDL_UnlockMutex(queue->mutex);
+        if (!ok) return 1;
+    }
+}
+
+// Free slot for the next frame or NULL when the writer is behind
+static uint8_t* queue_reserve(ExportQueue* queue) {
+    SDL_LockMutex(queue->mutex);
+    uint8_t* slot = queue->count < EXPORT_QUEUE_SLOTS ? queue->slots[(queue->head + queue->count) % EXPORT_QUEUE_SLOTS] : NULL;
+    if (!slot) queue->dropped++;
+    SDL_UnlockMutex(queue->mutex);
+    return slot;
+}
+
+static void queue_commit(ExportQueue* queue) {
+    SDL_LockMutex(queue->mutex);
+    queue->count++;
+    SDL_CondSignal(queue->ready);
+    SDL_UnlockMutex(queue->mutex);
+}
+
+static FILE* open_output(const char* path) {
+    if (strcmp(path, "-") == 0) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        return stdout;
+    }
+    FILE* f = NULL;
+#ifdef _WIN32
+    fopen_s(&f, path, "wb");
+#else
+    // Opening a FIFO blocks until the reader shows up
+    f = fopen(path, "wb");
+#endif
+    return f;
+}
+
+static void format_clock(const CClockExportOptions* options, char* timeStr, size_t timeSize, char* dateStr, size_t dateSize) {
+    struct tm tm;
+    time_source_local(options->timeSource, &tm);
+    format_apply(options->timeFormat, &tm, timeStr, timeSize);
+    format_apply(options->dateFormat, &tm, dateStr, dateSize);
+}
+
+int export_run(const CClockExportOptions* options) {
+    int result = 1;
+    SDL_Surface* target = NULL;
+    SDL_Renderer* renderer = NULL;
+    TTF_Font* font256 = NULL;
+    TTF_Font* font64 = NULL;
+    CClockGlyphAtlas atlas = { 0 };
+    CClockSkin skin = { 0 };
+    CClockGlyphBatch batch = { 0 };
+    CClockGlyphBatch shadowBatch = { 0 };
+    ExportQueue queue = { 0 };
+    SDL_Thread* writer = NULL;
+    CClockShmRing ring = { 0 };
+    const bool toShm = strncmp(options->path, "shm:", 4) == 0;
+    unsigned long published = 0;
+
+#ifndef _WIN32
+    // A reader closing the pipe must end the export, not kill the process
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    if (SDL_Init(SDL_INIT_TIMER) != 0 || TTF_Init() < 0) {
+        fprintf(stderr, "export: init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // No window: the software renderer draws straight into a surface we own
+    target = SDL_CreateRGBSurfaceWithFormat(0, options->width, options->height, 32, SDL_PIXELFORMAT_RGBA32);
+    renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    font256 = TTF_OpenFont("digital-mono.ttf", 256);
+    font64 = TTF_OpenFont("digital-mono.ttf", 48);
+    if (!renderer || !font256 || !font64) {
+        fprintf(stderr, "export: renderer or font failed: %s\n", SDL_GetError());
+        goto cleanup;
+    }
+
+    TTF_Font* const fonts[] = { font256, font64 };
+    // Names or AM/PM in the time format need their glyphs in the time face
+    char timeCharset[128] = WORLD_CLOCK_TIME_CHARSET;
+    const size_t digitsLength = strlen(timeCharset);
+    format_charset(options->timeFormat, timeCharset + digitsLength, sizeof(timeCharset) - digitsLength);
+    const char* const charsets[] = { timeCharset, WORLD_CLOCK_LABEL_CHARSET };
+    const int shadowRadii[] = { 8, 4 };
+    const bool skinned = options->skin && skin_load(&skin, options->skin);
+    const CClockGlyphImages* const images[] = { skinned ? &skin.images : NULL, NULL };
+    if (!glyph_atlas_build_images(&atlas, renderer, fonts, charsets, images, options->shadowEffect ? shadowRadii : NULL, 2, false)) goto cleanup;
+
+    if (toShm) {
+        // Readers map the frames in place, publishing never waits for them
+        if (!shm_ring_create(&ring, options->path + 4, options->width, options->height)) goto cleanup;
+        fprintf(stderr, "export: publishing to shared memory %s\n", ring.name);
+    }
+    else {
+        queue.frameBytes = (size_t)options->width * options->height * 4;
+        queue.mutex = SDL_CreateMutex();
+        queue.ready = SDL_CreateCond();
+        bool allocated = true;
+        for (int i = 0; i < EXPORT_QUEUE_SLOTS; ++i) {
+            queue.slots[i] = malloc(queue.frameBytes);
+            allocated = allocated && queue.slots[i];
+        }
+        queue.out = open_output(options->path);
+        if (!queue.out) {
+            fprintf(stderr, "export: could not open '%s'\n", options->path);
+            goto cleanup;
+        }
+        writer = SDL_CreateThread(writer_main, "cclock-export", &queue);
+        if (!queue.mutex || !queue.ready || !allocated || !writer) {
+            fprintf(stderr, "export: pipeline failed: %s\n", SDL_GetError());
+            goto cleanup;
+        }
+    }
+
+    // Same layout as the window, scaled so the time fills 90% of the width
+    char placeholder[FORMAT_MAX_TEXT];
+    format_placeholder(options->timeFormat, placeholder, sizeof(placeholder));
+    const float timeW = (float)glyph_atlas_text_width(&atlas, WORLD_CLOCK_TIME_FACE, placeholder);
+    const float scale = options->width * 0.9f / timeW;
+    const float dateH = atlas.faces[WORLD_CLOCK_LABEL_FACE].lineHeight * scale;
+    const float x = options->width * 0.05f;
+    const float y = (options->height - atlas.faces[WORLD_CLOCK_TIME_FACE].lineHeight * scale + dateH) / 2.f;
+    const float shadowOffset = 4.f * scale;
+    const SDL_Color clockColor = { 245, 245, 245, 255 };
+    const SDL_Color timeColor = skinned && !skin.tint ? (SDL_Color){ 255, 255, 255, 255 } : clockColor;
+    const SDL_Color shadowColor = { 0, 0, 0, 160 };
+
+    const double frameMs = 1000.0 / options->fps;
+    const uint64_t startMs = SDL_GetTicks64();
+    result = 0;
+    for (long frame = 0; options->frames <= 0 || frame < options->frames; ++frame) {
+        // Absolute schedule, a late frame does not make the following ones late
+        const uint64_t dueMs = startMs + (uint64_t)(frame * frameMs);
+        const uint64_t nowMs = SDL_GetTicks64();
+        if (dueMs > nowMs) SDL_Delay((Uint32)(dueMs - nowMs));
+
+        if (!toShm) {
+            SDL_LockMutex(queue.mutex);
+            const bool failed = queue.failed;
+            SDL_UnlockMutex(queue.mutex);
+            if (failed) break;
+        }
+
+        const uint64_t captureNs = monotonic_ns();
+        uint8_t* slot = toShm ? shm_ring_begin_write(&ring, captureNs) : queue_reserve(&queue);
+        if (!slot) continue;
+
+        char timeStr[FORMAT_MAX_TEXT], dateStr[FORMAT_MAX_TEXT];
+        format_clock(options, timeStr, sizeof(timeStr), dateStr, sizeof(dateStr));
+
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        if (options->shadowEffect) {
+            glyph_batch_push_shadow(&shadowBatch, &atlas, WORLD_CLOCK_LABEL_FACE, dateStr, x + shadowOffset / 2.f, y - dateH + shadowOffset / 2.f, scale, shadowColor);
+            glyph_batch_push_shadow(&shadowBatch, &atlas, WORLD_CLOCK_TIME_FACE, timeStr, x + shadowOffset, y + shadowOffset, scale, shadowColor);
+            glyph_batch_flush_shadow(renderer, &atlas, &shadowBatch);
+        }
+        glyph_batch_push_text(&batch, &atlas, WORLD_CLOCK_LABEL_FACE, dateStr, x, y - dateH, scale, clockColor);
+        glyph_batch_push_text(&batch, &atlas, WORLD_CLOCK_TIME_FACE, timeStr, x, y, scale, timeColor);
+        glyph_batch_flush(renderer, &atlas, &batch);
+
+        // Straight into the pipeline slot, no intermediate buffer
+        if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGBA32, slot, options->width * 4) != 0) {
+            fprintf(stderr, "export: read back failed: %s\n", SDL_GetError());
+            result = 1;
+            break;
+        }
+        if (toShm) {
+            shm_ring_publish(&ring);
+            published++;
+        }
+        else queue_commit(&queue);
+    }
+
+cleanup:
+    if (writer) {
+        SDL_LockMutex(queue.mutex);
+        queue.stop = true;
+        SDL_CondSignal(queue.ready);
+        SDL_UnlockMutex(queue.mutex);
+        SDL_WaitThread(writer, NULL);
+        fprintf(stderr, "export: %lu frames written, %lu dropped%s\n", queue.written, queue.dropped, queue.failed ? ", output closed" : "");
+    }
+    if (toShm && ring.header) fprintf(stderr, "export: %lu frames published\n", published);
+    shm_ring_close(&ring);
+    if (queue.out && queue.out != stdout) fclose(queue.out);
+    for (int i = 0; i < EXPORT_QUEUE_SLOTS; ++i) free(queue.slots[i]);
+    if (queue.ready) SDL_DestroyCond(queue.ready);
+    if (queue.mutex) SDL_DestroyMutex(queue.mutex);
+    glyph_batch_destroy(&batch);
+    glyph_batch_destroy(&shadowBatch);
+    glyph_atlas_destroy(&atlas);
+    skin_free(&skin);
+    if (font256) TTF_CloseFont(font256);
+    if (font64) TTF_CloseFont(font64);
+    if (renderer) SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    TTF_Quit();
+    SDL_Quit();
+    return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "format.h"
+#include "time_source.h"
+
+// Headless raw frame export for streaming overlays: the clock is rendered with the software
+// renderer into an RGBA surface (transparent background) and written as raw RGBA32 frames,
+// width * height * 4 bytes each, with no header
+typedef struct {
+    const char* path;   // "-" for stdout, "shm:<name>" for a shared memory ring (see shm_ring.h), otherwise a file or a FIFO
+    double fps;
+    int width;
+    int height;
+    long frames;        // <= 0 runs until the reader goes away
+    const char* skin;   // skin pack directory, NULL for digital-mono.ttf
+    const CClockFormat* timeFormat;
+    const CClockFormat* dateFormat;
+    const CClockTimeSource* timeSource; // wall time of the frames, the frame rate stays real
+    bool shadowEffect;
+} CClockExportOptions;
+
+// Frames the writer cannot keep up with are dropped, the clock never waits for the consumer.
+// Returns the process exit code
+int export_run(const CClockExportOptions* options);
@@ -0,0 +1,270 @@
+#include "format.h"
+
+#include <stdio.h>
+#include <string.h>
+
+enum {
+    OP_LITERAL,
+    OP_HOUR24,
+    OP_HOUR12,
+    OP_MINUTE,
+    OP_SECOND,
+    OP_AMPM,
+    OP_DAY,
+    OP_MONTH,
+    OP_YEAR2,
+    OP_YEAR4,
+    OP_YEAR_DAY,
+    OP_WEEKDAY_SHORT,
+    OP_WEEKDAY,
+    OP_MONTH_SHORT,
+    OP_MONTH_NAME,
+};
+
+static const char* const dayNames[] = {
+    "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday",
+};
+
+static const char* const monthNames[] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December",
+};
+
+typedef struct {
+    char directive;
+    uint8_t kind;
+    uint8_t pad;
+    unsigned fields;
+} CClockDirective;
+
+static const CClockDirective directives[] = {
+    { 'H', OP_HOUR24, '0', CCLOCK_FIELD_HOUR },
+    { 'I', OP_HOUR12, '0', CCLOCK_FIELD_HOUR },
+    { 'M', OP_MINUTE, '0', CCLOCK_FIELD_MINUTE },
+    { 'S', OP_SECOND, '0', CCLOCK_FIELD_SECOND },
+    { 'p', OP_AMPM, 0, CCLOCK_FIELD_HOUR },
+    { 'd', OP_DAY, '0', CCLOCK_FIELD_DAY },
+    { 'e', OP_DAY, ' ', CCLOCK_FIELD_DAY },
+    { 'm', OP_MONTH, '0', CCLOCK_FIELD_MONTH },
+    { 'y', OP_YEAR2, '0', CCLOCK_FIELD_YEAR },
+    { 'Y', OP_YEAR4, 0, CCLOCK_FIELD_YEAR },
+    { 'j', OP_YEAR_DAY, '0', CCLOCK_FIELD_DAY },
+    { 'a', OP_WEEKDAY_SHORT, 0, CCLOCK_FIELD_DAY },
+    { 'A', OP_WEEKDAY, 0, CCLOCK_FIELD_DAY },
+    { 'b', OP_MONTH_SHORT, 0, CCLOCK_FIELD_MONTH },
+    { 'B', OP_MONTH_NAME, 0, CCLOCK_FIELD_MONTH },
+};
+
+static bool push_literal(CClockFormat* format, const char* text, size_t length) {
+    if (length == 0) return true;
+    const bool extend = format->opCount > 0 && format->ops[format->opCount - 1].kind == OP_LITERAL;
+    size_t offset = 0;
+    for (int i = 0; i < format->opCount; ++i) {
+        if (format->ops[i].kind == OP_LITERAL) offset = format->ops[i].literal + format->ops[i].length;
+    }
+    if (offset + length > FORMAT_MAX_LITERALS || (!extend && format->opCount == FORMAT_MAX_OPS)) return false;
+
+    memcpy(format->literals + offset, text, length);
+    if (extend) {
+        // "%%" right after a literal, extend it rather than spending an op
+        format->ops[format->opCount - 1].length += (uint8_t)length;
+    }
+    else {
+        CClockFormatOp* op = &format->ops[format->opCount++];
+        op->kind = OP_LITERAL;
+        op->pad = 0;
+        op->literal = (uint8_t)offset;
+        op->length = (uint8_t)length;
+    }
+    return true;
+}
+
+bool format_compile(CClockFormat* format, const char* text) {
+    memset(format, 0, sizeof(*format));
+    const char* p = text;
+    while (*p) {
+        const char* start = p;
+        while (*p && *p != '%') ++p;
+        if (!push_literal(format, start, (size_t)(p - start))) {
+            fprintf(stderr, "format: '%s' is too long\n", text);
+            return false;
+        }
+        if (!*p) break;
+
+        ++p;
+        bool noPad = false;
+        if (*p == '-') {
+            noPad = true;
+            ++p;
+        }
+        if (*p == '%') {
+            if (!push_literal(format, "%", 1)) {
+                fprintf(stderr, "format: '%s' is too long\n", text);
+                return false;
+            }
+            ++p;
+            continue;
+        }
+
+        const CClockDirective* directive = NULL;
+        for (size_t i = 0; i < sizeof(directives) / sizeof(directives[0]); ++i) {
+            if (directives[i].directive == *p) directive = &directives[i];
+        }
+        if (!directive || !*p) {
+            fprintf(stderr, "format: unknown directive '%%%c' in '%s'\n", *p ? *p : ' ', text);
+            return false;
+        }
+        if (format->opCount == FORMAT_MAX_OPS) {
+            fprintf(stderr, "format: '%s' is too long\n", text);
+            return false;
+        }
+        CClockFormatOp* op = &format->ops[format->opCount++];
+        op->kind = directive->kind;
+        op->pad = noPad ? 0 : directive->pad;
+        format->fields |= directive->fields;
+        ++p;
+    }
+    return true;
+}
+
+static size_t put_text(char* out, size_t at, size_t size, const char* text, size_t length) {
+    if (at + length >= size) length = at < size - 1 ? size - 1 - at : 0;
+    memcpy(out + at, text, length);
+    return at + length;
+}
+
+static size_t put_number(char* out, size_t at, size_t size, int value, int width, char pad) {
+    // Right to left into a small buffer, no division loop over a reversed copy
+    char text[12];
+    char* const end = text + sizeof(text);
+    char* p = end;
+    unsigned v = value < 0 ? 0u : (unsigned)value;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    if (pad) {
+        while (end - p < width) *--p = pad;
+    }
+    return put_text(out, at, size, p, (size_t)(end - p));
+}
+
+size_t format_apply(const CClockFormat* format, const struct tm* tm, char* out, size_t size) {
+    if (size == 0) return 0;
+    size_t at = 0;
+    for (int i = 0; i < format->opCount; ++i) {
+        const CClockFormatOp* op = &format->ops[i];
+        const char pad = (char)op->pad;
+        switch (op->kind) {
+        case OP_LITERAL:
+            at = put_text(out, at, size, format->literals + op->literal, op->length);
+            break;
+        case OP_HOUR24:
+            at = put_number(out, at, size, tm->tm_hour, 2, pad);
+            break;
+        case OP_HOUR12:
+            at = put_number(out, at, size, tm->tm_hour % 12 == 0 ? 12 : tm->tm_hour % 12, 2, pad);
+            break;
+        case OP_MINUTE:
+            at = put_number(out, at, size, tm->tm_min, 2, pad);
+            break;
+        case OP_SECOND:
+            at = put_number(out, at, size, tm->tm_sec, 2, pad);
+            break;
+        case OP_AMPM:
+            at = put_text(out, at, size, tm->tm_hour < 12 ? "AM" : "PM", 2);
+            break;
+        case OP_DAY:
+            at = put_number(out, at, size, tm->tm_mday, 2, pad);
+            break;
+        case OP_MONTH:
+            at = put_number(out, at, size, tm->tm_mon + 1, 2, pad);
+            break;
+        case OP_YEAR2:
+            at = put_number(out, at, size, (tm->tm_year + 1900) % 100, 2, pad);
+            break;
+        case OP_YEAR4:
+            at = put_number(out, at, size, tm->tm_year + 1900, 4, pad);
+            break;
+        case OP_YEAR_DAY:
+            at = put_number(out, at, size, tm->tm_yday + 1, 3, pad);
+            break;
+        case OP_WEEKDAY_SHORT:
+            at = put_text(out, at, size, dayNames[tm->tm_wday % 7], 3);
+            break;
+        case OP_WEEKDAY:
+            at = put_text(out, at, size, dayNames[tm->tm_wday % 7], strlen(dayNames[tm->tm_wday % 7]));
+            break;
+        case OP_MONTH_SHORT:
+            at = put_text(out, at, size, monthNames[tm->tm_mon % 12], 3);
+            break;
+        case OP_MONTH_NAME:
+            at = put_text(out, at, size, monthNames[tm->tm_mon % 12], strlen(monthNames[tm->tm_mon % 12]));
+            break;
+        }
+    }
+    out[at] = '\0';
+    return at;
+}
+
+int format_refresh_seconds(unsigned fields) {
+    if (fields & CCLOCK_FIELD_SECOND) return 1;
+    if (fields & CCLOCK_FIELD_MINUTE) return 60;
+    if (fields & CCLOCK_FIELD_HOUR) return 3600;
+    return 86400;
+}
+
+void format_placeholder(const CClockFormat* format, char* out, size_t size) {
+    // Wednesday, September 30: the longest names, two digit day and month, then every digit becomes a zero
+    struct tm widest = { 0 };
+    widest.tm_year = 2000 - 1900;
+    widest.tm_mon = 8;
+    widest.tm_mday = 30;
+    widest.tm_wday = 3;
+    widest.tm_yday = 273;
+    widest.tm_hour = 20;
+    widest.tm_min = 20;
+    widest.tm_sec = 20;
+    format_apply(format, &widest, out, size);
+    for (char* c = out; *c; ++c) {
+        if (*c >= '1' && *c <= '9') *c = '0';
+    }
+}
+
+static void add_chars(char* out, size_t size, const char* text, size_t length) {
+    size_t used = strlen(out);
+    for (size_t i = 0; i < length && used + 1 < size; ++i) {
+        const char c = text[i];
+        if ((c >= '0' && c <= '9') || strchr(out, c)) continue;
+        out[used++] = c;
+        out[used] = '\0';
+    }
+}
+
+void format_charset(const CClockFormat* format, char* out, size_t size) {
+    if (size == 0) return;
+    out[0] = '\0';
+    for (int i = 0; i < format->opCount; ++i) {
+        const CClockFormatOp* op = &format->ops[i];
+        switch (op->kind) {
+        case OP_LITERAL:
+            add_chars(out, size, format->literals + op->literal, op->length);
+            break;
+        case OP_AMPM:
+            add_chars(out, size, "AMP", 3);
+            break;
+        case OP_DAY:
+        case OP_HOUR12:
+            if (op->pad == ' ') add_chars(out, size, " ", 1);
+            break;
+        case OP_WEEKDAY_SHORT:
+        case OP_WEEKDAY:
+            for (int d = 0; d < 7; ++d) add_chars(out, size, dayNames[d], strlen(dayNames[d]));
+            break;
+        case OP_MONTH_SHORT:
+        case OP_MONTH_NAME:
+            for (int m = 0; m < 12; ++m) add_chars(out, size, monthNames[m], strlen(monthNames[m]));
+            break;
+        }
+    }
+}
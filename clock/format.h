@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// strftime-like formats for the time and date lines, compiled once into an op list:
+//
+//   %H %I  hour 00-23, 01-12      %M %S  minute, second        %p  AM/PM
+//   %d %e  day 01-31, " 1"-"31"   %m     month 01-12           %j  day of the year
+//   %y %Y  year 24, 2024          %a %A  Mon, Monday           %b %B  Jan, January
+//   %%     percent                %-d    any number without padding
+//
+// The field mask tells how often the text can change, "%H:%M" only needs a redraw per minute
+
+#define FORMAT_MAX_OPS 32
+#define FORMAT_MAX_LITERALS 64
+#define FORMAT_MAX_TEXT 80
+
+typedef enum {
+    CCLOCK_FIELD_SECOND = 1 << 0,
+    CCLOCK_FIELD_MINUTE = 1 << 1,
+    CCLOCK_FIELD_HOUR = 1 << 2,
+    CCLOCK_FIELD_DAY = 1 << 3,      // day of the month, of the week or of the year
+    CCLOCK_FIELD_MONTH = 1 << 4,
+    CCLOCK_FIELD_YEAR = 1 << 5,
+} CClockFormatField;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t pad;            // '0', ' ' or 0 for none
+    uint8_t literal;        // LITERAL: offset into CClockFormat.literals
+    uint8_t length;         // LITERAL: byte count
+} CClockFormatOp;
+
+typedef struct {
+    CClockFormatOp ops[FORMAT_MAX_OPS];
+    int opCount;
+    char literals[FORMAT_MAX_LITERALS];
+    unsigned fields;        // CClockFormatField mask
+} CClockFormat;
+
+// False (with the offending directive on stderr) for unknown directives or formats over the limits
+bool format_compile(CClockFormat* format, const char* text);
+
+// Writes at most size - 1 bytes, always terminated. Returns the length written
+size_t format_apply(const CClockFormat* format, const struct tm* tm, char* out, size_t size);
+
+// Seconds between two possible changes of the text: 1, 60, 3600 or 86400
+int format_refresh_seconds(unsigned fields);
+
+// Widest text the format can produce with monospace digits, for layout
+void format_placeholder(const CClockFormat* format, char* out, size_t size);
+
+// Every character the format can emit besides digits, so the glyph atlas holds them
+void format_charset(const CClockFormat* format, char* out, size_t size);
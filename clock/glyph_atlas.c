@@ -0,0 +1,447 @@
+#include "glyph_atlas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blur.h"
+#include "soak_track.h"
+
+// Keeps linear filtering from bleeding neighbouring glyphs in
+#define ATLAS_PADDING 1
+
+#define PACK_MAX_RECTS (GLYPH_ATLAS_MAX_FACES * GLYPH_ATLAS_CHAR_COUNT)
+// Color keyed shadow page: blurred coverage under the cutoff stays see-through, the rest is opaque gray
+// from near black at the glyph to the edge gray, never the black key
+#define KEYED_SHADOW_CUTOFF 16
+#define KEYED_SHADOW_EDGE 72
+
+// Top edge of the packed area, the rects always sit on it
+typedef struct {
+    int x;
+    int y;
+    int w;
+} SkylineNode;
+
+// Sort key of one rect, the comparator needs no context so atlases can be built on several threads
+typedef struct {
+    int w;
+    int h;
+    int index;
+} PackOrder;
+
+static int compare_rect_height(const void* a, const void* b) {
+    const PackOrder* ra = a;
+    const PackOrder* rb = b;
+    if (ra->h != rb->h) return rb->h - ra->h;
+    if (ra->w != rb->w) return rb->w - ra->w;
+    return ra->index - rb->index;
+}
+
+// Lowest y a w wide rect can rest at when its left edge is on node i, -1 when it does not fit
+static int skyline_fit(const SkylineNode* nodes, int nodeCount, int i, int w) {
+    if (nodes[i].x + w > GLYPH_ATLAS_WIDTH) return -1;
+    int y = 0;
+    for (int remaining = w; remaining > 0; remaining -= nodes[i].w, ++i) {
+        if (i >= nodeCount) return -1;
+        if (nodes[i].y > y) y = nodes[i].y;
+    }
+    return y;
+}
+
+// Bottom-left skyline packing, tallest first. Skin images can have any size so shelves would waste
+// everything above the short ones (colon), TTF glyphs of one face all have the font height and end up
+// in rows like before. Rects with w == 0 are skipped. Returns the page height, -1 if a rect is wider than the page
+static int pack_skyline(SDL_Rect* rects, int count) {
+    PackOrder order[PACK_MAX_RECTS];
+    SkylineNode nodes[PACK_MAX_RECTS + 2];
+    SDL_assert(count <= PACK_MAX_RECTS);
+
+    int orderCount = 0;
+    for (int i = 0; i < count; ++i) {
+        if (rects[i].w > 0) order[orderCount++] = (PackOrder){ rects[i].w, rects[i].h, i };
+    }
+    qsort(order, orderCount, sizeof(PackOrder), compare_rect_height);
+
+    int nodeCount = 1;
+    nodes[0] = (SkylineNode){ ATLAS_PADDING, ATLAS_PADDING, GLYPH_ATLAS_WIDTH - ATLAS_PADDING };
+    int height = ATLAS_PADDING;
+    for (int o = 0; o < orderCount; ++o) {
+        SDL_Rect* rect = &rects[order[o].index];
+        const int w = rect->w + ATLAS_PADDING;
+        const int h = rect->h + ATLAS_PADDING;
+
+        int best = -1, bestY = 0;
+        for (int i = 0; i < nodeCount; ++i) {
+            const int y = skyline_fit(nodes, nodeCount, i, w);
+            if (y >= 0 && (best < 0 || y < bestY)) {
+                best = i;
+                bestY = y;
+            }
+        }
+        if (best < 0) return -1;
+        rect->x = nodes[best].x;
+        rect->y = bestY;
+        if (bestY + h > height) height = bestY + h;
+
+        // The new node covers [x, x + w), shrink or drop the nodes it hides
+        memmove(&nodes[best + 1], &nodes[best], sizeof(SkylineNode) * (nodeCount - best));
+        nodes[best] = (SkylineNode){ rect->x, bestY + h, w };
+        nodeCount++;
+        for (int i = best + 1; i < nodeCount; ++i) {
+            const int overlap = nodes[best].x + nodes[best].w - nodes[i].x;
+            if (overlap <= 0) break;
+            nodes[i].x += overlap;
+            nodes[i].w -= overlap;
+            if (nodes[i].w > 0) break;
+            memmove(&nodes[i], &nodes[i + 1], sizeof(SkylineNode) * (nodeCount - i - 1));
+            nodeCount--;
+            --i;
+        }
+        // Neighbours at the same height become one node so wide rects keep finding room
+        for (int i = 0; i + 1 < nodeCount; ++i) {
+            if (nodes[i].y != nodes[i + 1].y) continue;
+            nodes[i].w += nodes[i + 1].w;
+            memmove(&nodes[i + 1], &nodes[i + 2], sizeof(SkylineNode) * (nodeCount - i - 2));
+            nodeCount--;
+            --i;
+        }
+    }
+    return height;
+}
+
+static SDL_Texture* create_page(SDL_Renderer* renderer, SDL_Surface* page, SDL_ScaleMode scaleMode) {
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, page);
+    if (!texture) {
+        fprintf(stderr, "Could not create atlas texture: %s\n", SDL_GetError());
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(texture, scaleMode);
+    return texture;
+}
+
+// Solid rendering like compositor.c, coverage is 0 or 255 so nothing fringes against the color key.
+// The 8-bit surface becomes white ARGB8888 like a Blended one; palette index 0 is the background
+static SDL_Surface* render_glyph_solid(TTF_Font* font, int ch) {
+    SDL_Surface* solid = TTF_RenderGlyph_Solid(font, (Uint16)ch, (SDL_Color){ 255, 255, 255, 255 });
+    if (!solid) return NULL;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, solid->w, solid->h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (surface) {
+        SDL_LockSurface(solid);
+        for (int y = 0; y < solid->h; ++y) {
+            const Uint8* src = (const Uint8*)solid->pixels + y * solid->pitch;
+            Uint32* dst = (Uint32*)((Uint8*)surface->pixels + y * surface->pitch);
+            for (int x = 0; x < solid->w; ++x) dst[x] = src[x] ? 0xFFFFFFFF : 0;
+        }
+        SDL_UnlockSurface(solid);
+    }
+    SDL_FreeSurface(solid);
+    return surface;
+}
+
+// Opaque gray for a color keyed window, the blur becomes a ramp of dark colors instead of alpha
+static Uint32 keyed_shadow_texel(uint8_t coverage) {
+    if (coverage < KEYED_SHADOW_CUTOFF) return 0;
+    const Uint32 gray = 1 + (Uint32)(255 - coverage) * (KEYED_SHADOW_EDGE - 1) / (255 - KEYED_SHADOW_CUTOFF);
+    return 0xFF000000 | gray << 16 | gray << 8 | gray;
+}
+
+// Blurs the coverage of every glyph once and stores it as white + alpha in the second page,
+// or as opaque grays (keyed_shadow_texel) for a color keyed atlas
+static bool build_shadow_page(CClockGlyphAtlas* atlas, SDL_Renderer* renderer, SDL_Surface* (*surfaces)[GLYPH_ATLAS_CHAR_COUNT]) {
+    SDL_Rect rects[GLYPH_ATLAS_MAX_FACES * GLYPH_ATLAS_CHAR_COUNT] = { 0 };
+    for (int f = 0; f < atlas->faceCount; ++f) {
+        const int r = atlas->faces[f].shadowRadius;
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+            if (!surfaces[f][ch]) continue;
+            rects[f * GLYPH_ATLAS_CHAR_COUNT + ch] = (SDL_Rect){ 0, 0, surfaces[f][ch]->w + 2 * r, surfaces[f][ch]->h + 2 * r };
+        }
+    }
+    atlas->shadowHeight = pack_skyline(rects, PACK_MAX_RECTS);
+    if (atlas->shadowHeight < 0) return false;
+
+    SDL_Surface* page = SDL_CreateRGBSurfaceWithFormat(0, atlas->width, atlas->shadowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!page) {
+        fprintf(stderr, "Could not create shadow atlas surface: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_FillRect(page, NULL, atlas->colorKeyed ? 0 : 0x00FFFFFF);
+
+    bool success = true;
+    for (int f = 0; f < atlas->faceCount && success; ++f) {
+        CClockBlurKernel kernel;
+        blur_kernel_init(&kernel, atlas->faces[f].shadowRadius);
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT && success; ++ch) {
+            SDL_Surface* surface = surfaces[f][ch];
+            if (!surface) continue;
+            const SDL_Rect dst = rects[f * GLYPH_ATLAS_CHAR_COUNT + ch];
+            uint8_t* coverage = malloc((size_t)surface->w * surface->h);
+            uint8_t* blurred = malloc((size_t)dst.w * dst.h);
+            success = coverage && blurred;
+            if (success) {
+                // Blended glyphs are white ARGB8888, the alpha channel is the coverage
+                SDL_LockSurface(surface);
+                for (int y = 0; y < surface->h; ++y) {
+                    const Uint32* row = (const Uint32*)((const Uint8*)surface->pixels + y * surface->pitch);
+                    for (int x = 0; x < surface->w; ++x) coverage[y * surface->w + x] = (uint8_t)(row[x] >> 24);
+                }
+                SDL_UnlockSurface(surface);
+                success = blur_a8(blurred, coverage, surface->w, surface->h, &kernel);
+            }
+            if (success) {
+                for (int y = 0; y < dst.h; ++y) {
+                    Uint32* row = (Uint32*)((Uint8*)page->pixels + (dst.y + y) * page->pitch) + dst.x;
+                    const uint8_t* src = &blurred[y * dst.w];
+                    if (atlas->colorKeyed) {
+                        for (int x = 0; x < dst.w; ++x) row[x] = keyed_shadow_texel(src[x]);
+                    } else {
+                        for (int x = 0; x < dst.w; ++x) row[x] = ((Uint32)src[x] << 24) | 0x00FFFFFF;
+                    }
+                }
+                atlas->faces[f].glyphs[ch].shadowSrc = dst;
+            }
+            free(coverage);
+            free(blurred);
+        }
+    }
+
+    if (success) atlas->shadowTexture = create_page(renderer, page, atlas->colorKeyed ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+    SDL_FreeSurface(page);
+    return atlas->shadowTexture != NULL;
+}
+
+bool glyph_atlas_build(CClockGlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* const* fonts, const char* const* charsets,
+    const int* shadowRadii, int faceCount, bool colorKeyed) {
+    return glyph_atlas_build_images(atlas, renderer, fonts, charsets, NULL, shadowRadii, faceCount, colorKeyed);
+}
+
+bool glyph_atlas_build_images(CClockGlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* const* fonts, const char* const* charsets,
+    const CClockGlyphImages* const* images, const int* shadowRadii, int faceCount, bool colorKeyed) {
+    SDL_Surface* surfaces[GLYPH_ATLAS_MAX_FACES][GLYPH_ATLAS_CHAR_COUNT] = { 0 };
+    const SDL_Color white = { 255, 255, 255, 255 };
+    bool success = false;
+
+    SDL_assert(faceCount > 0 && faceCount <= GLYPH_ATLAS_MAX_FACES);
+    *atlas = (CClockGlyphAtlas){ 0 };
+    atlas->faceCount = faceCount;
+    atlas->colorKeyed = colorKeyed;
+
+    for (int f = 0; f < faceCount; ++f) {
+        CClockGlyphFace* face = &atlas->faces[f];
+        face->shadowRadius = shadowRadii ? SDL_min(shadowRadii[f], BLUR_MAX_RADIUS) : 0;
+        if (images && images[f]) {
+            // Borrowed, only the rasterized glyphs are freed below
+            face->lineHeight = images[f]->metrics.lineHeight;
+            for (int ch = 32; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+                surfaces[f][ch] = images[f]->surfaces[ch];
+                face->glyphs[ch].advance = images[f]->metrics.advances[ch];
+            }
+            continue;
+        }
+        face->lineHeight = TTF_FontHeight(fonts[f]);
+        for (const char* c = charsets[f]; *c; ++c) {
+            const int ch = (unsigned char)*c;
+            if (ch < 32 || ch >= GLYPH_ATLAS_CHAR_COUNT || surfaces[f][ch]) continue;
+            surfaces[f][ch] = colorKeyed ? render_glyph_solid(fonts[f], ch) : TTF_RenderGlyph_Blended(fonts[f], (Uint16)ch, white);
+            if (!surfaces[f][ch]) {
+                fprintf(stderr, "Could not rasterize glyph '%c': %s\n", ch, TTF_GetError());
+                goto cleanup;
+            }
+            TTF_GlyphMetrics(fonts[f], (Uint16)ch, NULL, NULL, NULL, NULL, &face->glyphs[ch].advance);
+        }
+    }
+
+    SDL_Rect rects[PACK_MAX_RECTS] = { 0 };
+    for (int f = 0; f < faceCount; ++f) {
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+            if (surfaces[f][ch]) rects[f * GLYPH_ATLAS_CHAR_COUNT + ch] = (SDL_Rect){ 0, 0, surfaces[f][ch]->w, surfaces[f][ch]->h };
+        }
+    }
+    atlas->width = GLYPH_ATLAS_WIDTH;
+    atlas->height = pack_skyline(rects, PACK_MAX_RECTS);
+    SDL_RendererInfo info;
+    if (atlas->height < 0 || (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_height > 0 && atlas->height > info.max_texture_height)) {
+        fprintf(stderr, "Glyphs do not fit in a %d px wide atlas\n", GLYPH_ATLAS_WIDTH);
+        goto cleanup;
+    }
+
+    SDL_Surface* page = SDL_CreateRGBSurfaceWithFormat(0, atlas->width, atlas->height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!page) {
+        fprintf(stderr, "Could not create atlas surface: %s\n", SDL_GetError());
+        goto cleanup;
+    }
+    SDL_FillRect(page, NULL, 0);
+    for (int f = 0; f < faceCount; ++f) {
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+            if (!surfaces[f][ch]) continue;
+            atlas->faces[f].glyphs[ch].src = rects[f * GLYPH_ATLAS_CHAR_COUNT + ch];
+            SDL_SetSurfaceBlendMode(surfaces[f][ch], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[f][ch], NULL, page, &atlas->faces[f].glyphs[ch].src);
+        }
+    }
+
+    atlas->texture = create_page(renderer, page, colorKeyed ? SDL_ScaleModeNearest : SDL_ScaleModeLinear);
+    SDL_FreeSurface(page);
+    if (!atlas->texture) goto cleanup;
+
+    // Without the shadow page callers fall back to the hard offset shadow
+    if (shadowRadii && !build_shadow_page(atlas, renderer, surfaces)) {
+        fprintf(stderr, "Soft shadows disabled\n");
+    }
+    success = true;
+
+cleanup:
+    for (int f = 0; f < faceCount; ++f) {
+        if (images && images[f]) continue;
+        for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+            SDL_FreeSurface(surfaces[f][ch]);
+        }
+    }
+    return success;
+}
+
+void glyph_atlas_destroy(CClockGlyphAtlas* atlas) {
+    if (atlas->texture) SDL_DestroyTexture(atlas->texture);
+    if (atlas->shadowTexture) SDL_DestroyTexture(atlas->shadowTexture);
+    *atlas = (CClockGlyphAtlas){ 0 };
+}
+
+int glyph_atlas_text_width(const CClockGlyphAtlas* atlas, int face, const char* text) {
+    int width = 0;
+    for (const char* c = text; *c; ++c) {
+        const int ch = (unsigned char)*c;
+        if (ch < GLYPH_ATLAS_CHAR_COUNT) width += atlas->faces[face].glyphs[ch].advance;
+    }
+    return width;
+}
+
+static bool batch_reserve(CClockGlyphBatch* batch, int quadCount) {
+    if (batch->quadCount + quadCount <= batch->quadCapacity) return true;
+
+    int capacity = batch->quadCapacity ? batch->quadCapacity * 2 : 64;
+    while (capacity < batch->quadCount + quadCount) capacity *= 2;
+
+    SDL_Vertex* vertices = SDL_realloc(batch->vertices, sizeof(SDL_Vertex) * 4 * capacity);
+    if (!vertices) return false;
+    batch->vertices = vertices;
+    int* indices = SDL_realloc(batch->indices, sizeof(int) * 6 * capacity);
+    if (!indices) return false;
+    batch->indices = indices;
+
+    // Index pattern is the same for every quad, fill it once when growing
+    for (int q = batch->quadCapacity; q < capacity; ++q) {
+        int* i = &batch->indices[q * 6];
+        const int v = q * 4;
+        i[0] = v; i[1] = v + 1; i[2] = v + 2;
+        i[3] = v; i[4] = v + 2; i[5] = v + 3;
+    }
+    batch->quadCapacity = capacity;
+    return true;
+}
+
+static void push_quad(CClockGlyphBatch* batch, const SDL_Rect* src, float invW, float invH, float x0, float y0, float scale, SDL_Color color) {
+    const float x1 = x0 + src->w * scale;
+    const float y1 = y0 + src->h * scale;
+    const float u0 = src->x * invW;
+    const float v0 = src->y * invH;
+    const float u1 = (src->x + src->w) * invW;
+    const float v1 = (src->y + src->h) * invH;
+
+    SDL_Vertex* v = &batch->vertices[batch->quadCount * 4];
+    v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+    v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+    v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+    v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+    batch->quadCount++;
+}
+
+void glyph_batch_push_text(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, const char* text,
+    float x, float y, float scale, SDL_Color color) {
+
+    if (!batch_reserve(batch, (int)SDL_strlen(text))) return;
+
+    const float invW = 1.f / atlas->width;
+    const float invH = 1.f / atlas->height;
+    float penX = x;
+    for (const char* c = text; *c; ++c) {
+        const int ch = (unsigned char)*c;
+        if (ch >= GLYPH_ATLAS_CHAR_COUNT) continue;
+        const CClockGlyph* glyph = &atlas->faces[face].glyphs[ch];
+        if (glyph->src.w > 0) push_quad(batch, &glyph->src, invW, invH, penX, y, scale, color);
+        penX += glyph->advance * scale;
+    }
+}
+
+// The keyed shadow page has its grays baked in, only the alpha of the color applies
+static SDL_Color shadow_tint(const CClockGlyphAtlas* atlas, SDL_Color color) {
+    return atlas->colorKeyed ? (SDL_Color){ 255, 255, 255, color.a } : color;
+}
+
+void glyph_batch_push_shadow(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, const char* text,
+    float x, float y, float scale, SDL_Color color) {
+
+    if (!atlas->shadowTexture || !batch_reserve(batch, (int)SDL_strlen(text))) return;
+
+    const float invW = 1.f / atlas->width;
+    const float invH = 1.f / atlas->shadowHeight;
+    const float offset = atlas->faces[face].shadowRadius * scale;
+    const SDL_Color tint = shadow_tint(atlas, color);
+    float penX = x;
+    for (const char* c = text; *c; ++c) {
+        const int ch = (unsigned char)*c;
+        if (ch >= GLYPH_ATLAS_CHAR_COUNT) continue;
+        const CClockGlyph* glyph = &atlas->faces[face].glyphs[ch];
+        if (glyph->shadowSrc.w > 0) push_quad(batch, &glyph->shadowSrc, invW, invH, penX - offset, y - offset, scale, tint);
+        penX += glyph->advance * scale;
+    }
+}
+
+void glyph_batch_push_band(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, int ch, bool shadow,
+    float x, float y, float scale, float srcTop, float srcBottom, float dstTop, float dstBottom, SDL_Color color) {
+
+    if (ch < 0 || ch >= GLYPH_ATLAS_CHAR_COUNT || dstBottom <= dstTop || !batch_reserve(batch, 1)) return;
+    const CClockGlyph* glyph = &atlas->faces[face].glyphs[ch];
+    const SDL_Rect* src = shadow ? &glyph->shadowSrc : &glyph->src;
+    if (src->w == 0 || (shadow && !atlas->shadowTexture)) return;
+
+    const float offset = shadow ? atlas->faces[face].shadowRadius * scale : 0.f;
+    const float invW = 1.f / atlas->width;
+    const float invH = 1.f / (shadow ? atlas->shadowHeight : atlas->height);
+    const float x0 = x - offset;
+    const float x1 = x0 + src->w * scale;
+    const float y0 = y - offset + dstTop * src->h * scale;
+    const float y1 = y - offset + dstBottom * src->h * scale;
+    const float u0 = src->x * invW;
+    const float u1 = (src->x + src->w) * invW;
+    const float v0 = (src->y + srcTop * src->h) * invH;
+    const float v1 = (src->y + srcBottom * src->h) * invH;
+    if (shadow) color = shadow_tint(atlas, color);
+
+    SDL_Vertex* v = &batch->vertices[batch->quadCount * 4];
+    v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+    v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+    v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+    v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+    batch->quadCount++;
+}
+
+void glyph_batch_flush(SDL_Renderer* renderer, const CClockGlyphAtlas* atlas, CClockGlyphBatch* batch) {
+    if (batch->quadCount > 0) {
+        SDL_RenderGeometry(renderer, atlas->texture, batch->vertices, batch->quadCount * 4, batch->indices, batch->quadCount * 6);
+    }
+    batch->quadCount = 0;
+}
+
+void glyph_batch_flush_shadow(SDL_Renderer* renderer, const CClockGlyphAtlas* atlas, CClockGlyphBatch* batch) {
+    if (batch->quadCount > 0 && atlas->shadowTexture) {
+        SDL_RenderGeometry(renderer, atlas->shadowTexture, batch->vertices, batch->quadCount * 4, batch->indices, batch->quadCount * 6);
+    }
+    batch->quadCount = 0;
+}
+
+void glyph_batch_destroy(CClockGlyphBatch* batch) {
+    SDL_free(batch->vertices);
+    SDL_free(batch->indices);
+    *batch = (CClockGlyphBatch){ 0 };
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "cclock.h"
+
+#define GLYPH_ATLAS_MAX_FACES 2
+#define GLYPH_ATLAS_CHAR_COUNT CCLOCK_GLYPH_COUNT
+#define GLYPH_ATLAS_WIDTH 2048
+
+typedef struct {
+    SDL_Rect src;       // w == 0 when the glyph is not in the atlas
+    SDL_Rect shadowSrc; // blurred glyph in the shadow page, shadowRadius larger on every side
+    int advance;
+} CClockGlyph;
+
+typedef struct {
+    CClockGlyph glyphs[GLYPH_ATLAS_CHAR_COUNT];
+    int lineHeight;
+    int shadowRadius;
+} CClockGlyphFace;
+
+// Every glyph of every face lives in one texture so any mix of faces is a single draw.
+// Soft shadows are blurred once at build time into a second page, drawing them costs a textured quad per glyph.
+// Color keyed windows get the blur baked as opaque grays, see glyph_atlas_build
+typedef struct {
+    SDL_Texture* texture;
+    int width;
+    int height;
+    SDL_Texture* shadowTexture; // NULL when built without shadows
+    int shadowHeight;
+    bool colorKeyed;
+    CClockGlyphFace faces[GLYPH_ATLAS_MAX_FACES];
+    int faceCount;
+} CClockGlyphAtlas;
+
+// A face given as ready made ARGB8888 images (skin packs) instead of a font, drawn top-left at the pen
+typedef struct {
+    SDL_Surface* surfaces[GLYPH_ATLAS_CHAR_COUNT]; // NULL for missing characters
+    CClockGlyphMetrics metrics;
+} CClockGlyphImages;
+
+// Quads waiting to be submitted with one SDL_RenderGeometry call
+typedef struct {
+    SDL_Vertex* vertices;
+    int* indices;
+    int quadCount;
+    int quadCapacity;
+} CClockGlyphBatch;
+
+// Rasterizes charsets[i] of fonts[i] in white, glyphs are tinted through the vertex color.
+// shadowRadii[i] is the blur radius of the shadow page in pixels of fonts[i], NULL skips the shadow page.
+// colorKeyed: the target has no partial alpha, only the key color is see-through. Glyphs are then Solid
+// (coverage 0 or 255) with nearest filtering so no dark fringe is left around them. Alpha over the key
+// would round to either the key or opaque, so the shadow page stores the blur as opaque grays fading from
+// near black to a dark gray, drawn as is whatever the shadow color
+bool glyph_atlas_build(CClockGlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* const* fonts, const char* const* charsets,
+    const int* shadowRadii, int faceCount, bool colorKeyed);
+
+// Same as glyph_atlas_build, faces with images[i] != NULL are taken from the images instead of fonts[i].
+// The images are copied into the atlas and stay owned by the caller
+bool glyph_atlas_build_images(CClockGlyphAtlas* atlas, SDL_Renderer* renderer, TTF_Font* const* fonts, const char* const* charsets,
+    const CClockGlyphImages* const* images, const int* shadowRadii, int faceCount, bool colorKeyed);
+
+void glyph_atlas_destroy(CClockGlyphAtlas* atlas);
+
+// Unscaled width of text in pixels
+int glyph_atlas_text_width(const CClockGlyphAtlas* atlas, int face, const char* text);
+
+void glyph_batch_push_text(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, const char* text,
+    float x, float y, float scale, SDL_Color color);
+
+// Quads of the blurred glyphs, laid out so the blur is centered on where push_text would draw
+void glyph_batch_push_shadow(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, const char* text,
+    float x, float y, float scale, SDL_Color color);
+
+// Pushes the horizontal band [srcTop, srcBottom) of one glyph, fractions of its height, stretched over
+// [dstTop, dstBottom) of the box it normally occupies at (x, y). Used by the digit transitions
+void glyph_batch_push_band(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, int ch, bool shadow,
+    float x, float y, float scale, float srcTop, float srcBottom, float dstTop, float dstBottom, SDL_Color color);
+
+void glyph_batch_flush(SDL_Renderer* renderer, const CClockGlyphAtlas* atlas, CClockGlyphBatch* batch);
+
+// Same as glyph_batch_flush with the shadow page, for batches filled by glyph_batch_push_shadow
+void glyph_batch_flush_shadow(SDL_Renderer* renderer, const CClockGlyphAtlas* atlas, CClockGlyphBatch* batch);
+
+void glyph_batch_destroy(CClockGlyphBatch* batch);
@@ -0,0 +1,140 @@
+#include "log.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#include <SDL.h>
+
+typedef struct {
+    // Lap of the slot, position & ~(LOG_RING_SLOTS - 1): free for the producer of that position, + 1: ready
+    // to write out. Counting laps instead of positions lets the ring start zeroed
+    SDL_atomic_t sequence;
+    CClockLogLevel level;
+    Uint64 ticks;
+    char text[LOG_MESSAGE_MAX];
+} CClockLogSlot;
+
+static struct {
+    CClockLogSlot slots[LOG_RING_SLOTS];
+    SDL_atomic_t head;      // next position to claim
+    unsigned tail;          // next position to write out, writer only
+    SDL_atomic_t level;
+    SDL_atomic_t dropped;
+    SDL_atomic_t written;
+    SDL_atomic_t quit;
+    SDL_sem* wake;
+    SDL_Thread* thread;
+    FILE* out;
+} g_log = { .level = { LOG_LEVEL_INFO } };
+
+static const char g_levelNames[] = "DIWE";
+
+#define LAP(position) ((position) & ~(unsigned)(LOG_RING_SLOTS - 1))
+
+static int drain(void) {
+    int count = 0;
+    for (;;) {
+        CClockLogSlot* slot = &g_log.slots[g_log.tail & (LOG_RING_SLOTS - 1)];
+        if ((unsigned)SDL_AtomicGet(&slot->sequence) != LAP(g_log.tail) + 1) break;
+        fprintf(g_log.out, "[%8.3f] %c %s\n", slot->ticks / 1000.0, g_levelNames[slot->level], slot->text);
+        // Free again for the producer one lap later
+        SDL_AtomicSet(&slot->sequence, (int)(LAP(g_log.tail) + LOG_RING_SLOTS));
+        g_log.tail++;
+        count++;
+    }
+    if (count > 0) {
+        fflush(g_log.out);
+        SDL_AtomicAdd(&g_log.written, count);
+    }
+    return count;
+}
+
+static int writer_main(void* data) {
+    (void)data;
+    while (!SDL_AtomicGet(&g_log.quit)) {
+        if (drain() == 0) SDL_SemWaitTimeout(g_log.wake, LOG_FLUSH_MS);
+    }
+    drain();
+    return 0;
+}
+
+bool log_start(FILE* out, CClockLogLevel level) {
+    g_log.out = out;
+    SDL_AtomicSet(&g_log.level, level);
+    SDL_AtomicSet(&g_log.quit, 0);
+    g_log.wake = SDL_CreateSemaphore(0);
+    g_log.thread = g_log.wake ? SDL_CreateThread(writer_main, "cclock-log", NULL) : NULL;
+    if (!g_log.thread) {
+        fprintf(stderr, "log: no writer thread: %s\n", SDL_GetError());
+        if (g_log.wake) SDL_DestroySemaphore(g_log.wake);
+        g_log.wake = NULL;
+        return false;
+    }
+    return true;
+}
+
+void log_stop(void) {
+    if (!g_log.thread) return;
+    SDL_AtomicSet(&g_log.quit, 1);
+    SDL_SemPost(g_log.wake);
+    SDL_WaitThread(g_log.thread, NULL);
+    SDL_DestroySemaphore(g_log.wake);
+    g_log.thread = NULL;
+    g_log.wake = NULL;
+}
+
+void log_set_level(CClockLogLevel level) {
+    SDL_AtomicSet(&g_log.level, level);
+}
+
+bool log_enabled(CClockLogLevel level) {
+    return (int)level >= SDL_AtomicGet(&g_log.level);
+}
+
+bool log_parse_level(const char* name, CClockLogLevel* level) {
+    static const char* const names[] = { "debug", "info", "warn", "error", "off" };
+    for (int i = 0; i <= LOG_LEVEL_OFF; ++i) {
+        if (strcmp(name, names[i]) == 0) {
+            *level = (CClockLogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void log_write(CClockLogLevel level, const char* format, ...) {
+    unsigned position = (unsigned)SDL_AtomicGet(&g_log.head);
+    CClockLogSlot* slot;
+    for (;;) {
+        slot = &g_log.slots[position & (LOG_RING_SLOTS - 1)];
+        const int lag = (int)((unsigned)SDL_AtomicGet(&slot->sequence) - LAP(position));
+        if (lag == 0) {
+            if (SDL_AtomicCAS(&g_log.head, (int)position, (int)(position + 1))) break;
+        }
+        else if (lag < 0) {
+            // Still holds a message from the previous lap: full
+            SDL_AtomicIncRef(&g_log.dropped);
+            return;
+        }
+        position = (unsigned)SDL_AtomicGet(&g_log.head);
+    }
+
+    slot->level = level;
+    slot->ticks = SDL_GetTicks64();
+    va_list args;
+    va_start(args, format);
+    SDL_vsnprintf(slot->text, sizeof(slot->text), format, args);
+    va_end(args);
+    SDL_AtomicSet(&slot->sequence, (int)(LAP(position) + 1));
+
+    // A burst wakes the writer every half ring instead of filling it before the next flush
+    if ((level >= LOG_LEVEL_WARN || (position & (LOG_RING_SLOTS / 2 - 1)) == 0) && g_log.wake) SDL_SemPost(g_log.wake);
+}
+
+unsigned long log_dropped(void) {
+    return (unsigned long)SDL_AtomicGet(&g_log.dropped);
+}
+
+unsigned long log_written(void) {
+    return (unsigned long)SDL_AtomicGet(&g_log.written);
+}
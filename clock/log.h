@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Process wide logger for the paths that run per event or per frame. A message is formatted into a
+// slot of a lock-free ring (a sequence number per slot, producers claim slots with a CAS) and a
+// background thread writes the slots out, so the caller never waits for the console or a file.
+// When the ring is full the message is dropped and counted instead
+
+#define LOG_RING_SLOTS 1024     // power of two
+#define LOG_MESSAGE_MAX 160
+#define LOG_FLUSH_MS 50         // the writer wakes at least this often, warnings, errors and a half full ring wake it at once
+
+typedef enum {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF,
+} CClockLogLevel;
+
+// Messages below this level are not even compiled, ex: -DLOG_COMPILED_LEVEL=LOG_LEVEL_INFO for releases
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// The arguments are only evaluated when the level is on
+#define LOG_AT(level, ...) do { if ((level) >= LOG_COMPILED_LEVEL && log_enabled(level)) log_write(level, __VA_ARGS__); } while (0)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// Starts the writer thread. Messages logged before are kept until the ring is full
+bool log_start(FILE* out, CClockLogLevel level);
+
+// Writes what is left and joins the writer
+void log_stop(void);
+
+void log_set_level(CClockLogLevel level);
+
+bool log_enabled(CClockLogLevel level);
+
+// "debug", "info", "warn", "error" or "off"
+bool log_parse_level(const char* name, CClockLogLevel* level);
+
+void log_write(CClockLogLevel level, const char* format, ...);
+
+unsigned long log_dropped(void);
+
+unsigned long log_written(void);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+// Nanoseconds of the monotonic clock (CLOCK_MONOTONIC, QueryPerformanceCounter): never steps with the
+// wall clock and is the same for every process of the host
+uint64_t monotonic_ns(void);
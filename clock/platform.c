@@ -0,0 +1,81 @@
+#include "platform.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static bool headless_attach(SDL_Window* window) {
+    (void)window;
+    return true;
+}
+
+static void headless_detach(void) {
+}
+
+static void* headless_native_window(void) {
+    return NULL;
+}
+
+static bool headless_set_color_key(SDL_Color key) {
+    (void)key;
+    return false;
+}
+
+static int headless_show_menu(int x, int y, const CClockMenuState* menu) {
+    (void)x; (void)y; (void)menu;
+    return 0;
+}
+
+static void headless_set_progress(uint64_t completed, uint64_t total) {
+    (void)completed; (void)total;
+}
+
+static void headless_stop_progress(void) {
+}
+
+static void headless_flash(void) {
+}
+
+static bool headless_register_hotkey(int id, char key) {
+    (void)id; (void)key;
+    return false;
+}
+
+static bool headless_translate(const SDL_Event* event, CClockPlatformEvent* out) {
+    (void)event; (void)out;
+    return false;
+}
+
+const CClockPlatform g_platformHeadless = {
+    .name = "headless",
+    .attach = headless_attach,
+    .detach = headless_detach,
+    .native_window = headless_native_window,
+    .set_color_key = headless_set_color_key,
+    .show_menu = headless_show_menu,
+    .set_progress = headless_set_progress,
+    .stop_progress = headless_stop_progress,
+    .flash = headless_flash,
+    .register_hotkey = headless_register_hotkey,
+    .translate = headless_translate,
+};
+
+const CClockPlatform* platform_attach(SDL_Window* window, const char* name) {
+    static const CClockPlatform* const backends[] = {
+#ifdef _WIN32
+        &g_platformWin32,
+#endif
+#ifdef CCLOCK_HAVE_X11
+        &g_platformX11,
+#endif
+        &g_platformHeadless,
+    };
+    bool found = name == NULL;
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); ++i) {
+        if (name && strcmp(name, backends[i]->name) != 0) continue;
+        found = true;
+        if (backends[i]->attach(window)) return backends[i];
+    }
+    if (!found) fprintf(stderr, "Unknown platform '%s', using headless\n", name);
+    else if (name) fprintf(stderr, "Platform '%s' not available for this window, using headless\n", name);
+    return &g_platformHeadless;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <SDL.h>
+
+// What the window loop needs from the OS beyond SDL: the native window, color key transparency, the
+// context menu, taskbar progress, the attention flash, global hotkeys and the display power state.
+// Backends are picked at run time from the video driver of the window:
+//   win32      platform_win32.c
+//   x11        platform_x11.c, Linux builds without CCLOCK_NO_X11 (link with -lX11)
+//   headless   no-ops, any OS: --soak, --replay, Wayland and perf/valgrind runs with --platform headless
+
+#if !defined(_WIN32) && defined(__linux__) && !defined(CCLOCK_NO_X11)
+#define CCLOCK_HAVE_X11 1
+#endif
+
+// Context menu items, also the command ids of --soak, --replay and the platform events
+enum HMenuCClockContextMenuId {
+    HMENU_CLOCK_MODE_HH_MM_SS_ID = 1,
+    HMENU_CLOCK_MODE_HH_MM_ID,
+    HMENU_CLOCK_MODE_ANALOG_ID,
+    HMENU_WORLD_CLOCK_ID,
+    HMENU_CHRONO_MODE_10s_ID,
+    HMENU_CHRONO_MODE_10M_ID,
+    HMENU_CHRONO_MODE_15M_ID,
+    HMENU_CHRONO_MODE_30M_ID,
+    HMENU_CHRONO_MODE_1H_ID,
+    HMENU_CHRONO_MODE_2H_ID,
+    HMENU_CHRONO_MODE_3H_ID,
+    HMENU_CHRONO_MODE_4H_ID,
+    HMENU_CHRONO_MODE_5H_ID,
+    HMENU_SHADOW_ID,
+    HMENU_EXIT_ID,
+    HMENU_SKIN_DEFAULT_ID,
+    HMENU_SKIN_FIRST_ID,    // one id per listed skin after this one
+};
+
+// The checked items of the context menu
+typedef struct {
+    bool shadowEnabled;
+    const char (*skins)[64];
+    int skinCount;
+    int activeSkin;         // -1: the font
+} CClockMenuState;
+
+typedef enum {
+    CCLOCK_PLATFORM_COMMAND,        // id: a HMenuCClockContextMenuId
+    CCLOCK_PLATFORM_HOTKEY,         // id: given to register_hotkey
+    CCLOCK_PLATFORM_DISPLAY_OFF,
+    CCLOCK_PLATFORM_DISPLAY_ON,
+} CClockPlatformEventKind;
+
+typedef struct {
+    CClockPlatformEventKind kind;
+    int id;
+} CClockPlatformEvent;
+
+// One window per process, the backends keep their state in statics
+typedef struct {
+    const char* name;
+    // False when the window is not on this backend's windowing system
+    bool (*attach)(SDL_Window* window);
+    void (*detach)(void);
+    // HWND, X11 Window, NULL when headless
+    void* (*native_window)(void);
+    // Pixels of that color become see-through, false when the platform cannot do it
+    bool (*set_color_key)(SDL_Color key);
+    // Modal, window coordinates. Returns the HMenuCClockContextMenuId picked, 0 when dismissed
+    int (*show_menu)(int x, int y, const CClockMenuState* menu);
+    void (*set_progress)(uint64_t completed, uint64_t total);
+    void (*stop_progress)(void);
+    // Until the window gets the focus
+    void (*flash)(void);
+    // Ctrl + key from anywhere, reported by translate
+    bool (*register_hotkey)(int id, char key);
+    // Reads an SDL_SYSWMEVENT, true when it was one of the platform events
+    bool (*translate)(const SDL_Event* event, CClockPlatformEvent* out);
+} CClockPlatform;
+
+extern const CClockPlatform g_platformHeadless;
+#ifdef _WIN32
+extern const CClockPlatform g_platformWin32;
+#endif
+#ifdef CCLOCK_HAVE_X11
+extern const CClockPlatform g_platformX11;
+#endif
+
+// The backend named `name`, or the first one that attaches when NULL. Falls back to headless
+const CClockPlatform* platform_attach(SDL_Window* window, const char* name);
@@ -0,0 +1,199 @@
+#ifdef _WIN32
+
+#include "platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL_syswm.h>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+#include <Shobjidl.h>
+
+static HWND g_hwnd = NULL;
+static ITaskbarList3* g_taskBar = NULL;
+static HPOWERNOTIFY g_displayNotify = NULL;
+
+static HWND get_hwnd(SDL_Window* window) {
+    // Get window handle (https://stackoverflow.com/a/24118145/3357935)
+    SDL_SysWMinfo wmInfo;
+    // Initialize wmInfo
+    SDL_VERSION(&wmInfo.version);
+    if (!SDL_GetWindowWMInfo(window, &wmInfo) || wmInfo.subsystem != SDL_SYSWM_WINDOWS) return NULL;
+    return wmInfo.info.win.window;
+}
+
+static void taskbar_init(void) {
+    HRESULT hr;
+
+    hr = CoInitialize(NULL); //Needed to be able to use CoCreateInstance
+    if (!SUCCEEDED(hr)) {
+        fprintf(stderr, "Failed to initialize COM lib");
+        //MessageBox flags: https://learn.microsoft.com/fr-fr/windows/win32/api/winuser/nf-winuser-messagebox
+        MessageBox(g_hwnd, L"Failed to initialize COM lib", L"Error", MB_OK | MB_ICONERROR | MB_APPLMODAL);
+        exit(-1);
+    }
+
+    // We should always call CoInitialize before using any Co function: https://devblogs.microsoft.com/oldnewthing/20130419-00/?p=4613
+    hr = CoCreateInstance(&CLSID_TaskbarList, NULL,
+        CLSCTX_INPROC_SERVER,
+        &IID_ITaskbarList3,
+        (void**)&g_taskBar);
+
+    if (SUCCEEDED(hr)) {
+        g_taskBar->lpVtbl->HrInit(g_taskBar);
+    }
+}
+
+static bool win32_attach(SDL_Window* window) {
+    g_hwnd = get_hwnd(window);
+    if (!g_hwnd) return false;
+    taskbar_init();
+    // Ask Windows to send WM_POWERBROADCAST when the monitor is turned off or on
+    g_displayNotify = RegisterPowerSettingNotification(g_hwnd, &GUID_CONSOLE_DISPLAY_STATE, DEVICE_NOTIFY_WINDOW_HANDLE);
+    SDL_EventState(SDL_SYSWMEVENT, SDL_ENABLE);
+    return true;
+}
+
+static void win32_detach(void) {
+    if (g_displayNotify) UnregisterPowerSettingNotification(g_displayNotify);
+    g_displayNotify = NULL;
+    if (g_taskBar) {
+        g_taskBar->lpVtbl->Release(g_taskBar);
+        g_taskBar = NULL;
+    }
+    CoUninitialize();
+    g_hwnd = NULL;
+}
+
+static void* win32_native_window(void) {
+    return g_hwnd;
+}
+
+// Makes a window transparent by setting a transparency color.
+static bool win32_set_color_key(SDL_Color key) {
+    // Change window type to layered (https://stackoverflow.com/a/3970218/3357935)
+    SetWindowLong(g_hwnd, GWL_EXSTYLE, GetWindowLong(g_hwnd, GWL_EXSTYLE) | WS_EX_LAYERED);
+
+    // Set transparency color
+    return SetLayeredWindowAttributes(g_hwnd, RGB(key.r, key.g, key.b), 0, LWA_COLORKEY);
+}
+
+static int win32_show_menu(int x, int y, const CClockMenuState* menu) {
+    //Create the popup MENU
+    HMENU hmainPopupMenu = CreatePopupMenu();
+    HMENU hClockSubMenu = CreatePopupMenu();
+    HMENU hChronoSubMenu = CreatePopupMenu();
+    HMENU hSkinSubMenu = CreatePopupMenu();
+    //Insert wanted options here
+    //we can use AppendMenuA or InsertMenuA
+    AppendMenuA(hmainPopupMenu, MF_POPUP, (UINT_PTR)hClockSubMenu, "Clock Mode");
+    AppendMenuA(hClockSubMenu,  MF_STRING, HMENU_CLOCK_MODE_HH_MM_SS_ID, "HH:MM:SS");
+    AppendMenuA(hClockSubMenu,  MF_STRING, HMENU_CLOCK_MODE_HH_MM_ID, "HH:MM");
+    AppendMenuA(hClockSubMenu,  MF_STRING, HMENU_CLOCK_MODE_ANALOG_ID, "Analog");
+    AppendMenuA(hmainPopupMenu, MF_STRING, HMENU_WORLD_CLOCK_ID, "World Clock");
+    AppendMenuA(hmainPopupMenu, MF_POPUP, (UINT_PTR)hChronoSubMenu, "Chrono Mode");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_10s_ID, "10s");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_10M_ID, "10min");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_15M_ID, "15min");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_30M_ID, "30min");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_1H_ID, "1h");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_2H_ID, "2h");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_3H_ID, "3h");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_4H_ID, "4h");
+    AppendMenuA(hChronoSubMenu, MF_STRING, HMENU_CHRONO_MODE_5H_ID, "5h");
+
+    AppendMenuA(hmainPopupMenu, MF_POPUP, (UINT_PTR)hSkinSubMenu, "Skin");
+    AppendMenuA(hSkinSubMenu, menu->activeSkin < 0 ? MF_CHECKED : MF_UNCHECKED, HMENU_SKIN_DEFAULT_ID, "Default");
+    for (int i = 0; i < menu->skinCount; ++i) {
+        AppendMenuA(hSkinSubMenu, menu->activeSkin == i ? MF_CHECKED : MF_UNCHECKED, HMENU_SKIN_FIRST_ID + i, menu->skins[i]);
+    }
+
+    AppendMenuA(hmainPopupMenu, menu->shadowEnabled ? MF_CHECKED: MF_UNCHECKED, HMENU_SHADOW_ID, "Shadow");
+    AppendMenuA(hmainPopupMenu, MF_STRING, HMENU_EXIT_ID, "Exit");
+
+    SetForegroundWindow(g_hwnd);
+
+    POINT point = { .x = x, .y = y };
+    ClientToScreen(g_hwnd, &point);
+    // The picked id is returned instead of posted as WM_COMMAND, like the other backends
+    const int itemSelected = TrackPopupMenu(hmainPopupMenu,
+        TPM_BOTTOMALIGN | TPM_LEFTALIGN | TPM_RETURNCMD | TPM_NONOTIFY,
+        point.x, point.y, 0, g_hwnd, NULL);
+
+    // Clean up
+    DestroyMenu(hSkinSubMenu);
+    DestroyMenu(hChronoSubMenu);
+    DestroyMenu(hClockSubMenu);
+    DestroyMenu(hmainPopupMenu);
+
+    return itemSelected;
+}
+
+static void win32_set_progress(uint64_t completed, uint64_t total) {
+    if (!g_taskBar) return;
+    enum TBPFLAG flag = TBPF_NORMAL;
+    g_taskBar->lpVtbl->SetProgressState(g_taskBar, g_hwnd, flag);
+    g_taskBar->lpVtbl->SetProgressValue(g_taskBar, g_hwnd, completed, total);
+}
+
+static void win32_stop_progress(void) {
+    if (!g_taskBar) return;
+    g_taskBar->lpVtbl->SetProgressState(g_taskBar, g_hwnd, TBPF_NOPROGRESS);
+}
+
+static void win32_flash(void) {
+    FLASHWINFO fi;
+    fi.cbSize = sizeof(FLASHWINFO);
+    fi.hwnd = g_hwnd;
+    fi.dwFlags = FLASHW_ALL | FLASHW_TIMERNOFG;
+    fi.uCount = 0;
+    fi.dwTimeout = 0;
+    FlashWindowEx(&fi);
+}
+
+static bool win32_register_hotkey(int id, char key) {
+    return RegisterHotKey(g_hwnd, id, MOD_CONTROL | MOD_NOREPEAT, (UINT)key) != 0;
+}
+
+static bool win32_translate(const SDL_Event* event, CClockPlatformEvent* out) {
+    if (event->type != SDL_SYSWMEVENT || event->syswm.msg->subsystem != SDL_SYSWM_WINDOWS) return false;
+    const UINT msg = event->syswm.msg->msg.win.msg;
+    const WPARAM wParam = event->syswm.msg->msg.win.wParam;
+    if (msg == WM_HOTKEY) {
+        *out = (CClockPlatformEvent){ CCLOCK_PLATFORM_HOTKEY, (int)wParam };
+        return true;
+    }
+    if (msg == WM_POWERBROADCAST && wParam == PBT_POWERSETTINGCHANGE) {
+        const POWERBROADCAST_SETTING* setting = (const POWERBROADCAST_SETTING*)event->syswm.msg->msg.win.lParam;
+        if (IsEqualGUID(&setting->PowerSetting, &GUID_CONSOLE_DISPLAY_STATE)) {
+            // 0: off, 1: on, 2: dimmed
+            *out = (CClockPlatformEvent){ setting->Data[0] == 0 ? CCLOCK_PLATFORM_DISPLAY_OFF : CCLOCK_PLATFORM_DISPLAY_ON, 0 };
+            return true;
+        }
+    }
+    if (msg == WM_COMMAND) {
+        *out = (CClockPlatformEvent){ CCLOCK_PLATFORM_COMMAND, LOWORD(wParam) };
+        return true;
+    }
+    return false;
+}
+
+const CClockPlatform g_platformWin32 = {
+    .name = "win32",
+    .attach = win32_attach,
+    .detach = win32_detach,
+    .native_window = win32_native_window,
+    .set_color_key = win32_set_color_key,
+    .show_menu = win32_show_menu,
+    .set_progress = win32_set_progress,
+    .stop_progress = win32_stop_progress,
+    .flash = win32_flash,
+    .register_hotkey = win32_register_hotkey,
+    .translate = win32_translate,
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include "platform.h"
+
+#ifdef CCLOCK_HAVE_X11
+
+#include <stdio.h>
+#include <string.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+
+#include <SDL_syswm.h>
+
+// SDL's display connection, the popup menu shares it
+static Display* g_display = NULL;
+static Window g_window = 0;
+static KeyCode g_hotkeyCode = 0;
+static int g_hotkeyId = 0;
+
+#define X11_MENU_MAX_ITEMS 64
+#define X11_MENU_PADDING 6
+
+typedef struct {
+    const char* label;
+    int id;             // 0 for a section title
+    bool checked;
+} CClockX11MenuItem;
+
+static bool x11_attach(SDL_Window* window) {
+    SDL_SysWMinfo wmInfo;
+    SDL_VERSION(&wmInfo.version);
+    if (!SDL_GetWindowWMInfo(window, &wmInfo) || wmInfo.subsystem != SDL_SYSWM_X11) return false;
+    g_display = wmInfo.info.x11.display;
+    g_window = wmInfo.info.x11.window;
+    // FocusIn clears the urgency hint of flash, KeyPress carries the hotkey
+    SDL_EventState(SDL_SYSWMEVENT, SDL_ENABLE);
+    return true;
+}
+
+static void x11_detach(void) {
+    if (g_hotkeyCode) XUngrabKey(g_display, g_hotkeyCode, AnyModifier, DefaultRootWindow(g_display));
+    g_hotkeyCode = 0;
+    g_display = NULL;
+    g_window = 0;
+}
+
+static void* x11_native_window(void) {
+    return (void*)(uintptr_t)g_window;
+}
+
+static bool x11_set_color_key(SDL_Color key) {
+    // The core protocol has no color key, it takes an ARGB visual and a compositor: the background stays
+    (void)key;
+    return false;
+}
+
+static int add_item(CClockX11MenuItem* items, int count, const char* label, int id, bool checked) {
+    if (count < X11_MENU_MAX_ITEMS) items[count++] = (CClockX11MenuItem){ label, id, checked };
+    return count;
+}
+
+static Bool is_popup_event(Display* display, XEvent* event, XPointer popup) {
+    (void)display;
+    return event->xany.window == *(Window*)popup;
+}
+
+static void draw_menu(Window popup, GC gc, XFontStruct* font, const CClockX11MenuItem* items, int count, int itemHeight, int width, int hover) {
+    const unsigned long black = BlackPixel(g_display, DefaultScreen(g_display));
+    const unsigned long white = WhitePixel(g_display, DefaultScreen(g_display));
+    for (int i = 0; i < count; ++i) {
+        const int y = i * itemHeight;
+        XSetForeground(g_display, gc, i == hover && items[i].id ? black : white);
+        XFillRectangle(g_display, popup, gc, 0, y, width, itemHeight);
+        XSetForeground(g_display, gc, i == hover && items[i].id ? white : black);
+        const int indent = items[i].id ? 3 * X11_MENU_PADDING : X11_MENU_PADDING;
+        XDrawString(g_display, popup, gc, indent, y + X11_MENU_PADDING / 2 + font->ascent, items[i].label, (int)strlen(items[i].label));
+        if (items[i].checked) XDrawString(g_display, popup, gc, X11_MENU_PADDING, y + X11_MENU_PADDING / 2 + font->ascent, "*", 1);
+    }
+}
+
+// X11 has no native menus: a flat override-redirect popup, submenus become sections. The pointer is
+// grabbed until a click, events of SDL's windows stay queued for SDL meanwhile
+static int x11_show_menu(int x, int y, const CClockMenuState* menu) {
+    CClockX11MenuItem items[X11_MENU_MAX_ITEMS];
+    int count = 0;
+    count = add_item(items, count, "Clock Mode", 0, false);
+    count = add_item(items, count, "HH:MM:SS", HMENU_CLOCK_MODE_HH_MM_SS_ID, false);
+    count = add_item(items, count, "HH:MM", HMENU_CLOCK_MODE_HH_MM_ID, false);
+    count = add_item(items, count, "Analog", HMENU_CLOCK_MODE_ANALOG_ID, false);
+    count = add_item(items, count, "World Clock", HMENU_WORLD_CLOCK_ID, false);
+    count = add_item(items, count, "Chrono Mode", 0, false);
+    static const char* const chronoLabels[] = { "10s", "10min", "15min", "30min", "1h", "2h", "3h", "4h", "5h" };
+    for (int i = 0; i < 9; ++i) count = add_item(items, count, chronoLabels[i], HMENU_CHRONO_MODE_10s_ID + i, false);
+    count = add_item(items, count, "Skin", 0, false);
+    count = add_item(items, count, "Default", HMENU_SKIN_DEFAULT_ID, menu->activeSkin < 0);
+    for (int i = 0; i < menu->skinCount; ++i) count = add_item(items, count, menu->skins[i], HMENU_SKIN_FIRST_ID + i, menu->activeSkin == i);
+    count = add_item(items, count, "Shadow", HMENU_SHADOW_ID, menu->shadowEnabled);
+    count = add_item(items, count, "Exit", HMENU_EXIT_ID, false);
+
+    XFontStruct* font = XLoadQueryFont(g_display, "fixed");
+    if (!font) return 0;
+    const int itemHeight = font->ascent + font->descent + X11_MENU_PADDING;
+    int width = 0;
+    for (int i = 0; i < count; ++i) {
+        const int w = XTextWidth(font, items[i].label, (int)strlen(items[i].label));
+        if (w > width) width = w;
+    }
+    width += 5 * X11_MENU_PADDING;
+    const int height = count * itemHeight;
+
+    // Above the pointer like TPM_BOTTOMALIGN on Windows
+    const Window root = DefaultRootWindow(g_display);
+    int rootX, rootY;
+    Window child;
+    XTranslateCoordinates(g_display, g_window, root, x, y, &rootX, &rootY, &child);
+    rootY = rootY - height < 0 ? 0 : rootY - height;
+
+    XSetWindowAttributes attributes = { .override_redirect = True, .background_pixel = WhitePixel(g_display, DefaultScreen(g_display)) };
+    Window popup = XCreateWindow(g_display, root, rootX, rootY, (unsigned)width, (unsigned)height, 1, CopyFromParent, InputOutput,
+        CopyFromParent, CWOverrideRedirect | CWBackPixel, &attributes);
+    XSelectInput(g_display, popup, ExposureMask | ButtonPressMask | PointerMotionMask | KeyPressMask);
+    XMapRaised(g_display, popup);
+    GC gc = XCreateGC(g_display, popup, 0, NULL);
+    XSetFont(g_display, gc, font->fid);
+    XGrabPointer(g_display, popup, False, ButtonPressMask | PointerMotionMask, GrabModeAsync, GrabModeAsync, None, None, CurrentTime);
+    XGrabKeyboard(g_display, popup, False, GrabModeAsync, GrabModeAsync, CurrentTime);
+
+    // Picked on press: the release of the right click that opened the menu must not pick anything
+    int picked = 0, hover = -1;
+    for (bool open = true; open;) {
+        XEvent event;
+        XIfEvent(g_display, &event, is_popup_event, (XPointer)&popup);
+        switch (event.type) {
+        case Expose:
+            if (event.xexpose.count == 0) draw_menu(popup, gc, font, items, count, itemHeight, width, hover);
+            break;
+        case MotionNotify: {
+            const bool inside = event.xmotion.x >= 0 && event.xmotion.x < width && event.xmotion.y >= 0 && event.xmotion.y < height;
+            const int item = inside ? event.xmotion.y / itemHeight : -1;
+            if (item != hover) {
+                hover = item;
+                draw_menu(popup, gc, font, items, count, itemHeight, width, hover);
+            }
+            break;
+        }
+        case ButtonPress: {
+            const bool inside = event.xbutton.x >= 0 && event.xbutton.x < width && event.xbutton.y >= 0 && event.xbutton.y < height;
+            // A click outside or on a section title closes it
+            if (inside) picked = items[event.xbutton.y / itemHeight].id;
+            open = false;
+            break;
+        }
+        case KeyPress:
+            if (XLookupKeysym(&event.xkey, 0) == XK_Escape) open = false;
+            break;
+        }
+    }
+
+    XUngrabKeyboard(g_display, CurrentTime);
+    XUngrabPointer(g_display, CurrentTime);
+    XFreeGC(g_display, gc);
+    XDestroyWindow(g_display, popup);
+    XFreeFont(g_display, font);
+    XFlush(g_display);
+    return picked;
+}
+
+// No progress in the EWMH or ICCCM hints, only some taskbars read private properties
+static void x11_set_progress(uint64_t completed, uint64_t total) {
+    (void)completed; (void)total;
+}
+
+static void x11_stop_progress(void) {
+}
+
+static void set_urgency(bool urgent) {
+    XWMHints* hints = XGetWMHints(g_display, g_window);
+    if (!hints) hints = XAllocWMHints();
+    if (!hints) return;
+    if (urgent) hints->flags |= XUrgencyHint;
+    else hints->flags &= ~XUrgencyHint;
+    XSetWMHints(g_display, g_window, hints);
+    XFree(hints);
+    XFlush(g_display);
+}
+
+static void x11_flash(void) {
+    set_urgency(true);
+}
+
+static bool x11_register_hotkey(int id, char key) {
+    const char name[2] = { (char)(key >= 'A' && key <= 'Z' ? key - 'A' + 'a' : key), '\0' };
+    const KeyCode code = XKeysymToKeycode(g_display, XStringToKeysym(name));
+    if (!code) return false;
+    // With and without Caps Lock and Num Lock, a grab matches the exact modifiers
+    static const unsigned int locks[] = { 0, LockMask, Mod2Mask, LockMask | Mod2Mask };
+    for (int i = 0; i < 4; ++i) {
+        XGrabKey(g_display, code, ControlMask | locks[i], DefaultRootWindow(g_display), True, GrabModeAsync, GrabModeAsync);
+    }
+    g_hotkeyCode = code;
+    g_hotkeyId = id;
+    return true;
+}
+
+static bool x11_translate(const SDL_Event* event, CClockPlatformEvent* out) {
+    if (event->type != SDL_SYSWMEVENT || event->syswm.msg->subsystem != SDL_SYSWM_X11) return false;
+    const XEvent* x = &event->syswm.msg->msg.x11.event;
+    if (x->type == FocusIn && x->xfocus.window == g_window) {
+        set_urgency(false);
+    }
+    else if (x->type == KeyPress && g_hotkeyCode && x->xkey.keycode == g_hotkeyCode && (x->xkey.state & ControlMask)) {
+        *out = (CClockPlatformEvent){ CCLOCK_PLATFORM_HOTKEY, g_hotkeyId };
+        return true;
+    }
+    return false;
+}
+
+const CClockPlatform g_platformX11 = {
+    .name = "x11",
+    .attach = x11_attach,
+    .detach = x11_detach,
+    .native_window = x11_native_window,
+    .set_color_key = x11_set_color_key,
+    .show_menu = x11_show_menu,
+    .set_progress = x11_set_progress,
+    .stop_progress = x11_stop_progress,
+    .flash = x11_flash,
+    .register_hotkey = x11_register_hotkey,
+    .translate = x11_translate,
+};
+
+#endif
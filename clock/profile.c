@@ -0,0 +1,83 @@
+#include "profile.h"
+
+#include <SDL.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+double profile_cpu_seconds(void) {
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0.0;
+    }
+    // FILETIME is in 100ns units
+    const uint64_t kernel = ((uint64_t)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+    const uint64_t user = ((uint64_t)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+    return (double)(kernel + user) / 1e7;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+void profile_begin(CClockProfile* profile) {
+    *profile = (CClockProfile){ 0 };
+    profile->startTicks = SDL_GetTicks64();
+    profile->startCpuSeconds = profile_cpu_seconds();
+}
+
+double profile_elapsed_seconds(const CClockProfile* profile) {
+    return (double)(SDL_GetTicks64() - profile->startTicks) / 1000.0;
+}
+
+void profile_set_suspended(CClockProfile* profile, bool suspended) {
+    if (profile->suspended == suspended) return;
+    const uint64_t now = SDL_GetTicks64();
+    if (suspended) {
+        profile->suspendStartTicks = now;
+        profile->suspensions++;
+    }
+    else {
+        profile->suspendedMs += now - profile->suspendStartTicks;
+    }
+    profile->suspended = suspended;
+}
+
+double profile_suspended_seconds(const CClockProfile* profile) {
+    uint64_t ms = profile->suspendedMs;
+    if (profile->suspended) ms += SDL_GetTicks64() - profile->suspendStartTicks;
+    return (double)ms / 1000.0;
+}
+
+double profile_cpu_ms_per_hour(const CClockProfile* profile) {
+    const double elapsed = profile_elapsed_seconds(profile);
+    if (elapsed <= 0.0) return 0.0;
+    const double cpuMs = (profile_cpu_seconds() - profile->startCpuSeconds) * 1000.0;
+    return cpuMs * 3600.0 / elapsed;
+}
+
+void profile_report(const CClockProfile* profile, FILE* out) {
+    const double elapsed = profile_elapsed_seconds(profile);
+    const double minutes = elapsed > 0.0 ? elapsed / 60.0 : 1.0;
+    fprintf(out, "idle profile over %.1fs:\n", elapsed);
+    fprintf(out, "  wakeups/min:      %.1f\n", profile->wakeups / minutes);
+    fprintf(out, "  cpu ms/hour:      %.1f\n", profile_cpu_ms_per_hour(profile));
+    fprintf(out, "  frames presented: %lu\n", profile->framesPresented);
+    fprintf(out, "  frames changed:   %lu\n", profile->framesChanged);
+    fprintf(out, "  suspended:        %.1fs over %lu suspension(s)\n", profile_suspended_seconds(profile), profile->suspensions);
+}
+
+bool profile_within_budget(const CClockProfile* profile, double budgetMsPerHour) {
+    if (budgetMsPerHour <= 0.0) return true;
+    return profile_cpu_ms_per_hour(profile) <= budgetMsPerHour;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Idle cost counters, the clock runs 24/7 so every wakeup and every present counts
+typedef struct {
+    uint64_t startTicks;
+    double startCpuSeconds;
+    unsigned long wakeups;          // returns from the event wait
+    unsigned long framesPresented;  // SDL_RenderPresent calls
+    unsigned long framesChanged;    // presented frames whose text actually changed
+    unsigned long suspensions;      // times rendering was suspended because the window was invisible
+    uint64_t suspendedMs;           // total time spent suspended, not counting the current suspension
+    uint64_t suspendStartTicks;
+    bool suspended;
+} CClockProfile;
+
+// User + kernel CPU time consumed by the process so far
+double profile_cpu_seconds(void);
+
+void profile_begin(CClockProfile* profile);
+
+double profile_elapsed_seconds(const CClockProfile* profile);
+
+// Call on every visible <-> invisible transition, repeated calls with the same state are ignored
+void profile_set_suspended(CClockProfile* profile, bool suspended);
+
+// Includes the ongoing suspension if there is one
+double profile_suspended_seconds(const CClockProfile* profile);
+
+// CPU milliseconds the process would burn in one hour at the measured rate
+double profile_cpu_ms_per_hour(const CClockProfile* profile);
+
+void profile_report(const CClockProfile* profile, FILE* out);
+
+// budgetMsPerHour <= 0 means no budget
+bool profile_within_budget(const CClockProfile* profile, double budgetMsPerHour);
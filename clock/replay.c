@@ -0,0 +1,143 @@
+#include "replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool replay_record_open(CClockReplay* replay, const char* path, int64_t startWallNs) {
+    memset(replay, 0, sizeof(*replay));
+#ifdef _WIN32
+    if (fopen_s(&replay->file, path, "wb") != 0) replay->file = NULL;
+#else
+    replay->file = fopen(path, "wb");
+#endif
+    if (!replay->file) {
+        fprintf(stderr, "replay: cannot create %s\n", path);
+        return false;
+    }
+    replay->header = (CClockReplayHeader){ .magic = REPLAY_MAGIC, .version = REPLAY_VERSION, .startWallNs = startWallNs };
+    if (fwrite(&replay->header, sizeof(replay->header), 1, replay->file) != 1) {
+        fprintf(stderr, "replay: cannot write %s\n", path);
+        fclose(replay->file);
+        replay->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+void replay_record(CClockReplay* replay, uint32_t ms, CClockReplayKind kind, int code, int x, int y) {
+    if (!replay->file) return;
+    const CClockReplayEvent event = { .ms = ms, .kind = (uint16_t)kind, .code = (uint16_t)code, .x = x, .y = y };
+    // Buffered by stdio, a wheel burst costs no system call per notch
+    fwrite(&event, sizeof(event), 1, replay->file);
+    replay->count++;
+}
+
+void replay_record_close(CClockReplay* replay, uint32_t ms) {
+    if (!replay->file) return;
+    replay_record(replay, ms, CCLOCK_REPLAY_END, 0, 0, 0);
+    fclose(replay->file);
+    replay->file = NULL;
+}
+
+bool replay_load(CClockReplay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+    FILE* file = NULL;
+#ifdef _WIN32
+    if (fopen_s(&file, path, "rb") != 0) file = NULL;
+#else
+    file = fopen(path, "rb");
+#endif
+    if (!file) {
+        fprintf(stderr, "replay: cannot open %s\n", path);
+        return false;
+    }
+    bool success = fread(&replay->header, sizeof(replay->header), 1, file) == 1
+        && replay->header.magic == REPLAY_MAGIC && replay->header.version == REPLAY_VERSION;
+    if (!success) fprintf(stderr, "replay: %s is not a version %d recording\n", path, REPLAY_VERSION);
+
+    int capacity = 0;
+    CClockReplayEvent event;
+    // A recording cut short by a crash still replays up to its last complete record
+    while (success && fread(&event, sizeof(event), 1, file) == 1) {
+        if (replay->count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            CClockReplayEvent* events = realloc(replay->events, capacity * sizeof(CClockReplayEvent));
+            if (!events) {
+                success = false;
+                break;
+            }
+            replay->events = events;
+        }
+        if (replay->count > 0 && event.ms < replay->events[replay->count - 1].ms) {
+            fprintf(stderr, "replay: %s has events out of order\n", path);
+            success = false;
+            break;
+        }
+        replay->events[replay->count++] = event;
+    }
+    fclose(file);
+    if (success && replay->count == 0) {
+        fprintf(stderr, "replay: %s has no events\n", path);
+        success = false;
+    }
+    if (!success) replay_free(replay);
+    return success;
+}
+
+const CClockReplayEvent* replay_next_due(CClockReplay* replay, uint32_t ms) {
+    if (replay->next >= replay->count || replay->events[replay->next].ms > ms) return NULL;
+    return &replay->events[replay->next++];
+}
+
+uint32_t replay_next_ms(const CClockReplay* replay) {
+    if (replay->count == 0) return 0;
+    return replay->events[replay->next < replay->count ? replay->next : replay->count - 1].ms;
+}
+
+bool replay_finished(const CClockReplay* replay) {
+    return replay->next >= replay->count;
+}
+
+void replay_free(CClockReplay* replay) {
+    if (replay->file) fclose(replay->file);
+    free(replay->events);
+    memset(replay, 0, sizeof(*replay));
+}
+
+void frame_stats_add(CClockFrameStats* stats, double ms) {
+    if (stats->count == stats->capacity) {
+        const int capacity = stats->capacity ? stats->capacity * 2 : 1024;
+        float* times = realloc(stats->ms, capacity * sizeof(float));
+        if (!times) return;
+        stats->ms = times;
+        stats->capacity = capacity;
+    }
+    stats->ms[stats->count++] = (float)ms;
+}
+
+static int compare_float(const void* a, const void* b) {
+    const float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void frame_stats_report(CClockFrameStats* stats, FILE* out) {
+    if (stats->count == 0) {
+        fprintf(out, "frames: none rendered\n");
+        return;
+    }
+    const int n = stats->count;
+    qsort(stats->ms, n, sizeof(float), compare_float);
+    double total = 0;
+    int slow = 0;
+    for (int i = 0; i < n; ++i) {
+        total += stats->ms[i];
+        if (stats->ms[i] > 1000.0 / 60.0) slow++;
+    }
+    fprintf(out, "frames: %d, mean %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms, %d over 16.7 ms\n",
+        n, total / n, stats->ms[n / 2], stats->ms[n * 95 / 100], stats->ms[n * 99 / 100], stats->ms[n - 1], slow);
+}
+
+void frame_stats_free(CClockFrameStats* stats) {
+    free(stats->ms);
+    memset(stats, 0, sizeof(*stats));
+}
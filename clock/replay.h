@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Input recording for reproducible performance runs. The file is a CClockReplayHeader followed by
+// 16 byte CClockReplayEvent records in host byte order, a header with another magic or version is
+// refused. Replaying starts the clock at the recorded wall time and feeds the events back at their
+// recorded offsets (or as fast as possible), so every frame sees the same input and the same time
+
+#define REPLAY_MAGIC 0x50524343u // "CCRP"
+#define REPLAY_VERSION 1
+
+typedef enum {
+    CCLOCK_REPLAY_WHEEL = 1,        // y: notches, x: thousandths of a notch (trackpads)
+    CCLOCK_REPLAY_MOUSE_MOTION,     // x, y
+    CCLOCK_REPLAY_MOUSE_DOWN,       // code: SDL button, x, y
+    CCLOCK_REPLAY_MOUSE_UP,
+    CCLOCK_REPLAY_WINDOW_MOVED,     // x, y
+    CCLOCK_REPLAY_WINDOW_RESIZED,   // x: width, y: height
+    CCLOCK_REPLAY_COMMAND,          // code: HMENU id
+    CCLOCK_REPLAY_KEY,              // x: SDL keycode
+    CCLOCK_REPLAY_END,              // when the recording stopped
+} CClockReplayKind;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int64_t startWallNs;    // clock time when the recording started
+} CClockReplayHeader;
+
+typedef struct {
+    uint32_t ms;            // real milliseconds since the recording started
+    uint16_t kind;
+    uint16_t code;
+    int32_t x;
+    int32_t y;
+} CClockReplayEvent;
+
+typedef struct {
+    FILE* file;             // recording
+    CClockReplayHeader header;
+    CClockReplayEvent* events; // replaying, the whole file
+    int count;
+    int next;               // first event not replayed yet
+} CClockReplay;
+
+bool replay_record_open(CClockReplay* replay, const char* path, int64_t startWallNs);
+
+void replay_record(CClockReplay* replay, uint32_t ms, CClockReplayKind kind, int code, int x, int y);
+
+// Writes the END record
+void replay_record_close(CClockReplay* replay, uint32_t ms);
+
+bool replay_load(CClockReplay* replay, const char* path);
+
+// The next event due at or before ms, NULL when there is none yet
+const CClockReplayEvent* replay_next_due(CClockReplay* replay, uint32_t ms);
+
+// Offset of the next event, of the last one once all were replayed
+uint32_t replay_next_ms(const CClockReplay* replay);
+
+bool replay_finished(const CClockReplay* replay);
+
+void replay_free(CClockReplay* replay);
+
+// Render times of the replayed frames
+typedef struct {
+    float* ms;
+    int count;
+    int capacity;
+} CClockFrameStats;
+
+void frame_stats_add(CClockFrameStats* stats, double ms);
+
+// Count, mean, percentiles and the frames over one 60 Hz period, sorts the samples
+void frame_stats_report(CClockFrameStats* stats, FILE* out);
+
+void frame_stats_free(CClockFrameStats* stats);
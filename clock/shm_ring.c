@@ -0,0 +1,269 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // shm_open
+#endif
+
+#include "shm_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "monotonic.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Pixels start on their own page
+#define SHM_RING_DATA_ALIGN 4096
+
+SDL_COMPILE_TIME_ASSERT(shm_slot_size, sizeof(CClockShmSlot) == 64);
+SDL_COMPILE_TIME_ASSERT(shm_header_size, sizeof(CClockShmHeader) == 64 + 64 * SHM_RING_SLOTS);
+
+static bool make_name(CClockShmRing* ring, const char* name) {
+    if (!*name || strpbrk(name, "/\\")) {
+        fprintf(stderr, "shm: invalid ring name '%s'\n", name);
+        return false;
+    }
+#ifdef _WIN32
+    SDL_snprintf(ring->name, sizeof(ring->name), "Local\\cclock-%s", name);
+#else
+    SDL_snprintf(ring->name, sizeof(ring->name), "/cclock-%s", name);
+#endif
+    return true;
+}
+
+// Maps size bytes of the named object, size 0 maps an existing object whole
+static bool map_ring(CClockShmRing* ring, size_t size, bool create) {
+#ifdef _WIN32
+    HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, ring->name)
+        : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, ring->name);
+    if (!mapping) return false;
+    if (create && GetLastError() == ERROR_ALREADY_EXISTS) {
+        // Mappings cannot be resized and the other writer still holds this one
+        fprintf(stderr, "shm: ring '%s' is already published by another process\n", ring->name);
+        CloseHandle(mapping);
+        return false;
+    }
+    ring->header = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!ring->header) {
+        CloseHandle(mapping);
+        return false;
+    }
+    ring->mapping = mapping;
+    ring->size = size;
+    return true;
+#else
+    int fd;
+    if (create) {
+        // A fresh object: readers still mapping the previous one keep it alive and simply see no new frames
+        shm_unlink(ring->name);
+        fd = shm_open(ring->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            shm_unlink(ring->name);
+            fd = -1;
+        }
+    }
+    else {
+        fd = shm_open(ring->name, O_RDWR, 0);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0) size = (size_t)st.st_size;
+    }
+    if (fd < 0) return false;
+    // Readers map read-write too: the seqlock loads go through SDL atomics, which may be read-modify-write
+    void* data = size >= sizeof(CClockShmHeader) ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (data == MAP_FAILED) {
+        if (create) shm_unlink(ring->name);
+        return false;
+    }
+    ring->header = data;
+    ring->size = size;
+    return true;
+#endif
+}
+
+bool shm_ring_create(CClockShmRing* ring, const char* name, int width, int height) {
+    memset(ring, 0, sizeof(*ring));
+    if (!make_name(ring, name)) return false;
+
+    const size_t frameBytes = (size_t)width * height * 4;
+    const size_t dataOffset = (sizeof(CClockShmHeader) + SHM_RING_DATA_ALIGN - 1) / SHM_RING_DATA_ALIGN * SHM_RING_DATA_ALIGN;
+    if (width <= 0 || height <= 0 || frameBytes > UINT32_MAX || !map_ring(ring, dataOffset + frameBytes * SHM_RING_SLOTS, true)) {
+        fprintf(stderr, "shm: could not create ring '%s'\n", ring->name);
+        return false;
+    }
+    ring->owner = true;
+
+    CClockShmHeader* header = ring->header;
+    memset(header, 0, sizeof(*header));
+    header->version = SHM_RING_VERSION;
+    header->width = (uint32_t)width;
+    header->height = (uint32_t)height;
+    header->stride = (uint32_t)width * 4;
+    header->slotCount = SHM_RING_SLOTS;
+    header->frameBytes = (uint32_t)frameBytes;
+    header->dataOffset = (uint32_t)dataOffset;
+    // Last, readers check it before trusting anything else
+    SDL_MemoryBarrierRelease();
+    header->magic = SHM_RING_MAGIC;
+    return true;
+}
+
+bool shm_ring_open(CClockShmRing* ring, const char* name) {
+    memset(ring, 0, sizeof(*ring));
+    if (!make_name(ring, name)) return false;
+    if (!map_ring(ring, 0, false)) {
+        fprintf(stderr, "shm: ring '%s' not found, is cclock running with --export shm:%s?\n", ring->name, name);
+        return false;
+    }
+
+    const CClockShmHeader* header = ring->header;
+    SDL_MemoryBarrierAcquire();
+    // On Windows the view size is only known through the header
+    const size_t size = ring->size ? ring->size : (size_t)header->dataOffset + (size_t)header->frameBytes * header->slotCount;
+    if (header->magic != SHM_RING_MAGIC || header->version != SHM_RING_VERSION || header->slotCount != SHM_RING_SLOTS
+        || (size_t)header->dataOffset + (size_t)header->frameBytes * header->slotCount > size) {
+        fprintf(stderr, "shm: ring '%s' has an unknown layout\n", ring->name);
+        shm_ring_close(ring);
+        return false;
+    }
+    return true;
+}
+
+void shm_ring_close(CClockShmRing* ring) {
+    if (!ring->header) return;
+#ifdef _WIN32
+    UnmapViewOfFile(ring->header);
+    CloseHandle(ring->mapping);
+#else
+    munmap(ring->header, ring->size);
+    if (ring->owner) shm_unlink(ring->name);
+#endif
+    ring->header = NULL;
+}
+
+static uint8_t* slot_pixels(const CClockShmRing* ring, int slot) {
+    return (uint8_t*)ring->header + ring->header->dataOffset + (size_t)slot * ring->header->frameBytes;
+}
+
+uint8_t* shm_ring_begin_write(CClockShmRing* ring, uint64_t captureNs) {
+    CClockShmHeader* header = ring->header;
+    // Frame 0 means "nothing published yet"
+    if (++ring->writing == 0) ring->writing = 1;
+    const int slot = ring->writing % SHM_RING_SLOTS;
+    CClockShmSlot* s = &header->slots[slot];
+    SDL_AtomicAdd(&s->sequence, 1); // odd: readers of this slot will retry
+    s->frame = ring->writing;
+    s->captureNs = captureNs;
+    return slot_pixels(ring, slot);
+}
+
+void shm_ring_publish(CClockShmRing* ring) {
+    CClockShmHeader* header = ring->header;
+    CClockShmSlot* s = &header->slots[ring->writing % SHM_RING_SLOTS];
+    s->publishNs = monotonic_ns();
+    SDL_AtomicAdd(&s->sequence, 1); // even again, full barrier: the pixels are visible before it
+    SDL_AtomicSet(&header->latest, (int)ring->writing);
+}
+
+bool shm_ring_begin_read(const CClockShmRing* ring, uint32_t lastFrame, CClockShmFrame* frame) {
+    CClockShmHeader* header = ring->header;
+    const uint32_t latest = (uint32_t)SDL_AtomicGet(&header->latest);
+    if (latest == 0 || latest == lastFrame) return false;
+
+    frame->slot = latest % SHM_RING_SLOTS;
+    CClockShmSlot* s = &header->slots[frame->slot];
+    frame->sequence = (uint32_t)SDL_AtomicGet(&s->sequence);
+    if (frame->sequence & 1) return false; // lapped by the writer already, the next call sees a newer latest
+    frame->frame = s->frame;
+    frame->captureNs = s->captureNs;
+    frame->publishNs = s->publishNs;
+    frame->pixels = slot_pixels(ring, frame->slot);
+    return frame->frame == latest;
+}
+
+bool shm_ring_end_read(const CClockShmRing* ring, const CClockShmFrame* frame) {
+    SDL_MemoryBarrierAcquire();
+    return (uint32_t)SDL_AtomicGet(&ring->header->slots[frame->slot].sequence) == frame->sequence;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+int shm_ring_latency_run(const char* name, long frames) {
+    CClockShmRing ring;
+    if (!shm_ring_open(&ring, name)) return 1;
+    if (frames <= 0) frames = 300;
+
+    uint64_t* captureLatency = malloc(sizeof(uint64_t) * frames);
+    uint64_t* publishLatency = malloc(sizeof(uint64_t) * frames);
+    if (!captureLatency || !publishLatency) {
+        free(captureLatency);
+        free(publishLatency);
+        shm_ring_close(&ring);
+        return 1;
+    }
+
+    printf("Reading %ux%u frames from %s\n", ring.header->width, ring.header->height, ring.name);
+    long count = 0;
+    unsigned long torn = 0, skipped = 0;
+    uint32_t lastFrame = 0;
+    uint64_t lastSeenNs = monotonic_ns();
+    while (count < frames) {
+        CClockShmFrame frame;
+        if (!shm_ring_begin_read(&ring, lastFrame, &frame)) {
+            // Polling only yields, a real consumer would read once per own frame instead
+            if (monotonic_ns() - lastSeenNs > 2000000000u) {
+                fprintf(stderr, "shm: no new frame for 2 seconds, writer gone?\n");
+                break;
+            }
+            SDL_Delay(0);
+            continue;
+        }
+        const uint64_t seenNs = monotonic_ns();
+
+        // Stand in for a consumer: touch one row of the frame in place
+        unsigned alpha = 0;
+        const uint8_t* row = frame.pixels + (size_t)ring.header->stride * (ring.header->height / 2);
+        for (uint32_t x = 0; x < ring.header->width; ++x) alpha += row[x * 4 + 3];
+        (void)alpha;
+
+        if (!shm_ring_end_read(&ring, &frame)) {
+            torn++;
+            continue;
+        }
+        if (lastFrame && frame.frame > lastFrame + 1) skipped += frame.frame - lastFrame - 1;
+        lastFrame = frame.frame;
+        lastSeenNs = seenNs;
+        captureLatency[count] = seenNs - frame.captureNs;
+        publishLatency[count] = seenNs - frame.publishNs;
+        count++;
+    }
+
+    if (count > 0) {
+        qsort(captureLatency, count, sizeof(uint64_t), compare_u64);
+        qsort(publishLatency, count, sizeof(uint64_t), compare_u64);
+        printf("%ld frames, %lu skipped, %lu torn reads retried\n", count, skipped, torn);
+        printf("capture -> read: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+            captureLatency[count / 2] / 1000.0, captureLatency[count * 99 / 100] / 1000.0, captureLatency[count - 1] / 1000.0);
+        printf("publish -> read: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+            publishLatency[count / 2] / 1000.0, publishLatency[count * 99 / 100] / 1000.0, publishLatency[count - 1] / 1000.0);
+    }
+    free(captureLatency);
+    free(publishLatency);
+    shm_ring_close(&ring);
+    return count > 0 ? 0 : 1;
+}
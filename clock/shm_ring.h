@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL_atomic.h>
+
+// Frame ring in named shared memory ("/cclock-<name>" with shm_open, "Local\cclock-<name>" file mapping
+// on Windows) so other processes on the host can read the latest frame in place. Every slot is a
+// seqlock: the writer makes its sequence odd while it fills the slot, readers retry when it changed
+// under them, so the writer never waits for anybody
+
+#define SHM_RING_MAGIC 0x474E5243u // "CRNG"
+#define SHM_RING_VERSION 1
+#define SHM_RING_SLOTS 4
+
+typedef struct {
+    SDL_atomic_t sequence;  // odd while the slot is written
+    uint32_t frame;         // frame number, starts at 1
+    uint64_t captureNs;     // monotonic_ns() when the clock time of the frame was sampled
+    uint64_t publishNs;     // monotonic_ns() when the pixels were complete
+    uint8_t padding[40];    // one cache line per slot
+} CClockShmSlot;
+
+// Layout of the mapping, the pixels of slot i start at dataOffset + i * frameBytes
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t slotCount;
+    uint32_t frameBytes;
+    uint32_t dataOffset;
+    SDL_atomic_t latest;    // frame number of the newest complete frame, 0 before the first one
+    uint8_t padding[28];
+    CClockShmSlot slots[SHM_RING_SLOTS];
+} CClockShmHeader;
+
+typedef struct {
+    CClockShmHeader* header;
+    size_t size;
+    bool owner;
+    uint32_t writing;       // frame between shm_ring_begin_write and shm_ring_publish
+    char name[64];
+#ifdef _WIN32
+    void* mapping;
+#endif
+} CClockShmRing;
+
+// Creates or resizes the ring, the header is reset so readers start from frame 0 again
+bool shm_ring_create(CClockShmRing* ring, const char* name, int width, int height);
+
+// Maps an existing ring, fails if it was not created or has an unknown layout
+bool shm_ring_open(CClockShmRing* ring, const char* name);
+
+// The owner also removes the name
+void shm_ring_close(CClockShmRing* ring);
+
+// Writer side: returns the pixels of the next slot, which stay odd until shm_ring_publish
+uint8_t* shm_ring_begin_write(CClockShmRing* ring, uint64_t captureNs);
+void shm_ring_publish(CClockShmRing* ring);
+
+// Reader side: pixels of the newest frame, used in place. NULL when there is no frame newer than
+// lastFrame. The frame is only valid if shm_ring_end_read returns true afterwards
+typedef struct {
+    const uint8_t* pixels;
+    uint32_t frame;
+    uint32_t sequence;
+    uint64_t captureNs;
+    uint64_t publishNs;
+    int slot;
+} CClockShmFrame;
+
+bool shm_ring_begin_read(const CClockShmRing* ring, uint32_t lastFrame, CClockShmFrame* frame);
+bool shm_ring_end_read(const CClockShmRing* ring, const CClockShmFrame* frame);
+
+// --shm-read: consumes frames of another cclock and prints the capture -> read latency, returns the exit code
+int shm_ring_latency_run(const char* name, long frames);
@@ -0,0 +1,176 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "skin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "soak_track.h"
+
+#define SKIN_LINE_LENGTH 320
+
+static FILE* open_manifest(const char* dir) {
+    char path[300];
+    SDL_snprintf(path, sizeof(path), "%s/%s", dir, SKIN_MANIFEST);
+    FILE* f = NULL;
+#ifdef _WIN32
+    fopen_s(&f, path, "r");
+#else
+    f = fopen(path, "r");
+#endif
+    return f;
+}
+
+// BMPs usually have no alpha: converted opaque, then the color key (if any) is made transparent
+static SDL_Surface* load_image(const char* dir, const char* file, bool hasKey, Uint32 key) {
+    char path[600];
+    SDL_snprintf(path, sizeof(path), "%s/%s", dir, file);
+    SDL_Surface* loaded = SDL_LoadBMP(path);
+    if (!loaded) {
+        fprintf(stderr, "skin: could not load '%s': %s\n", path, SDL_GetError());
+        return NULL;
+    }
+    SDL_Surface* image = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    if (!image) {
+        fprintf(stderr, "skin: could not convert '%s': %s\n", path, SDL_GetError());
+        return NULL;
+    }
+    if (hasKey) {
+        SDL_LockSurface(image);
+        for (int y = 0; y < image->h; ++y) {
+            Uint32* row = (Uint32*)((Uint8*)image->pixels + y * image->pitch);
+            for (int x = 0; x < image->w; ++x) {
+                if ((row[x] & 0x00FFFFFF) == key) row[x] = 0;
+            }
+        }
+        SDL_UnlockSurface(image);
+    }
+    return image;
+}
+
+static void trim_line(char* line) {
+    size_t len = strlen(line);
+    while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == ' ')) line[--len] = '\0';
+}
+
+bool skin_load(CClockSkin* skin, const char* dir) {
+    memset(skin, 0, sizeof(*skin));
+    SDL_strlcpy(skin->dir, dir, sizeof(skin->dir));
+    SDL_strlcpy(skin->name, dir, sizeof(skin->name));
+
+    FILE* f = open_manifest(dir);
+    if (!f) {
+        fprintf(stderr, "skin: no %s in '%s'\n", SKIN_MANIFEST, dir);
+        return false;
+    }
+
+    bool success = true;
+    bool hasKey = false;
+    Uint32 key = 0;
+    char line[SKIN_LINE_LENGTH];
+    while (success && fgets(line, sizeof(line), f)) {
+        trim_line(line);
+        if (line[0] == '#' || line[0] == '\0') continue;
+
+        if (strncmp(line, "name=", 5) == 0) {
+            SDL_strlcpy(skin->name, line + 5, sizeof(skin->name));
+        }
+        else if (strncmp(line, "tint=", 5) == 0) {
+            skin->tint = atoi(line + 5) != 0;
+        }
+        else if (strncmp(line, "transparent=", 12) == 0) {
+            int r, g, b;
+            hasKey = SDL_sscanf(line + 12, "%d,%d,%d", &r, &g, &b) == 3;
+            key = ((Uint32)(r & 0xFF) << 16) | ((Uint32)(g & 0xFF) << 8) | (Uint32)(b & 0xFF);
+        }
+        else if (strncmp(line, "glyph=", 6) == 0 && line[6] && line[7] == '|') {
+            // glyph=<char>|<file>[|<advance>]
+            const int ch = (unsigned char)line[6];
+            char* file = line + 8;
+            char* advance = strchr(file, '|');
+            if (advance) *advance++ = '\0';
+            if (ch < 32 || ch >= GLYPH_ATLAS_CHAR_COUNT || skin->images.surfaces[ch]) {
+                fprintf(stderr, "skin: ignoring glyph '%c' in '%s'\n", ch, dir);
+                continue;
+            }
+            SDL_Surface* image = load_image(dir, file, hasKey, key);
+            if (!image) {
+                success = false;
+                break;
+            }
+            skin->images.surfaces[ch] = image;
+            skin->images.metrics.advances[ch] = advance ? atoi(advance) : image->w;
+            if (image->h > skin->images.metrics.lineHeight) skin->images.metrics.lineHeight = image->h;
+        }
+        else {
+            fprintf(stderr, "skin: unknown line '%s' in '%s'\n", line, dir);
+        }
+    }
+    fclose(f);
+
+    for (const char* c = SKIN_REQUIRED_CHARSET; success && *c; ++c) {
+        if (!skin->images.surfaces[(unsigned char)*c]) {
+            fprintf(stderr, "skin: '%s' has no glyph for '%c'\n", dir, *c);
+            success = false;
+        }
+    }
+    if (!success) skin_free(skin);
+    return success;
+}
+
+void skin_free(CClockSkin* skin) {
+    for (int ch = 0; ch < GLYPH_ATLAS_CHAR_COUNT; ++ch) {
+        SDL_FreeSurface(skin->images.surfaces[ch]);
+    }
+    memset(skin, 0, sizeof(*skin));
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp((const char*)a, (const char*)b);
+}
+
+static bool has_manifest(const char* root, const char* name) {
+    char dir[260];
+    SDL_snprintf(dir, sizeof(dir), "%s/%s", root, name);
+    FILE* f = open_manifest(dir);
+    if (f) fclose(f);
+    return f != NULL;
+}
+
+int skin_list(const char* root, char (*names)[64], int maxNames) {
+    int count = 0;
+#ifdef _WIN32
+    char pattern[260];
+    SDL_snprintf(pattern, sizeof(pattern), "%s\\*", root);
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) return 0;
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || data.cFileName[0] == '.') continue;
+        if (count < maxNames && has_manifest(root, data.cFileName)) SDL_strlcpy(names[count++], data.cFileName, 64);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* d = opendir(root);
+    if (!d) return 0;
+    for (struct dirent* entry = readdir(d); entry; entry = readdir(d)) {
+        if (entry->d_name[0] == '.') continue;
+        if (count < maxNames && has_manifest(root, entry->d_name)) SDL_strlcpy(names[count++], entry->d_name, 64);
+    }
+    closedir(d);
+#endif
+    qsort(names, count, 64, compare_names);
+    return count;
+}
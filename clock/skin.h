@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "glyph_atlas.h"
+
+// Skin packs replace the digits of digital-mono.ttf with images. A skin is a directory holding
+// BMP files and a skin.ini manifest:
+//
+//   name=Nixie
+//   tint=0                   1: images are white and take the clock color, 0: drawn as is
+//   transparent=255,0,255    optional color key for BMPs without alpha
+//   glyph=0|zero.bmp         one line per character, '0'-'9' and ':' are required
+//   glyph=:|colon.bmp|40     optional advance in pixels, the image width otherwise
+
+#define SKIN_ROOT "skins"
+#define SKIN_MANIFEST "skin.ini"
+#define SKIN_REQUIRED_CHARSET "0123456789:"
+#define SKIN_MAX_LISTED 16
+
+typedef struct {
+    char dir[260];
+    char name[64];
+    bool tint;
+    CClockGlyphImages images;   // the atlas face, advances ready for the text size computations
+} CClockSkin;
+
+// Loads every image of the manifest as ARGB8888, false (with a message) if anything is missing
+bool skin_load(CClockSkin* skin, const char* dir);
+
+void skin_free(CClockSkin* skin);
+
+// Directory names under root holding a manifest, sorted, returns how many
+int skin_list(const char* root, char (*names)[64], int maxNames);
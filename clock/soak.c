@@ -0,0 +1,125 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // sysconf, opendir
+#endif
+
+#include "soak.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#include "soak_track.h"
+
+static SDL_atomic_t g_liveTextures;
+static SDL_atomic_t g_liveSurfaces;
+
+SDL_Texture* soak_track_texture(SDL_Texture* texture) {
+    if (texture) SDL_AtomicAdd(&g_liveTextures, 1);
+    return texture;
+}
+
+void soak_track_destroy_texture(SDL_Texture* texture) {
+    if (texture) SDL_AtomicAdd(&g_liveTextures, -1);
+    (SDL_DestroyTexture)(texture);
+}
+
+SDL_Surface* soak_track_surface(SDL_Surface* surface) {
+    if (surface) SDL_AtomicAdd(&g_liveSurfaces, 1);
+    return surface;
+}
+
+void soak_track_free_surface(SDL_Surface* surface) {
+    // A surface with other references is only released, not freed
+    if (surface && surface->refcount == 1 && !(surface->flags & SDL_DONTFREE)) SDL_AtomicAdd(&g_liveSurfaces, -1);
+    (SDL_FreeSurface)(surface);
+}
+
+int soak_track_live_textures(void) {
+    return SDL_AtomicGet(&g_liveTextures);
+}
+
+int soak_track_live_surfaces(void) {
+    return SDL_AtomicGet(&g_liveSurfaces);
+}
+
+void soak_sample_process(CClockSoakSample* sample) {
+    sample->textures = soak_track_live_textures();
+    sample->surfaces = soak_track_live_surfaces();
+    sample->sdlAllocations = SDL_GetNumAllocations();
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = { .cb = sizeof(counters) };
+    // The K32 entry point lives in kernel32, no psapi.lib needed
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) sample->rssBytes = counters.WorkingSetSize;
+    DWORD handles = 0;
+    GetProcessHandleCount(GetCurrentProcess(), &handles);
+    sample->handles = handles + GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS) + GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS);
+#else
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0, residentPages = 0;
+    if (f) {
+        if (fscanf(f, "%lu %lu", &pages, &residentPages) != 2) residentPages = 0;
+        fclose(f);
+    }
+    sample->rssBytes = (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE);
+    sample->handles = 0;
+    DIR* fds = opendir("/proc/self/fd");
+    if (fds) {
+        for (struct dirent* entry = readdir(fds); entry; entry = readdir(fds)) {
+            if (entry->d_name[0] != '.') sample->handles++;
+        }
+        closedir(fds);
+    }
+#endif
+}
+
+static void take_max(CClockSoakSample* max, const CClockSoakSample* sample) {
+    if (sample->rssBytes > max->rssBytes) max->rssBytes = sample->rssBytes;
+    if (sample->handles > max->handles) max->handles = sample->handles;
+    if (sample->textures > max->textures) max->textures = sample->textures;
+    if (sample->surfaces > max->surfaces) max->surfaces = sample->surfaces;
+    if (sample->sdlAllocations > max->sdlAllocations) max->sdlAllocations = sample->sdlAllocations;
+    if (sample->glyphCacheBytes > max->glyphCacheBytes) max->glyphCacheBytes = sample->glyphCacheBytes;
+}
+
+bool soak_record(CClockSoak* soak, const CClockSoakSample* sample, double hours, FILE* out) {
+    soak->samples++;
+    const bool warmup = hours <= soak->cycleHours;
+    bool ok = true;
+    if (warmup) {
+        take_max(&soak->baseline, sample);
+    }
+    else {
+        take_max(&soak->peak, sample);
+        // Caches are bounded: the same script cycle must not need more textures, surfaces or glyphs than the first
+        ok = sample->rssBytes <= soak->baseline.rssBytes + soak->rssToleranceBytes
+            && sample->handles <= soak->baseline.handles + soak->handleTolerance
+            && sample->textures <= soak->baseline.textures
+            && sample->surfaces <= soak->baseline.surfaces
+            && sample->sdlAllocations <= soak->baseline.sdlAllocations + soak->allocationTolerance
+            && sample->glyphCacheBytes <= soak->baseline.glyphCacheBytes;
+        if (!ok) soak->failures++;
+    }
+    fprintf(out, "soak day=%.2f rss_kb=%zu handles=%lu textures=%d surfaces=%d sdl_allocs=%d glyph_kb=%zu%s\n", hours / 24.0,
+        sample->rssBytes / 1024, sample->handles, sample->textures, sample->surfaces, sample->sdlAllocations, sample->glyphCacheBytes / 1024,
+        warmup ? " (warm-up)" : ok ? "" : " OVER BASELINE");
+    return ok;
+}
+
+bool soak_report(const CClockSoak* soak, FILE* out) {
+    fprintf(out, "soak %.1f days, %lu samples: rss_kb %zu -> %zu (tolerance %zu), handles %lu -> %lu, textures %d -> %d, surfaces %d -> %d, sdl_allocs %d -> %d (tolerance %d), glyph_kb %zu -> %zu, %lu over baseline\n",
+        soak->days, soak->samples,
+        soak->baseline.rssBytes / 1024, soak->peak.rssBytes / 1024, soak->rssToleranceBytes / 1024,
+        soak->baseline.handles, soak->peak.handles,
+        soak->baseline.textures, soak->peak.textures,
+        soak->baseline.surfaces, soak->peak.surfaces,
+        soak->baseline.sdlAllocations, soak->peak.sdlAllocations, soak->allocationTolerance,
+        soak->baseline.glyphCacheBytes / 1024, soak->peak.glyphCacheBytes / 1024,
+        soak->failures);
+    return soak->failures == 0 && soak->samples > 0;
+}
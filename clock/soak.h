@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Long run leak check: the window loop runs weeks of clock time on a stepped time source while a
+// script switches modes, scales and timers. Resources are sampled every few simulated hours, the
+// first script cycle sets the baseline and any later growth past the tolerance fails the run
+
+typedef struct {
+    size_t rssBytes;
+    unsigned long handles;      // kernel + GDI handles on Windows, open descriptors elsewhere
+    int textures;               // SDL textures created and not destroyed (soak_track.h)
+    int surfaces;               // SDL surfaces created and not freed, same
+    int sdlAllocations;         // live SDL_malloc blocks: SDL and SDL_ttf's glyph caches. FreeType's own heap only shows in the RSS
+    size_t glyphCacheBytes;     // rasterized glyphs held by the atlas pages, text caches and compositor coverage
+} CClockSoakSample;
+
+typedef struct {
+    double days;                // simulated days to run
+    double cycleHours;          // one pass of the script, the first one is the warm-up
+    size_t rssToleranceBytes;
+    unsigned long handleTolerance;
+    int allocationTolerance;
+    CClockSoakSample baseline;  // maxima over the warm-up cycle
+    CClockSoakSample peak;      // maxima after it
+    unsigned long samples;
+    unsigned long failures;
+} CClockSoak;
+
+// RSS, handles, live textures, surfaces and SDL allocations of the process, glyphCacheBytes is left alone
+void soak_sample_process(CClockSoakSample* sample);
+
+// Records a sample taken `hours` into the run and prints it. Returns false when it is over the baseline
+bool soak_record(CClockSoak* soak, const CClockSoakSample* sample, double hours, FILE* out);
+
+// Final line, true when no sample failed
+bool soak_report(const CClockSoak* soak, FILE* out);
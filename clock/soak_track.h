@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+// Every texture and surface the clock makes or frees goes through these counters, so --soak sees the real
+// lifetimes and not only what the caches hold. Included last by each file that creates or frees them.
+// Calls written as (SDL_FreeSurface)(surface) skip the macros, soak.c uses that for the real ones
+
+SDL_Texture* soak_track_texture(SDL_Texture* texture);
+void soak_track_destroy_texture(SDL_Texture* texture);
+SDL_Surface* soak_track_surface(SDL_Surface* surface);
+void soak_track_free_surface(SDL_Surface* surface);
+
+// Textures and surfaces created and not yet freed
+int soak_track_live_textures(void);
+int soak_track_live_surfaces(void);
+
+#define SDL_CreateTexture(...) soak_track_texture(SDL_CreateTexture(__VA_ARGS__))
+#define SDL_CreateTextureFromSurface(...) soak_track_texture(SDL_CreateTextureFromSurface(__VA_ARGS__))
+#define SDL_DestroyTexture(texture) soak_track_destroy_texture(texture)
+
+#define SDL_CreateRGBSurface(...) soak_track_surface(SDL_CreateRGBSurface(__VA_ARGS__))
+#define SDL_CreateRGBSurfaceWithFormat(...) soak_track_surface(SDL_CreateRGBSurfaceWithFormat(__VA_ARGS__))
+#define SDL_ConvertSurface(...) soak_track_surface(SDL_ConvertSurface(__VA_ARGS__))
+#define SDL_ConvertSurfaceFormat(...) soak_track_surface(SDL_ConvertSurfaceFormat(__VA_ARGS__))
+#define SDL_LoadBMP_RW(...) soak_track_surface(SDL_LoadBMP_RW(__VA_ARGS__))
+#define TTF_RenderGlyph_Solid(...) soak_track_surface(TTF_RenderGlyph_Solid(__VA_ARGS__))
+#define TTF_RenderGlyph_Blended(...) soak_track_surface(TTF_RenderGlyph_Blended(__VA_ARGS__))
+#define TTF_RenderText_Solid(...) soak_track_surface(TTF_RenderText_Solid(__VA_ARGS__))
+#define TTF_RenderText_Blended(...) soak_track_surface(TTF_RenderText_Blended(__VA_ARGS__))
+#define SDL_FreeSurface(surface) soak_track_free_surface(surface)
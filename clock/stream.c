@@ -0,0 +1,175 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // clock_nanosleep
+#endif
+
+#include "stream.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+#define NS_PER_SECOND 1000000000LL
+// Windows FILETIME: 100 ns units since 1601
+#define FILETIME_UNIX_EPOCH 116444736000000000LL
+#define STREAM_MAX_FIRED 4
+
+static volatile sig_atomic_t g_streamStop = 0;
+
+static void stream_on_stop(int sig) {
+    (void)sig;
+    g_streamStop = 1;
+}
+
+static int64_t wall_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (int64_t)ts.tv_sec * NS_PER_SECOND + ts.tv_nsec;
+}
+
+// Sleeps until the wall clock reaches deadlineNs. Absolute: the time spent formatting and writing the
+// previous line, a late wakeup or a wall clock step are not added to the next wait. May return early
+// (signal), the caller checks the time again
+#ifdef _WIN32
+static void wait_until(HANDLE timer, const CClockTimeSource* source, int64_t deadlineNs) {
+    if (source->kind != CCLOCK_TIME_REAL || !timer) {
+        const int64_t wallMs = (deadlineNs - time_source_now_ns(source) + 999999) / 1000000;
+        Sleep(time_source_real_ms(source, wallMs, 1000));
+        return;
+    }
+    // A positive due time is absolute, in UTC
+    LARGE_INTEGER due;
+    due.QuadPart = deadlineNs / 100 + FILETIME_UNIX_EPOCH;
+    if (SetWaitableTimer(timer, &due, 0, NULL, NULL, FALSE)) WaitForSingleObject(timer, INFINITE);
+}
+#else
+static void wait_until(const CClockTimeSource* source, int64_t deadlineNs) {
+    if (source->kind != CCLOCK_TIME_REAL) {
+        // Accelerated and scripted sources: their wall time has no kernel clock, wait the real equivalent
+        const int64_t wallMs = (deadlineNs - time_source_now_ns(source) + 999999) / 1000000;
+        const uint32_t ms = time_source_real_ms(source, wallMs, 1000);
+        const struct timespec wait = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000 };
+        nanosleep(&wait, NULL);
+        return;
+    }
+    const struct timespec deadline = { .tv_sec = (time_t)(deadlineNs / NS_PER_SECOND), .tv_nsec = (long)(deadlineNs % NS_PER_SECOND) };
+    clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &deadline, NULL);
+}
+#endif
+
+static size_t json_escape(char* out, size_t size, const char* text) {
+    size_t length = 0;
+    for (const char* c = text; *c && length + 7 < size; ++c) {
+        const unsigned char ch = (unsigned char)*c;
+        if (ch == '"' || ch == '\\') {
+            out[length++] = '\\';
+            out[length++] = (char)ch;
+        }
+        else if (ch < 0x20) length += (size_t)snprintf(out + length, size - length, "\\u%04x", ch);
+        else out[length++] = (char)ch;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+static void write_tick(FILE* out, const CClockStreamOptions* options, const CClockEngine* engine, const CClockSnapshot* now, const CClockText* text) {
+    const bool chrono = engine->mode == CCLOCK_CHRONO;
+    if (!options->json) {
+        fprintf(out, "%s | %s\n", text->timeStr, chrono ? (text->alert ? "Timer done" : "Timer") : text->dateStr);
+    }
+    else {
+        char time[2 * FORMAT_MAX_TEXT], date[2 * FORMAT_MAX_TEXT];
+        json_escape(time, sizeof(time), text->timeStr);
+        json_escape(date, sizeof(date), text->dateStr);
+        if (chrono) {
+            fprintf(out, "{\"event\":\"chrono\",\"epoch\":%lld,\"time\":\"%s\",\"left\":%ld,\"done\":%s}\n",
+                (long long)now->now, time, text->chronoLeft, text->alert ? "true" : "false");
+        }
+        else fprintf(out, "{\"event\":\"tick\",\"epoch\":%lld,\"time\":\"%s\",\"date\":\"%s\"}\n", (long long)now->now, time, date);
+    }
+}
+
+static void write_alarm(FILE* out, const CClockStreamOptions* options, const CClockSnapshot* now, const CClockAlarm* alarm) {
+    const char* label = alarm->label[0] ? alarm->label : "Alarm";
+    if (!options->json) {
+        fprintf(out, "alarm | %s\n", label);
+        return;
+    }
+    char escaped[2 * ALARM_LABEL_LENGTH];
+    json_escape(escaped, sizeof(escaped), label);
+    fprintf(out, "{\"event\":\"alarm\",\"epoch\":%lld,\"label\":\"%s\"}\n", (long long)now->now, escaped);
+}
+
+int stream_run(CClockEngine* engine, CClockAlarms* alarms, const CClockStreamOptions* options, FILE* out, CClockStreamStats* stats) {
+    const int64_t startNs = wall_ns();
+    memset(stats, 0, sizeof(*stats));
+    g_streamStop = 0;
+    signal(SIGINT, stream_on_stop);
+    signal(SIGTERM, stream_on_stop);
+#ifdef _WIN32
+    // High resolution timers (Windows 10 1803+) wake within a millisecond instead of the 15.6 ms tick
+    HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!timer) timer = CreateWaitableTimerW(NULL, TRUE, NULL);
+#endif
+
+    CClockSnapshot now;
+    cclock_snapshot(engine, &now);
+    if (options->chronoSeconds > 0) cclock_chrono_start(engine, &now, options->chronoSeconds);
+
+    double lateUsSum = 0;
+    unsigned long lateCount = 0;
+    for (bool first = true; !g_streamStop; first = false) {
+        if (!first) {
+            const time_t tickSecond = now.now;
+            const int64_t deadlineNs = ((int64_t)tickSecond + 1) * NS_PER_SECOND;
+#ifdef _WIN32
+            wait_until(timer, engine->time, deadlineNs);
+#else
+            wait_until(engine->time, deadlineNs);
+#endif
+            cclock_snapshot(engine, &now);
+            // Early (signal, accelerated source rounding): same deadline again
+            if (now.now == tickSecond) continue;
+            if (engine->time->kind == CCLOCK_TIME_REAL && now.now == tickSecond + 1) {
+                const double lateUs = (double)(now.nowNs - deadlineNs) / 1000.0;
+                if (lateUs > stats->maxLateUs) stats->maxLateUs = lateUs;
+                lateUsSum += lateUs;
+                lateCount++;
+            }
+        }
+
+        int fired[STREAM_MAX_FIRED];
+        const int firedCount = alarms ? alarms_fire_due(alarms, now.now, fired, STREAM_MAX_FIRED) : 0;
+        // Only the first STREAM_MAX_FIRED indices are stored, the rest is a count
+        const int listed = firedCount < STREAM_MAX_FIRED ? firedCount : STREAM_MAX_FIRED;
+        for (int i = 0; i < listed; ++i) write_alarm(out, options, &now, &alarms->alarms[fired[i]]);
+        if (firedCount > listed) {
+            if (options->json) fprintf(out, "{\"event\":\"alarm\",\"epoch\":%lld,\"more\":%d}\n", (long long)now.now, firedCount - listed);
+            else fprintf(out, "alarm | +%d more\n", firedCount - listed);
+        }
+        stats->alarms += (unsigned long)firedCount;
+
+        CClockText text;
+        cclock_build_text(engine, &now, NULL, &text);
+        write_tick(out, options, engine, &now, &text);
+        // A line is only useful to a pipe once it is out
+        fflush(out);
+        if (first) stats->startupUs = (double)(wall_ns() - startNs) / 1000.0;
+        stats->ticks++;
+
+        if (options->count > 0 && stats->ticks >= (unsigned long)options->count) break;
+        if (engine->mode == CCLOCK_CHRONO && text.alert) break;
+    }
+
+#ifdef _WIN32
+    if (timer) CloseHandle(timer);
+#endif
+    stats->meanLateUs = lateCount ? lateUsSum / lateCount : 0;
+    return 0;
+}
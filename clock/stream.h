@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "alarm.h"
+#include "cclock.h"
+
+// Headless tick stream for scripts: one line per second written right at the second boundary, plus a
+// line per alarm, as plain text or JSON. No SDL, window or font: the clock engine, the alarm heap and
+// absolute deadlines (clock_nanosleep TIMER_ABSTIME, a waitable timer on Windows) so a run of days
+// does not drift from the wall clock, whatever the time a line takes to go out
+
+typedef struct {
+    bool json;              // one JSON object per line instead of "time | date"
+    long chronoSeconds;     // > 0: count down that long, the stream ends with the countdown
+    long count;             // > 0: stop after that many ticks
+} CClockStreamOptions;
+
+typedef struct {
+    unsigned long ticks;
+    unsigned long alarms;
+    double startupUs;       // from stream_run to the first line out
+    double maxLateUs;       // wakeup after the boundary it waited for, real time sources only
+    double meanLateUs;
+} CClockStreamStats;
+
+// Runs until Ctrl+C, the end of the countdown or options->count ticks, the first line goes out at once.
+// Returns the process exit code
+int stream_run(CClockEngine* engine, CClockAlarms* alarms, const CClockStreamOptions* options, FILE* out, CClockStreamStats* stats);
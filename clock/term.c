@@ -0,0 +1,377 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // nanosleep
+#endif
+
+#include "term.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+// Wake a little after the boundary like the window does, and at least this often to notice a resize
+// where there is no SIGWINCH
+#define TERM_TICK_SLACK_MS 2
+#define TERM_MAX_WAIT_MS 1000
+#define TERM_DIGIT_ADVANCE (TERM_DIGIT_WIDTH + 1)
+#define TERM_NARROW_ADVANCE 2
+
+enum {
+    SEG_A = 1 << 0,     // top
+    SEG_B = 1 << 1,     // top right
+    SEG_C = 1 << 2,     // bottom right
+    SEG_D = 1 << 3,     // bottom
+    SEG_E = 1 << 4,     // bottom left
+    SEG_F = 1 << 5,     // top left
+    SEG_G = 1 << 6,     // middle
+};
+
+static const uint8_t g_digitSegments[10] = {
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,
+    SEG_B | SEG_C,
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,
+    SEG_B | SEG_C | SEG_F | SEG_G,
+    SEG_A | SEG_C | SEG_D | SEG_F | SEG_G,
+    SEG_A | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,
+    SEG_A | SEG_B | SEG_C,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,
+};
+
+static volatile sig_atomic_t g_termStop = 0;
+static volatile sig_atomic_t g_termResized = 0;
+
+static void term_on_stop(int sig) {
+    (void)sig;
+    g_termStop = 1;
+}
+
+#ifndef _WIN32
+static void term_on_resize(int sig) {
+    (void)sig;
+    g_termResized = 1;
+}
+#endif
+
+bool term_init(CClockTerm* term, int fd, int rows, int cols, bool ascii) {
+    memset(term, 0, sizeof(*term));
+    term->fd = fd;
+    term->ascii = ascii;
+    for (int ch = 0; ch < CCLOCK_GLYPH_COUNT; ++ch) term->metrics.advances[ch] = TERM_NARROW_ADVANCE;
+    for (int ch = '0'; ch <= '9'; ++ch) term->metrics.advances[ch] = TERM_DIGIT_ADVANCE;
+    term->metrics.lineHeight = TERM_DIGIT_HEIGHT;
+    return term_resize(term, rows, cols);
+}
+
+bool term_resize(CClockTerm* term, int rows, int cols) {
+    if (rows < 1) rows = 1;
+    if (cols < 1) cols = 1;
+    const size_t count = (size_t)rows * (size_t)cols;
+    CClockTermCell* screen = realloc(term->screen, count * sizeof(CClockTermCell));
+    if (screen) term->screen = screen;
+    CClockTermCell* frame = realloc(term->frame, count * sizeof(CClockTermCell));
+    if (frame) term->frame = frame;
+    if (!screen || !frame) return false;
+    term->rows = rows;
+    term->cols = cols;
+    // Whatever the terminal reflowed is unknown, every cell differs from the next frame
+    memset(term->screen, 0, count * sizeof(CClockTermCell));
+    term->title[0] = '\0';
+    term->cursorRow = term->cursorCol = term->attr = -1;
+    return true;
+}
+
+void term_destroy(CClockTerm* term) {
+    free(term->screen);
+    free(term->frame);
+    free(term->out);
+    memset(term, 0, sizeof(*term));
+}
+
+static void put_cell(CClockTerm* term, int row, int col, uint8_t ch, bool alert) {
+    if (row < 0 || row >= term->rows || col < 0 || col >= term->cols) return;
+    term->frame[row * term->cols + col] = (CClockTermCell){ ch, alert };
+}
+
+static void fill_cells(CClockTerm* term, int top, int bottom, int left, int right, bool alert) {
+    for (int row = top; row <= bottom; ++row) {
+        for (int col = left; col <= right; ++col) put_cell(term, row, col, TERM_CELL_BLOCK, alert);
+    }
+}
+
+static void draw_digit(CClockTerm* term, int top, int left, int digit, bool alert) {
+    const uint8_t segments = g_digitSegments[digit];
+    const int bottom = top + TERM_DIGIT_HEIGHT - 1, middle = top + TERM_DIGIT_HEIGHT / 2;
+    const int right = left + TERM_DIGIT_WIDTH - 1;
+    if (segments & SEG_A) fill_cells(term, top, top, left, right, alert);
+    if (segments & SEG_B) fill_cells(term, top, middle, right, right, alert);
+    if (segments & SEG_C) fill_cells(term, middle, bottom, right, right, alert);
+    if (segments & SEG_D) fill_cells(term, bottom, bottom, left, right, alert);
+    if (segments & SEG_E) fill_cells(term, middle, bottom, left, left, alert);
+    if (segments & SEG_F) fill_cells(term, top, middle, left, left, alert);
+    if (segments & SEG_G) fill_cells(term, middle, middle, left, right, alert);
+}
+
+static void put_text(CClockTerm* term, int row, const char* text, bool alert) {
+    const int length = (int)strlen(text);
+    const int left = (term->cols - length) / 2;
+    for (int i = 0; i < length; ++i) {
+        const unsigned char ch = (unsigned char)text[i];
+        put_cell(term, row, left + i, ch >= 0x20 && ch < 0x7f ? ch : '?', alert);
+    }
+}
+
+static void compose(CClockTerm* term, const CClockText* text) {
+    const size_t count = (size_t)term->rows * (size_t)term->cols;
+    for (size_t i = 0; i < count; ++i) term->frame[i] = (CClockTermCell){ ' ', 0 };
+
+    CClockGlyphPlacement placements[FORMAT_MAX_TEXT];
+    int width;
+    const int placementCount = cclock_layout_text(&term->metrics, text->timeStr, placements, FORMAT_MAX_TEXT, &width);
+    width -= 1;     // no gap after the last glyph
+    // Too small for the big digits: two plain lines
+    const bool big = width <= term->cols && TERM_DIGIT_HEIGHT + 2 <= term->rows;
+    const int height = big ? TERM_DIGIT_HEIGHT + 2 : 2;
+    const int top = (term->rows - height) / 2;
+    if (big) {
+        const int left = (term->cols - width) / 2;
+        for (int i = 0; i < placementCount; ++i) {
+            const char ch = placements[i].ch;
+            const int x = left + placements[i].x;
+            if (ch >= '0' && ch <= '9') draw_digit(term, top, x, ch - '0', text->alert);
+            else if (ch == ':') {
+                put_cell(term, top + 1, x, TERM_CELL_BLOCK, text->alert);
+                put_cell(term, top + TERM_DIGIT_HEIGHT - 2, x, TERM_CELL_BLOCK, text->alert);
+            }
+            else if (ch != ' ') put_cell(term, top + TERM_DIGIT_HEIGHT - 1, x, (uint8_t)ch, text->alert);
+        }
+    }
+    else put_text(term, top, text->timeStr, text->alert);
+    put_text(term, top + height - 1, text->dateStr, text->alert);
+}
+
+static bool out_append(CClockTerm* term, const char* bytes, size_t length) {
+    if (term->outLength + length > term->outCapacity) {
+        size_t capacity = term->outCapacity ? term->outCapacity * 2 : 4096;
+        while (capacity < term->outLength + length) capacity *= 2;
+        char* out = realloc(term->out, capacity);
+        if (!out) return false;
+        term->out = out;
+        term->outCapacity = capacity;
+    }
+    memcpy(term->out + term->outLength, bytes, length);
+    term->outLength += length;
+    return true;
+}
+
+static int digit_count(int value) {
+    int count = 1;
+    while (value >= 10) {
+        value /= 10;
+        count++;
+    }
+    return count;
+}
+
+// "\x1b[<row>;<col>H"
+static int cursor_move_bytes(int row, int col) {
+    return 4 + digit_count(row + 1) + digit_count(col + 1);
+}
+
+static int cell_bytes(const CClockTerm* term, CClockTermCell cell) {
+    return cell.ch == TERM_CELL_BLOCK && !term->ascii ? 3 : 1;
+}
+
+// The color of a space does not show, red runs are not broken by the gaps between digits
+static bool same_cell(CClockTermCell a, CClockTermCell b) {
+    return a.ch == b.ch && (a.alert == b.alert || a.ch == ' ');
+}
+
+static void emit_cell(CClockTerm* term, CClockTermCell cell) {
+    if (term->attr != cell.alert && cell.ch != ' ') {
+        if (cell.alert) out_append(term, "\x1b[31m", 5);
+        else out_append(term, "\x1b[0m", 4);
+        term->attr = cell.alert;
+    }
+    if (cell.ch == TERM_CELL_BLOCK) {
+        if (term->ascii) out_append(term, "#", 1);
+        else out_append(term, "\xe2\x96\x88", 3);
+    }
+    else out_append(term, (const char*)&cell.ch, 1);
+}
+
+size_t term_update(CClockTerm* term, const CClockText* text) {
+    compose(term, text);
+    term->outLength = 0;
+
+    if (strcmp(text->windowTitle, term->title) != 0) {
+        char title[CCLOCK_TITLE_MAX + 8];
+        const int length = snprintf(title, sizeof(title), "\x1b]0;%s\x07", text->windowTitle);
+        if (length > 0) out_append(term, title, (size_t)length < sizeof(title) ? (size_t)length : sizeof(title) - 1);
+        snprintf(term->title, sizeof(term->title), "%s", text->windowTitle);
+    }
+
+    for (int row = 0; row < term->rows; ++row) {
+        CClockTermCell* screen = term->screen + (size_t)row * term->cols;
+        const CClockTermCell* frame = term->frame + (size_t)row * term->cols;
+        for (int col = 0; col < term->cols;) {
+            if (same_cell(screen[col], frame[col])) {
+                col++;
+                continue;
+            }
+            // A run of changed cells, unchanged ones in between are written again when that is shorter
+            // than moving the cursor over them
+            int end = col + 1, gapBytes = 0;
+            for (int next = col + 1; next < term->cols; ++next) {
+                if (!same_cell(screen[next], frame[next])) {
+                    end = next + 1;
+                    gapBytes = 0;
+                    continue;
+                }
+                gapBytes += cell_bytes(term, frame[next]);
+                if (gapBytes >= cursor_move_bytes(row, next + 1)) break;
+            }
+
+            if (term->cursorRow != row || term->cursorCol != col) {
+                char move[24];
+                const int length = snprintf(move, sizeof(move), "\x1b[%d;%dH", row + 1, col + 1);
+                out_append(term, move, (size_t)length);
+            }
+            for (int i = col; i < end; ++i) {
+                emit_cell(term, frame[i]);
+                screen[i] = frame[i];
+            }
+            // Past the last column the cursor waits to wrap, where it is depends on the terminal
+            term->cursorRow = end < term->cols ? row : -1;
+            term->cursorCol = end < term->cols ? end : -1;
+            col = end;
+        }
+    }
+    return term->outLength;
+}
+
+bool term_flush(CClockTerm* term) {
+    size_t written = 0;
+    while (written < term->outLength) {
+#ifdef _WIN32
+        const int result = _write(term->fd, term->out + written, (unsigned)(term->outLength - written));
+#else
+        const ssize_t result = write(term->fd, term->out + written, term->outLength - written);
+#endif
+        term->writes++;
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += (size_t)result;
+    }
+    term->bytes += term->outLength;
+    term->outLength = 0;
+    return true;
+}
+
+static bool get_terminal_size(int* rows, int* cols) {
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return false;
+    *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+    *cols = info.srWindow.Right - info.srWindow.Left + 1;
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0 || size.ws_col == 0) return false;
+    *rows = size.ws_row;
+    *cols = size.ws_col;
+#endif
+    return true;
+}
+
+static void sleep_ms(uint32_t ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    // A signal (Ctrl+C, resize) cuts the wait short
+    const struct timespec wait = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000 };
+    nanosleep(&wait, NULL);
+#endif
+}
+
+static void write_raw(CClockTerm* term, const char* text) {
+    out_append(term, text, strlen(text));
+    const unsigned long writes = term->writes;
+    const unsigned long long bytes = term->bytes;
+    term_flush(term);
+    // Setup and teardown are not ticks
+    term->writes = writes;
+    term->bytes = bytes;
+}
+
+int term_run(CClockEngine* engine, const CClockTermOptions* options) {
+#ifdef _WIN32
+    // Escape sequences and UTF-8 are opt-in on the Windows console
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(console, &mode)) SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    SetConsoleOutputCP(CP_UTF8);
+    const int fd = _fileno(stdout);
+#else
+    const int fd = STDOUT_FILENO;
+    signal(SIGWINCH, term_on_resize);
+#endif
+    signal(SIGINT, term_on_stop);
+    signal(SIGTERM, term_on_stop);
+
+    int rows = 24, cols = 80;
+    get_terminal_size(&rows, &cols);
+    CClockTerm term;
+    if (!term_init(&term, fd, rows, cols, options->ascii)) {
+        fprintf(stderr, "term: out of memory\n");
+        return 1;
+    }
+
+    CClockSnapshot now;
+    cclock_snapshot(engine, &now);
+    if (options->chronoSeconds > 0) cclock_chrono_start(engine, &now, options->chronoSeconds);
+
+    write_raw(&term, "\x1b[?25l");
+    unsigned long ticks = 0;
+    while (!g_termStop) {
+#ifdef _WIN32
+        const bool checkSize = true;
+#else
+        const bool checkSize = g_termResized != 0;
+        g_termResized = 0;
+#endif
+        if (checkSize && get_terminal_size(&rows, &cols) && (rows != term.rows || cols != term.cols) && !term_resize(&term, rows, cols)) break;
+
+        cclock_snapshot(engine, &now);
+        CClockText text;
+        cclock_build_text(engine, &now, NULL, &text);
+        if (term_update(&term, &text) > 0 && !term_flush(&term)) break;
+        ticks++;
+
+        const long wallMs = cclock_wall_ms_until_next_tick(engine, &now);
+        sleep_ms(time_source_real_ms(engine->time, wallMs + TERM_TICK_SLACK_MS, TERM_MAX_WAIT_MS));
+    }
+
+    // The prompt comes back under the clock
+    char restore[32];
+    snprintf(restore, sizeof(restore), "\x1b[0m\x1b[%d;1H\x1b[?25h\n", term.rows);
+    write_raw(&term, restore);
+    fprintf(stderr, "term: %lu ticks, %.1f bytes and %.2f writes per tick\n", ticks,
+        ticks ? (double)term.bytes / ticks : 0.0, ticks ? (double)term.writes / ticks : 0.0);
+    term_destroy(&term);
+    return 0;
+}
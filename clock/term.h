@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cclock.h"
+
+// Terminal front end for headless servers and tmux panes: the time line as big seven segment digits
+// with the date under it, centered. Each update diffs the new frame against what the terminal shows
+// and only the cells that changed are written, with cursor addressed escape sequences. The screen is
+// never cleared and a tick goes out in a single write
+
+#define TERM_DIGIT_WIDTH 4
+#define TERM_DIGIT_HEIGHT 5
+#define TERM_CELL_UNKNOWN 0     // screen cells before the first write or after a resize
+#define TERM_CELL_BLOCK 1       // a lit segment, U+2588 or '#' in ASCII mode
+
+typedef struct {
+    uint8_t ch;                 // ASCII, TERM_CELL_BLOCK or TERM_CELL_UNKNOWN
+    uint8_t alert;              // drawn in red
+} CClockTermCell;
+
+typedef struct {
+    int fd;                     // where term_flush writes
+    int rows;
+    int cols;
+    bool ascii;
+    CClockGlyphMetrics metrics; // advances in cells: big digits, narrow colons, spaces and letters
+    CClockTermCell* screen;     // what the terminal shows
+    CClockTermCell* frame;      // what it should show
+    char title[CCLOCK_TITLE_MAX];
+    // Where the terminal is after the last write, -1 when unknown
+    int cursorRow;
+    int cursorCol;
+    int attr;
+    char* out;                  // escape sequences of the pending update
+    size_t outLength;
+    size_t outCapacity;
+    unsigned long writes;       // write calls made by term_flush
+    unsigned long long bytes;
+} CClockTerm;
+
+typedef struct {
+    bool ascii;                 // '#' for the segments, for fonts without the block character
+    long chronoSeconds;         // > 0: count down that long instead of showing the clock
+} CClockTermOptions;
+
+bool term_init(CClockTerm* term, int fd, int rows, int cols, bool ascii);
+
+// Every cell is written again by the next update
+bool term_resize(CClockTerm* term, int rows, int cols);
+
+// Composes the frame of text and queues the escape sequences that bring the screen to it.
+// Returns the number of bytes queued, 0 when nothing changed
+size_t term_update(CClockTerm* term, const CClockText* text);
+
+// Writes the queued bytes in one call (more only if the terminal takes part of them)
+bool term_flush(CClockTerm* term);
+
+void term_destroy(CClockTerm* term);
+
+// Runs until Ctrl+C on stdout, returns the process exit code
+int term_run(CClockEngine* engine, const CClockTermOptions* options);
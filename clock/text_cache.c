@@ -0,0 +1,129 @@
+#include "text_cache.h"
+
+#include <string.h>
+
+#include "soak_track.h"
+
+static CClockTextEntry* find_entry(CClockTextCache* cache, TTF_Font* font, const char* text, bool* exact) {
+    CClockTextEntry* sameFont = NULL;
+    CClockTextEntry* oldest = &cache->entries[0];
+    for (int i = 0; i < TEXT_CACHE_ENTRIES; ++i) {
+        CClockTextEntry* entry = &cache->entries[i];
+        if (entry->texture && entry->font == font && strcmp(entry->text, text) == 0) {
+            *exact = true;
+            return entry;
+        }
+        if (!cache->fixedStrings && entry->font == font && (!sameFont || entry->lastUse < sameFont->lastUse)) sameFont = entry;
+        if (entry->lastUse < oldest->lastUse) oldest = entry;
+    }
+    *exact = false;
+    return sameFont ? sameFont : oldest;
+}
+
+static int prefix_width(TTF_Font* font, const char* text, int length) {
+    char prefix[TEXT_CACHE_MAX_TEXT];
+    memcpy(prefix, text, length);
+    prefix[length] = '\0';
+    int w = 0;
+    TTF_SizeText(font, prefix, &w, NULL);
+    return w;
+}
+
+// Columns of the texture that differ from the previous string, the whole text when the layout changed
+static SDL_Rect changed_rect(const CClockTextEntry* entry, TTF_Font* font, const char* text, const SDL_Surface* surface) {
+    const SDL_Rect full = { 0, 0, surface->w, surface->h };
+    const size_t length = strlen(text);
+    if (entry->font != font || strlen(entry->text) != length || entry->w != surface->w || entry->h != surface->h) return full;
+
+    int first = 0;
+    while (first < (int)length && text[first] == entry->text[first]) ++first;
+    if (first == (int)length) return full;
+    int last = (int)length - 1;
+    while (text[last] == entry->text[last]) --last;
+
+    const int x0 = prefix_width(font, text, first);
+    const int x1 = SDL_min(prefix_width(font, text, last + 1), surface->w);
+    return x0 < x1 ? (SDL_Rect){ x0, 0, x1 - x0, surface->h } : full;
+}
+
+static bool update_entry(CClockTextCache* cache, CClockTextEntry* entry, SDL_Renderer* renderer, TTF_Font* font, const char* text) {
+    const SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* surface = cache->blended ? TTF_RenderText_Blended(font, text, white) : TTF_RenderText_Solid(font, text, white);
+    if (!surface) return false;
+
+    SDL_Rect rect;
+    if (entry->texture && surface->w <= entry->bucketW && surface->h <= entry->bucketH) {
+        rect = changed_rect(entry, font, text, surface);
+    }
+    else {
+        if (entry->texture) texture_pool_release(&cache->pool, entry->texture);
+        entry->texture = texture_pool_acquire(&cache->pool, renderer, surface->w, surface->h, &entry->bucketW, &entry->bucketH);
+        rect = (SDL_Rect){ 0, 0, surface->w, surface->h };
+    }
+    if (!entry->texture) {
+        entry->font = NULL;
+        SDL_FreeSurface(surface);
+        return false;
+    }
+
+    // Solid text is 8 bit paletted, index 0 is the background: expand straight into the locked rectangle.
+    // Blended text is already ARGB8888 like the pool
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(entry->texture, &rect, &pixels, &pitch) == 0) {
+        SDL_LockSurface(surface);
+        for (int y = 0; y < rect.h; ++y) {
+            const Uint8* row = (const Uint8*)surface->pixels + (rect.y + y) * surface->pitch;
+            Uint32* dst = (Uint32*)((Uint8*)pixels + y * pitch);
+            if (cache->blended) {
+                memcpy(dst, (const Uint32*)row + rect.x, (size_t)rect.w * 4);
+                continue;
+            }
+            const Uint8* src = row + rect.x;
+            for (int x = 0; x < rect.w; ++x) dst[x] = src[x] ? 0xFFFFFFFF : 0x00000000;
+        }
+        SDL_UnlockSurface(surface);
+        SDL_UnlockTexture(entry->texture);
+        cache->uploadedBytes += (size_t)rect.w * rect.h * 4;
+        if (rect.w == surface->w) cache->fullUpdates++;
+        else cache->partialUpdates++;
+    }
+
+    entry->font = font;
+    entry->w = surface->w;
+    entry->h = surface->h;
+    SDL_strlcpy(entry->text, text, TEXT_CACHE_MAX_TEXT);
+    SDL_FreeSurface(surface);
+    return true;
+}
+
+void text_cache_draw(CClockTextCache* cache, SDL_Renderer* renderer, TTF_Font* font, const char* text,
+    int x, int y, float scale, SDL_Color color) {
+
+    if (!text[0] || strlen(text) >= TEXT_CACHE_MAX_TEXT) return;
+    cache->draws++;
+    cache->useCounter++;
+
+    bool exact;
+    CClockTextEntry* entry = find_entry(cache, font, text, &exact);
+    if (exact) cache->unchanged++;
+    else if (!update_entry(cache, entry, renderer, font, text)) return;
+    entry->lastUse = cache->useCounter;
+
+    const SDL_Rect src = { 0, 0, entry->w, entry->h };
+    const SDL_Rect dst = { x, y, (int)(entry->w * scale), (int)(entry->h * scale) };
+    SDL_SetTextureColorMod(entry->texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(entry->texture, color.a);
+    SDL_RenderCopy(renderer, entry->texture, &src, &dst);
+}
+
+void text_cache_clear(CClockTextCache* cache) {
+    for (int i = 0; i < TEXT_CACHE_ENTRIES; ++i) cache->entries[i] = (CClockTextEntry){ 0 };
+    texture_pool_clear(&cache->pool);
+}
+
+void text_cache_report(const CClockTextCache* cache, FILE* out) {
+    fprintf(out, "text cache: %lu draws, %lu unchanged, %lu partial uploads, %lu full uploads, %zu KiB uploaded\n",
+        cache->draws, cache->unchanged, cache->partialUpdates, cache->fullUpdates, cache->uploadedBytes / 1024);
+    texture_pool_report(&cache->pool, out);
+}
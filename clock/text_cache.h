@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "texture_pool.h"
+
+#define TEXT_CACHE_ENTRIES 16 // the 12 dial numerals share one cache
+#define TEXT_CACHE_MAX_TEXT 80
+
+// Last string drawn with a font, rendered in white and tinted with the color mod so the
+// shadow and the text share one texture
+typedef struct {
+    TTF_Font* font;
+    SDL_Texture* texture;   // owned by the pool
+    int bucketW;
+    int bucketH;
+    int w;                  // size of the text inside the texture
+    int h;
+    char text[TEXT_CACHE_MAX_TEXT];
+    unsigned long lastUse;
+} CClockTextEntry;
+
+typedef struct {
+    bool blended;           // anti-aliased TTF_RenderText_Blended, only for text over an opaque background
+                            // (Solid by default: coverage 0 or 255 leaves no fringe on a color keyed window)
+    bool fixedStrings;      // a fixed set drawn together (dial numerals): a new string takes the oldest entry
+                            // instead of updating the last one of its font
+    CClockTexturePool pool;
+    CClockTextEntry entries[TEXT_CACHE_ENTRIES];
+    unsigned long useCounter;
+    unsigned long draws;
+    unsigned long unchanged;        // draws of a string already in a texture
+    unsigned long partialUpdates;   // only the rectangle of the changed characters was uploaded
+    unsigned long fullUpdates;
+    size_t uploadedBytes;
+} CClockTextCache;
+
+void text_cache_draw(CClockTextCache* cache, SDL_Renderer* renderer, TTF_Font* font, const char* text,
+    int x, int y, float scale, SDL_Color color);
+
+// Releases every texture, for SDL_RENDER_DEVICE_RESET and shutdown
+void text_cache_clear(CClockTextCache* cache);
+
+void text_cache_report(const CClockTextCache* cache, FILE* out);
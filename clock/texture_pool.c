@@ -0,0 +1,89 @@
+#include "texture_pool.h"
+
+#include "soak_track.h"
+
+static int bucket_size(int size) {
+    int bucket = TEXTURE_POOL_MIN_BUCKET;
+    while (bucket < size) bucket *= 2;
+    return bucket;
+}
+
+static void destroy_entry(CClockTexturePool* pool, CClockPooledTexture* entry) {
+    SDL_DestroyTexture(entry->texture);
+    pool->residentBytes -= (size_t)entry->w * entry->h * 4;
+    *entry = (CClockPooledTexture){ 0 };
+}
+
+SDL_Texture* texture_pool_acquire(CClockTexturePool* pool, SDL_Renderer* renderer, int w, int h, int* bucketW, int* bucketH) {
+    const int bw = bucket_size(w);
+    const int bh = bucket_size(h);
+    pool->useCounter++;
+
+    CClockPooledTexture* empty = NULL;
+    CClockPooledTexture* oldestFree = NULL;
+    for (int i = 0; i < TEXTURE_POOL_MAX_TEXTURES; ++i) {
+        CClockPooledTexture* entry = &pool->textures[i];
+        if (!entry->texture) {
+            if (!empty) empty = entry;
+            continue;
+        }
+        if (entry->inUse) continue;
+        if (entry->w == bw && entry->h == bh) {
+            entry->inUse = true;
+            entry->lastUse = pool->useCounter;
+            pool->hits++;
+            *bucketW = bw;
+            *bucketH = bh;
+            return entry->texture;
+        }
+        if (!oldestFree || entry->lastUse < oldestFree->lastUse) oldestFree = entry;
+    }
+
+    // No free texture of that bucket, make room by dropping the least recently used free one
+    if (!empty && oldestFree) {
+        destroy_entry(pool, oldestFree);
+        empty = oldestFree;
+    }
+    if (!empty) {
+        fprintf(stderr, "Texture pool exhausted (%d textures in use)\n", TEXTURE_POOL_MAX_TEXTURES);
+        return NULL;
+    }
+
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, bw, bh);
+    if (!texture) {
+        fprintf(stderr, "Could not create pooled texture: %s\n", SDL_GetError());
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    *empty = (CClockPooledTexture){ texture, bw, bh, true, pool->useCounter };
+    pool->misses++;
+    pool->residentBytes += (size_t)bw * bh * 4;
+    *bucketW = bw;
+    *bucketH = bh;
+    return texture;
+}
+
+void texture_pool_release(CClockTexturePool* pool, SDL_Texture* texture) {
+    for (int i = 0; i < TEXTURE_POOL_MAX_TEXTURES; ++i) {
+        if (pool->textures[i].texture == texture) {
+            pool->textures[i].inUse = false;
+            return;
+        }
+    }
+}
+
+void texture_pool_clear(CClockTexturePool* pool) {
+    for (int i = 0; i < TEXTURE_POOL_MAX_TEXTURES; ++i) {
+        if (pool->textures[i].texture) destroy_entry(pool, &pool->textures[i]);
+    }
+}
+
+double texture_pool_hit_rate(const CClockTexturePool* pool) {
+    const unsigned long total = pool->hits + pool->misses;
+    return total > 0 ? (double)pool->hits / total : 0.0;
+}
+
+void texture_pool_report(const CClockTexturePool* pool, FILE* out) {
+    fprintf(out, "texture pool: %lu hits, %lu misses (hit rate %.1f%%), %zu KiB resident\n",
+        pool->hits, pool->misses, texture_pool_hit_rate(pool) * 100.0, pool->residentBytes / 1024);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <SDL.h>
+
+#define TEXTURE_POOL_MAX_TEXTURES 16
+#define TEXTURE_POOL_MIN_BUCKET 64
+
+typedef struct {
+    SDL_Texture* texture;   // ARGB8888, SDL_TEXTUREACCESS_STREAMING
+    int w;                  // bucket size, power of two in each dimension
+    int h;
+    bool inUse;
+    unsigned long lastUse;
+} CClockPooledTexture;
+
+// Long-lived streaming textures of bucketed sizes, so drawing text does not create and destroy
+// GPU resources every frame. Free textures are only destroyed when the pool is full
+typedef struct {
+    CClockPooledTexture textures[TEXTURE_POOL_MAX_TEXTURES];
+    unsigned long useCounter;
+    unsigned long hits;     // acquisitions served by a free texture
+    unsigned long misses;   // acquisitions that had to create one
+    size_t residentBytes;
+} CClockTexturePool;
+
+// Returns a texture at least w * h, *bucketW/*bucketH receive its real size. NULL on failure
+SDL_Texture* texture_pool_acquire(CClockTexturePool* pool, SDL_Renderer* renderer, int w, int h, int* bucketW, int* bucketH);
+
+void texture_pool_release(CClockTexturePool* pool, SDL_Texture* texture);
+
+// Drops every texture, for SDL_RENDER_DEVICE_RESET and shutdown
+void texture_pool_clear(CClockTexturePool* pool);
+
+double texture_pool_hit_rate(const CClockTexturePool* pool);
+
+void texture_pool_report(const CClockTexturePool* pool, FILE* out);
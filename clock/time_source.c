@@ -0,0 +1,191 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // clock_gettime, localtime_r
+#endif
+
+#include "time_source.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crt_compat.h"
+#include "monotonic.h"
+
+#define NS_PER_SECOND 1000000000LL
+
+static int64_t real_now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (int64_t)ts.tv_sec * NS_PER_SECOND + ts.tv_nsec;
+}
+
+static double elapsed_seconds(const CClockTimeSource* source) {
+    return (double)(monotonic_ns() - source->startNs) / 1e9;
+}
+
+bool time_source_parse_datetime(const char* text, time_t* out) {
+    struct tm tm = { 0 };
+    int year, month, day, hour = 0, minute = 0, second = 0;
+    const int fields = sscanf_s(text, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+    if (fields != 3 && fields != 5 && fields != 6) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    tm.tm_isdst = -1;
+    *out = mktime(&tm);
+    return *out != (time_t)-1;
+}
+
+bool time_source_parse_duration(const char* text, long* seconds) {
+    char* end = NULL;
+    const double value = strtod(text, &end);
+    if (end == text || value < 0) return false;
+    double unit = 1;
+    if (*end == 'm') unit = 60;
+    else if (*end == 'h') unit = 3600;
+    else if (*end == 'd') unit = 86400;
+    else if (*end != 's' && *end != '\0') return false;
+    if (*end && end[1]) return false;
+    *seconds = (long)(value * unit);
+    return true;
+}
+
+static bool parse_script(CClockTimeSource* source, const char* text) {
+    source->stepCount = 0;
+    const char* item = text;
+    while (*item) {
+        if (source->stepCount == TIME_SOURCE_MAX_STEPS) return false;
+        char part[64];
+        const size_t length = strcspn(item, ",");
+        if (length == 0 || length >= sizeof(part)) return false;
+        memcpy(part, item, length);
+        part[length] = '\0';
+        item += length + (item[length] == ',');
+
+        // The first step is the start time, every later one "<real seconds>=<time>"
+        CClockTimeStep* step = &source->steps[source->stepCount];
+        char* when = strchr(part, '=');
+        step->at = 0;
+        if (when) {
+            *when++ = '\0';
+            step->at = atof(part);
+        }
+        else if (source->stepCount > 0) return false;
+        else when = part;
+        if (source->stepCount == 0 ? step->at != 0 : step->at <= source->steps[source->stepCount - 1].at) return false;
+
+        time_t wall;
+        if (!time_source_parse_datetime(when, &wall)) return false;
+        step->wallNs = (int64_t)wall * NS_PER_SECOND;
+        source->stepCount++;
+    }
+    return source->stepCount > 0;
+}
+
+bool time_source_parse(CClockTimeSource* source, const char* spec) {
+    memset(source, 0, sizeof(*source));
+    source->kind = CCLOCK_TIME_REAL;
+    bool success = true;
+    time_t wall;
+
+    if (strncmp(spec, "fixed:", 6) == 0) {
+        success = time_source_parse_datetime(spec + 6, &wall);
+        source->kind = CCLOCK_TIME_FIXED;
+        source->originNs = (int64_t)wall * NS_PER_SECOND;
+    }
+    else if (strncmp(spec, "accel:", 6) == 0) {
+        source->kind = CCLOCK_TIME_ACCELERATED;
+        char* end = NULL;
+        source->speed = strtod(spec + 6, &end);
+        success = end != spec + 6 && source->speed > 0;
+        if (success && *end == '@') {
+            success = time_source_parse_datetime(end + 1, &wall);
+            source->originNs = (int64_t)wall * NS_PER_SECOND;
+        }
+        else if (*end) success = false;
+    }
+    else if (strncmp(spec, "script:", 7) == 0) {
+        source->kind = CCLOCK_TIME_SCRIPTED;
+        success = parse_script(source, spec + 7);
+    }
+    else if (strcmp(spec, "real") != 0) {
+        success = false;
+    }
+
+    if (!success) {
+        fprintf(stderr, "time source: invalid '%s', using the real time\n", spec);
+        memset(source, 0, sizeof(*source));
+        source->kind = CCLOCK_TIME_REAL;
+    }
+    time_source_start(source);
+    return success;
+}
+
+void time_source_start(CClockTimeSource* source) {
+    source->startNs = monotonic_ns();
+    // Accelerating from now: anchor on the real time once, the source then only follows the monotonic clock
+    if (source->kind == CCLOCK_TIME_ACCELERATED && source->originNs == 0) source->originNs = real_now_ns();
+}
+
+int64_t time_source_now_ns(const CClockTimeSource* source) {
+    switch (source->kind) {
+    case CCLOCK_TIME_FIXED:
+        return source->originNs;
+    case CCLOCK_TIME_ACCELERATED:
+        return source->originNs + (int64_t)(elapsed_seconds(source) * source->speed * 1e9);
+    case CCLOCK_TIME_SCRIPTED: {
+        const double elapsed = elapsed_seconds(source);
+        int step = 0;
+        while (step + 1 < source->stepCount && source->steps[step + 1].at <= elapsed) ++step;
+        return source->steps[step].wallNs + (int64_t)((elapsed - source->steps[step].at) * 1e9);
+    }
+    case CCLOCK_TIME_REAL:
+    default:
+        return real_now_ns();
+    }
+}
+
+time_t time_source_seconds(int64_t ns) {
+    // Floor, not truncation, for times before 1970
+    return (time_t)(ns >= 0 ? ns / NS_PER_SECOND : -((-ns + NS_PER_SECOND - 1) / NS_PER_SECOND));
+}
+
+time_t time_source_now(const CClockTimeSource* source) {
+    return time_source_seconds(time_source_now_ns(source));
+}
+
+void time_source_local(const CClockTimeSource* source, struct tm* tm) {
+    const time_t now = time_source_now(source);
+#ifdef _WIN32
+    localtime_s(tm, &now);
+#else
+    localtime_r(&now, tm);
+#endif
+}
+
+void time_source_set(CClockTimeSource* source, int64_t wallNs) {
+    if (source->kind == CCLOCK_TIME_FIXED) source->originNs = wallNs;
+}
+
+uint32_t time_source_real_ms(const CClockTimeSource* source, int64_t wallMs, uint32_t limit) {
+    double ms = (double)wallMs;
+    if (source->kind == CCLOCK_TIME_FIXED) return limit;
+    if (source->kind == CCLOCK_TIME_ACCELERATED) ms /= source->speed;
+    if (source->kind == CCLOCK_TIME_SCRIPTED) {
+        // Wake up for the next jump, whatever it lands on
+        const double elapsed = elapsed_seconds(source);
+        for (int i = 0; i < source->stepCount; ++i) {
+            const double untilStep = (source->steps[i].at - elapsed) * 1000.0;
+            if (untilStep > 0 && untilStep < ms) {
+                ms = untilStep;
+                break;
+            }
+        }
+    }
+    if (ms < 1) return 1;
+    return ms < limit ? (uint32_t)ms : limit;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Where the clock reads the wall time from. Everything that shows or schedules on wall time goes
+// through one of these so timing can be reproduced:
+//
+//   real                                  the system clock
+//   fixed:2025-03-30T01:59:50             frozen, time_source_set moves it (simulation)
+//   accel:3600[@2025-03-30T00:00]         an hour per real second, from now or from the given time
+//   script:2025-03-30T01:59:50,10=2025-10-26T02:59:50
+//                                         real speed, jumps to each time after that many real seconds
+//
+// Times are local, "YYYY-MM-DD", "YYYY-MM-DDTHH:MM" or "YYYY-MM-DDTHH:MM:SS"
+
+#define TIME_SOURCE_MAX_STEPS 16
+
+typedef enum {
+    CCLOCK_TIME_REAL,
+    CCLOCK_TIME_FIXED,
+    CCLOCK_TIME_ACCELERATED,
+    CCLOCK_TIME_SCRIPTED,
+} CClockTimeSourceKind;
+
+typedef struct {
+    double at;          // real seconds after time_source_start
+    int64_t wallNs;     // wall time at that moment
+} CClockTimeStep;
+
+typedef struct {
+    CClockTimeSourceKind kind;
+    int64_t originNs;   // FIXED: the time, ACCELERATED: the time at start, 0 for the real time then
+    double speed;       // ACCELERATED
+    uint64_t startNs;   // monotonic ns at time_source_start
+    CClockTimeStep steps[TIME_SOURCE_MAX_STEPS]; // SCRIPTED, steps[0].at is 0
+    int stepCount;
+} CClockTimeSource;
+
+// False (with a message) for a malformed spec, the source is then left real
+bool time_source_parse(CClockTimeSource* source, const char* spec);
+
+// Anchors accelerated and scripted sources to the current real time
+void time_source_start(CClockTimeSource* source);
+
+// Nanoseconds since the epoch
+int64_t time_source_now_ns(const CClockTimeSource* source);
+
+time_t time_source_now(const CClockTimeSource* source);
+
+// Whole seconds of a time in ns, rounded down also before 1970
+time_t time_source_seconds(int64_t ns);
+
+void time_source_local(const CClockTimeSource* source, struct tm* tm);
+
+// FIXED only
+void time_source_set(CClockTimeSource* source, int64_t wallNs);
+
+// Real milliseconds until the source moves wallMs forward, at least 1, limit if it never does
+uint32_t time_source_real_ms(const CClockTimeSource* source, int64_t wallMs, uint32_t limit);
+
+// Local "YYYY-MM-DD[THH:MM[:SS]]"
+bool time_source_parse_datetime(const char* text, time_t* out);
+
+// "45", "45s", "90m", "36h" or "3d" in seconds
+bool time_source_parse_duration(const char* text, long* seconds);
@@ -0,0 +1,151 @@
+#include "transition.h"
+
+#include <string.h>
+
+static const char* const g_styleNames[CCLOCK_TRANSITION_COUNT] = { "none", "flip", "slide", "crossfade" };
+
+const char* transition_style_name(CClockTransitionStyle style) {
+    return style >= 0 && style < CCLOCK_TRANSITION_COUNT ? g_styleNames[style] : "?";
+}
+
+CClockTransitionStyle transition_style_from_name(const char* name) {
+    for (int i = 0; i < CCLOCK_TRANSITION_COUNT; ++i) {
+        if (strcmp(name, g_styleNames[i]) == 0) return (CClockTransitionStyle)i;
+    }
+    return CCLOCK_TRANSITION_COUNT;
+}
+
+static void finish(CClockTransitions* transitions) {
+    transitions->running = false;
+    if (transitions->frames == 0) return;
+    if (transitions->count == 0 || transitions->frames < transitions->minFrames) transitions->minFrames = transitions->frames;
+    if (transitions->frames > transitions->maxFrames) transitions->maxFrames = transitions->frames;
+    if (transitions->worstIntervalMs > transitions->worstIntervalMsAll) transitions->worstIntervalMsAll = transitions->worstIntervalMs;
+    if (transitions->worstRenderMs > transitions->worstRenderMsAll) transitions->worstRenderMsAll = transitions->worstRenderMs;
+    transitions->count++;
+    transitions->totalFrames += transitions->frames;
+}
+
+void transitions_update(CClockTransitions* transitions, const char* text, uint64_t nowMs) {
+    if (strcmp(text, transitions->to) == 0) return;
+
+    const bool animate = transitions->style != CCLOCK_TRANSITION_NONE && transitions->to[0]
+        && strlen(text) == strlen(transitions->to) && strlen(text) < TRANSITION_MAX_CHARS;
+    // A change in the middle of a transition starts from what it was heading to
+    if (transitions->running) finish(transitions);
+    SDL_strlcpy(transitions->from, transitions->to, TRANSITION_MAX_CHARS);
+    SDL_strlcpy(transitions->to, text, TRANSITION_MAX_CHARS);
+    if (!animate) return;
+
+    transitions->startMs = nowMs;
+    transitions->running = true;
+    transitions->frames = 0;
+    transitions->lastPresent = 0;
+    transitions->worstIntervalMs = 0.0;
+    transitions->worstRenderMs = 0.0;
+}
+
+void transitions_reset(CClockTransitions* transitions) {
+    transitions->running = false;
+    transitions->to[0] = '\0';
+}
+
+bool transitions_running(const CClockTransitions* transitions) {
+    return transitions->running;
+}
+
+static float get_progress(const CClockTransitions* transitions, uint64_t nowMs) {
+    if (!transitions->running) return 1.f;
+    const float t = (float)(nowMs - transitions->startMs) / TRANSITION_DURATION_MS;
+    if (t >= 1.f) return 1.f;
+    return t * t * (3.f - 2.f * t); // smoothstep
+}
+
+static SDL_Color with_alpha(SDL_Color color, float alpha) {
+    color.a = (Uint8)(color.a * alpha + 0.5f);
+    return color;
+}
+
+static void push_changed_char(CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face, bool shadow, CClockTransitionStyle style,
+    int from, int to, float x, float y, float scale, SDL_Color color, float p) {
+
+    // Faded glyphs over a color key round to the key or opaque and the digit blinks dark, slide instead
+    if (style == CCLOCK_TRANSITION_CROSSFADE && atlas->colorKeyed) style = CCLOCK_TRANSITION_SLIDE;
+    switch (style) {
+    case CCLOCK_TRANSITION_FLIP: {
+        // Static halves: new top behind the flap, old bottom until the flap covers it
+        glyph_batch_push_band(batch, atlas, face, to, shadow, x, y, scale, 0.f, .5f, 0.f, .5f, color);
+        if (p < .5f) {
+            const float fold = 1.f - 2.f * p;
+            glyph_batch_push_band(batch, atlas, face, from, shadow, x, y, scale, .5f, 1.f, .5f, 1.f, color);
+            glyph_batch_push_band(batch, atlas, face, from, shadow, x, y, scale, 0.f, .5f, .5f - .5f * fold, .5f, color);
+        }
+        else {
+            const float unfold = 2.f * p - 1.f;
+            glyph_batch_push_band(batch, atlas, face, from, shadow, x, y, scale, .5f + .5f * unfold, 1.f, .5f + .5f * unfold, 1.f, color);
+            glyph_batch_push_band(batch, atlas, face, to, shadow, x, y, scale, .5f, 1.f, .5f, .5f + .5f * unfold, color);
+        }
+        break;
+    }
+    case CCLOCK_TRANSITION_SLIDE:
+        // Both digits stay inside the glyph box, what leaves it is cropped off the source
+        glyph_batch_push_band(batch, atlas, face, from, shadow, x, y, scale, p, 1.f, 0.f, 1.f - p, color);
+        glyph_batch_push_band(batch, atlas, face, to, shadow, x, y, scale, 0.f, p, 1.f - p, 1.f, color);
+        break;
+    case CCLOCK_TRANSITION_CROSSFADE:
+        glyph_batch_push_band(batch, atlas, face, from, shadow, x, y, scale, 0.f, 1.f, 0.f, 1.f, with_alpha(color, 1.f - p));
+        glyph_batch_push_band(batch, atlas, face, to, shadow, x, y, scale, 0.f, 1.f, 0.f, 1.f, with_alpha(color, p));
+        break;
+    default:
+        glyph_batch_push_band(batch, atlas, face, to, shadow, x, y, scale, 0.f, 1.f, 0.f, 1.f, color);
+        break;
+    }
+}
+
+void transitions_push_text(CClockTransitions* transitions, CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face,
+    bool shadow, float x, float y, float scale, SDL_Color color, uint64_t nowMs) {
+
+    const float p = get_progress(transitions, nowMs);
+    if (p >= 1.f) {
+        if (shadow) glyph_batch_push_shadow(batch, atlas, face, transitions->to, x, y, scale, color);
+        else glyph_batch_push_text(batch, atlas, face, transitions->to, x, y, scale, color);
+        return;
+    }
+
+    float penX = x;
+    for (int i = 0; transitions->to[i]; ++i) {
+        const int from = (unsigned char)transitions->from[i];
+        const int to = (unsigned char)transitions->to[i];
+        if (to >= GLYPH_ATLAS_CHAR_COUNT) continue;
+        if (from == to) glyph_batch_push_band(batch, atlas, face, to, shadow, penX, y, scale, 0.f, 1.f, 0.f, 1.f, color);
+        else push_changed_char(batch, atlas, face, shadow, transitions->style, from, to, penX, y, scale, color, p);
+        penX += atlas->faces[face].glyphs[to].advance * scale;
+    }
+}
+
+void transitions_frame_presented(CClockTransitions* transitions, double renderMs, uint64_t nowMs) {
+    if (!transitions->running) return;
+
+    const uint64_t now = SDL_GetPerformanceCounter();
+    if (transitions->lastPresent) {
+        const double intervalMs = (double)(now - transitions->lastPresent) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        if (intervalMs > transitions->worstIntervalMs) transitions->worstIntervalMs = intervalMs;
+    }
+    transitions->lastPresent = now;
+    if (renderMs > transitions->worstRenderMs) transitions->worstRenderMs = renderMs;
+    transitions->frames++;
+
+    // The frame at progress 1 has been shown, back to the idle schedule
+    if (nowMs - transitions->startMs >= TRANSITION_DURATION_MS) finish(transitions);
+}
+
+void transitions_report(const CClockTransitions* transitions, FILE* out) {
+    if (transitions->count == 0) {
+        fprintf(out, "transitions (%s): none\n", transition_style_name(transitions->style));
+        return;
+    }
+    fprintf(out, "transitions (%s): %lu, frames per transition min %u avg %.1f max %u, worst frame interval %.2f ms, worst render %.2f ms\n",
+        transition_style_name(transitions->style), transitions->count, transitions->minFrames,
+        (double)transitions->totalFrames / transitions->count, transitions->maxFrames,
+        transitions->worstIntervalMsAll, transitions->worstRenderMsAll);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <SDL.h>
+
+#include "glyph_atlas.h"
+
+#define TRANSITION_DURATION_MS 300
+#define TRANSITION_MAX_CHARS 16
+
+typedef enum {
+    CCLOCK_TRANSITION_NONE,
+    CCLOCK_TRANSITION_FLIP,      // split-flap: the top half of the old digit folds down onto the new one
+    CCLOCK_TRANSITION_SLIDE,     // old digit slides up and out, the new one comes in from below
+    CCLOCK_TRANSITION_CROSSFADE,
+    CCLOCK_TRANSITION_COUNT,
+} CClockTransitionStyle;
+
+// Animates the characters of a string that changed, every intermediate frame is made of
+// bands of the atlas glyphs so nothing is rasterized while animating
+typedef struct {
+    CClockTransitionStyle style;
+    char from[TRANSITION_MAX_CHARS];
+    char to[TRANSITION_MAX_CHARS];
+    uint64_t startMs;
+    bool running;
+
+    // Current transition
+    unsigned frames;
+    uint64_t lastPresent;       // performance counter of the previous frame
+    double worstIntervalMs;
+    double worstRenderMs;
+
+    // Every finished transition
+    unsigned long count;
+    unsigned long totalFrames;
+    unsigned minFrames;
+    unsigned maxFrames;
+    double worstIntervalMsAll;
+    double worstRenderMsAll;
+} CClockTransitions;
+
+const char* transition_style_name(CClockTransitionStyle style);
+
+// Returns CCLOCK_TRANSITION_COUNT for unknown names
+CClockTransitionStyle transition_style_from_name(const char* name);
+
+// Starts a transition on the characters that differ from the previous text. The first text is shown as is
+void transitions_update(CClockTransitions* transitions, const char* text, uint64_t nowMs);
+
+// Stops any transition and forgets the text, the next one is shown without animation
+void transitions_reset(CClockTransitions* transitions);
+
+// True while frames have to be rendered at display rate, including the final one
+bool transitions_running(const CClockTransitions* transitions);
+
+// Same as glyph_batch_push_text/push_shadow for the text given to transitions_update, at nowMs
+void transitions_push_text(CClockTransitions* transitions, CClockGlyphBatch* batch, const CClockGlyphAtlas* atlas, int face,
+    bool shadow, float x, float y, float scale, SDL_Color color, uint64_t nowMs);
+
+// Call once per presented frame with its render time, ends the transition after its last frame
+void transitions_frame_presented(CClockTransitions* transitions, double renderMs, uint64_t nowMs);
+
+void transitions_report(const CClockTransitions* transitions, FILE* out);
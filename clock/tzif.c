@@ -0,0 +1,388 @@
+#include "tzif.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TZIF_HEADER_SIZE 44
+#define TZIF_MAX_FILE_SIZE (1 << 20)
+
+// Used when a POSIX TZ string has a DST name but no rule, same default as glibc
+#define TZ_DEFAULT_RULE ",M3.2.0,M11.1.0"
+
+static uint32_t read_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static int64_t read_be64(const uint8_t* p) {
+    return (int64_t)(((uint64_t)read_be32(p) << 32) | read_be32(p + 4));
+}
+
+static int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+int64_t tz_days_from_civil(int64_t y, int m, int d) {
+    // http://howardhinnant.github.io/date_algorithms.html
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const int64_t yoe = y - era * 400;
+    const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void tz_civil_from_seconds(int64_t seconds, struct tm* out) {
+    const int64_t days = floor_div(seconds, 86400);
+    const int64_t secondsOfDay = seconds - days * 86400;
+
+    const int64_t z = days + 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const int64_t doe = z - era * 146097;
+    const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int64_t mp = (5 * doy + 2) / 153;
+    const int d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    const int m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    const int64_t y = yoe + era * 400 + (m <= 2);
+
+    *out = (struct tm){ 0 };
+    out->tm_year = (int)(y - 1900);
+    out->tm_mon = m - 1;
+    out->tm_mday = d;
+    out->tm_hour = (int)(secondsOfDay / 3600);
+    out->tm_min = (int)(secondsOfDay / 60 % 60);
+    out->tm_sec = (int)(secondsOfDay % 60);
+    out->tm_wday = (int)((days % 7 + 11) % 7); // 1970-01-01 was a Thursday
+    out->tm_yday = (int)(days - tz_days_from_civil(y, 1, 1));
+}
+
+// --- POSIX TZ rules ---------------------------------------------------------
+
+static const char* parse_name(const char* p) {
+    if (*p == '<') {
+        const char* end = strchr(p, '>');
+        return end ? end + 1 : NULL;
+    }
+    const char* start = p;
+    while ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z')) ++p;
+    return p - start >= 3 ? p : NULL;
+}
+
+static const char* parse_number(const char* p, int* value) {
+    if (*p < '0' || *p > '9') return NULL;
+    *value = 0;
+    while (*p >= '0' && *p <= '9') *value = *value * 10 + (*p++ - '0');
+    return p;
+}
+
+// [+|-]hh[:mm[:ss]]
+static const char* parse_hms(const char* p, int32_t* seconds) {
+    int sign = 1;
+    if (*p == '+' || *p == '-') sign = *p++ == '-' ? -1 : 1;
+    int h = 0, m = 0, s = 0;
+    if (!(p = parse_number(p, &h)) || h > 167) return NULL;
+    if (*p == ':') {
+        if (!(p = parse_number(p + 1, &m)) || m > 59) return NULL;
+        if (*p == ':' && (!(p = parse_number(p + 1, &s)) || s > 59)) return NULL;
+    }
+    *seconds = sign * (h * 3600 + m * 60 + s);
+    return p;
+}
+
+static const char* parse_rule_date(const char* p, CClockTzRuleDate* date) {
+    *date = (CClockTzRuleDate){ 0 };
+    if (*p == 'M') {
+        date->kind = 'M';
+        if (!(p = parse_number(p + 1, &date->month)) || *p != '.') return NULL;
+        if (!(p = parse_number(p + 1, &date->week)) || *p != '.') return NULL;
+        if (!(p = parse_number(p + 1, &date->day))) return NULL;
+        if (date->month < 1 || date->month > 12 || date->week < 1 || date->week > 5 || date->day > 6) return NULL;
+    }
+    else if (*p == 'J') {
+        date->kind = 'J';
+        if (!(p = parse_number(p + 1, &date->day)) || date->day < 1 || date->day > 365) return NULL;
+    }
+    else {
+        date->kind = 'D';
+        if (!(p = parse_number(p, &date->day)) || date->day > 365) return NULL;
+    }
+    date->time = 2 * 3600;
+    if (*p == '/' && !(p = parse_hms(p + 1, &date->time))) return NULL;
+    return p;
+}
+
+bool tz_rule_parse(CClockTzRule* rule, const char* text) {
+    *rule = (CClockTzRule){ 0 };
+    int32_t offset;
+    const char* p = parse_name(text);
+    if (!p || !(p = parse_hms(p, &offset))) return false;
+    // POSIX offsets count westwards
+    rule->stdOffset = -offset;
+    rule->dstOffset = rule->stdOffset;
+    if (*p == '\0') return true;
+
+    if (!(p = parse_name(p))) return false;
+    rule->hasDst = true;
+    rule->dstOffset = rule->stdOffset + 3600;
+    if (*p != '\0' && *p != ',') {
+        if (!(p = parse_hms(p, &offset))) return false;
+        rule->dstOffset = -offset;
+    }
+    if (*p == '\0') p = TZ_DEFAULT_RULE;
+
+    if (*p != ',' || !(p = parse_rule_date(p + 1, &rule->start))) return false;
+    if (*p != ',' || !(p = parse_rule_date(p + 1, &rule->end))) return false;
+    return *p == '\0';
+}
+
+static bool is_leap_year(int64_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+// Local seconds since the epoch at which the rule date fires in the given year
+static int64_t rule_date_local_seconds(const CClockTzRuleDate* date, int64_t year) {
+    int64_t days;
+    if (date->kind == 'J') {
+        // Feb 29 is never counted
+        days = tz_days_from_civil(year, 1, 1) + date->day - 1;
+        if (is_leap_year(year) && date->day >= 60) days++;
+    }
+    else if (date->kind == 'D') {
+        days = tz_days_from_civil(year, 1, 1) + date->day;
+    }
+    else {
+        static const int monthDays[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        const int64_t first = tz_days_from_civil(year, date->month, 1);
+        const int firstWeekday = (int)((first % 7 + 11) % 7);
+        int mday = 1 + (date->day - firstWeekday + 7) % 7 + (date->week - 1) * 7;
+        const int length = monthDays[date->month - 1] + (date->month == 2 && is_leap_year(year));
+        while (mday > length) mday -= 7;
+        days = first + mday - 1;
+    }
+    return days * 86400 + date->time;
+}
+
+typedef struct {
+    int64_t at;
+    bool isDst;
+} RuleTransition;
+
+// Interval of utc under the rule, never starting before floorStart
+static void rule_interval(const CClockTzRule* rule, int64_t utc, int64_t floorStart,
+    int64_t* start, int64_t* end, int32_t* offset, bool* isDst) {
+
+    if (!rule->hasDst) {
+        *start = floorStart;
+        *end = INT64_MAX;
+        *offset = rule->stdOffset;
+        *isDst = false;
+        return;
+    }
+
+    struct tm civil;
+    tz_civil_from_seconds(utc + rule->stdOffset, &civil);
+    const int64_t year = civil.tm_year + 1900LL;
+
+    // Transitions of the surrounding years, the start time is in standard time and the end time in DST
+    RuleTransition transitions[6];
+    int count = 0;
+    for (int64_t y = year - 1; y <= year + 1; ++y) {
+        transitions[count++] = (RuleTransition){ rule_date_local_seconds(&rule->start, y) - rule->stdOffset, true };
+        transitions[count++] = (RuleTransition){ rule_date_local_seconds(&rule->end, y) - rule->dstOffset, false };
+    }
+    for (int i = 1; i < count; ++i) {
+        const RuleTransition t = transitions[i];
+        int j = i - 1;
+        while (j >= 0 && transitions[j].at > t.at) {
+            transitions[j + 1] = transitions[j];
+            --j;
+        }
+        transitions[j + 1] = t;
+    }
+
+    int current = -1;
+    for (int i = 0; i < count && transitions[i].at <= utc; ++i) current = i;
+    *isDst = current >= 0 ? transitions[current].isDst : !transitions[0].isDst;
+    *offset = *isDst ? rule->dstOffset : rule->stdOffset;
+    *start = current >= 0 ? transitions[current].at : floorStart;
+    if (*start < floorStart) *start = floorStart;
+    *end = current + 1 < count ? transitions[current + 1].at : INT64_MAX;
+}
+
+// --- TZif -------------------------------------------------------------------
+
+bool tz_zone_parse(CClockTzZone* zone, const uint8_t* data, size_t size) {
+    *zone = (CClockTzZone){ 0 };
+    const uint8_t* end = data + size;
+    if (size < TZIF_HEADER_SIZE || memcmp(data, "TZif", 4) != 0) return false;
+
+    const uint8_t version = data[4];
+    const uint8_t* header = data;
+    int timeSize = 4;
+
+    if (version >= '2') {
+        // Skip the 32-bit block, the 64-bit one follows with its own header
+        const uint32_t isutcnt = read_be32(data + 20);
+        const uint32_t isstdcnt = read_be32(data + 24);
+        const uint32_t leapcnt = read_be32(data + 28);
+        const uint32_t timecnt = read_be32(data + 32);
+        const uint32_t typecnt = read_be32(data + 36);
+        const uint32_t charcnt = read_be32(data + 40);
+        const uint64_t v1Size = (uint64_t)timecnt * 5 + (uint64_t)typecnt * 6 + charcnt + (uint64_t)leapcnt * 8 + isstdcnt + isutcnt;
+        if (v1Size + 2 * TZIF_HEADER_SIZE > size) return false;
+        header = data + TZIF_HEADER_SIZE + v1Size;
+        if (memcmp(header, "TZif", 4) != 0) return false;
+        timeSize = 8;
+    }
+
+    const uint32_t isutcnt = read_be32(header + 20);
+    const uint32_t isstdcnt = read_be32(header + 24);
+    const uint32_t leapcnt = read_be32(header + 28);
+    const uint32_t timecnt = read_be32(header + 32);
+    const uint32_t typecnt = read_be32(header + 36);
+    const uint32_t charcnt = read_be32(header + 40);
+    if (typecnt == 0 || typecnt > TZ_MAX_TYPES || charcnt > TZ_MAX_ABBREVIATIONS) return false;
+
+    const uint8_t* p = header + TZIF_HEADER_SIZE;
+    const uint64_t bodySize = (uint64_t)timecnt * (timeSize + 1) + (uint64_t)typecnt * 6 + charcnt
+        + (uint64_t)leapcnt * (timeSize + 4) + isstdcnt + isutcnt;
+    if (bodySize > (uint64_t)(end - p)) return false;
+
+    if (timecnt > 0) {
+        zone->transitions = malloc(sizeof(int64_t) * timecnt);
+        zone->transitionTypes = malloc(timecnt);
+        if (!zone->transitions || !zone->transitionTypes) {
+            tz_zone_free(zone);
+            return false;
+        }
+    }
+    zone->transitionCount = (int)timecnt;
+    for (uint32_t i = 0; i < timecnt; ++i, p += timeSize) {
+        zone->transitions[i] = timeSize == 8 ? read_be64(p) : (int64_t)(int32_t)read_be32(p);
+    }
+    for (uint32_t i = 0; i < timecnt; ++i, ++p) {
+        if (*p >= typecnt) {
+            tz_zone_free(zone);
+            return false;
+        }
+        zone->transitionTypes[i] = *p;
+    }
+    zone->typeCount = (int)typecnt;
+    for (uint32_t i = 0; i < typecnt; ++i, p += 6) {
+        zone->types[i].utcOffset = (int32_t)read_be32(p);
+        zone->types[i].isDst = p[4];
+        zone->types[i].abbreviation = p[5] < charcnt ? p[5] : 0;
+    }
+    memcpy(zone->abbreviations, p, charcnt);
+    zone->abbreviations[TZ_MAX_ABBREVIATIONS - 1] = '\0';
+    p += charcnt + (uint64_t)leapcnt * (timeSize + 4) + isstdcnt + isutcnt;
+
+    // v2+ footer: "\n<POSIX TZ>\n", rules every instant after the last transition
+    if (timeSize == 8 && p < end && *p == '\n') {
+        const uint8_t* footerEnd = memchr(p + 1, '\n', (size_t)(end - p - 1));
+        if (footerEnd && footerEnd - p - 1 < 128) {
+            char footer[128];
+            memcpy(footer, p + 1, (size_t)(footerEnd - p - 1));
+            footer[footerEnd - p - 1] = '\0';
+            zone->hasRule = footer[0] != '\0' && tz_rule_parse(&zone->rule, footer);
+        }
+    }
+
+    // Empty cache
+    zone->cacheStart = 1;
+    zone->cacheEnd = 0;
+    return true;
+}
+
+bool tz_zone_load(CClockTzZone* zone, const char* dir, const char* name) {
+    *zone = (CClockTzZone){ 0 };
+    // Zone names come from the ini, keep them inside the zoneinfo directory
+    if (!name || !name[0] || name[0] == '/' || name[0] == '\\' || strstr(name, "..")) return false;
+
+    if (!dir) {
+#ifndef _WIN32
+        dir = getenv("TZDIR");
+#endif
+        if (!dir) dir = TZ_DEFAULT_DIR;
+    }
+
+    char path[512];
+    if (snprintf(path, sizeof(path), "%s/%s", dir, name) >= (int)sizeof(path)) return false;
+
+    FILE* f = NULL;
+#ifdef _WIN32
+    if (fopen_s(&f, path, "rb") != 0) f = NULL;
+#else
+    f = fopen(path, "rb");
+#endif
+    if (!f) return false;
+
+    uint8_t* data = malloc(TZIF_MAX_FILE_SIZE);
+    bool loaded = false;
+    if (data) {
+        const size_t size = fread(data, 1, TZIF_MAX_FILE_SIZE, f);
+        loaded = tz_zone_parse(zone, data, size);
+        free(data);
+    }
+    fclose(f);
+    return loaded;
+}
+
+void tz_zone_free(CClockTzZone* zone) {
+    free(zone->transitions);
+    free(zone->transitionTypes);
+    zone->transitions = NULL;
+    zone->transitionTypes = NULL;
+    zone->transitionCount = 0;
+}
+
+static void lookup_interval(const CClockTzZone* zone, int64_t utc, int64_t* start, int64_t* end, int32_t* offset, bool* isDst) {
+    const int n = zone->transitionCount;
+
+    if (n == 0 && zone->hasRule) {
+        rule_interval(&zone->rule, utc, INT64_MIN, start, end, offset, isDst);
+        return;
+    }
+    if (n == 0 || utc < zone->transitions[0]) {
+        // Before the first transition the first time type applies
+        *start = INT64_MIN;
+        *end = n > 0 ? zone->transitions[0] : INT64_MAX;
+        *offset = zone->types[0].utcOffset;
+        *isDst = zone->types[0].isDst != 0;
+        return;
+    }
+    if (utc >= zone->transitions[n - 1] && zone->hasRule) {
+        rule_interval(&zone->rule, utc, zone->transitions[n - 1], start, end, offset, isDst);
+        return;
+    }
+
+    // Last transition <= utc
+    int lo = 0;
+    int hi = n - 1;
+    while (lo < hi) {
+        const int mid = lo + (hi - lo + 1) / 2;
+        if (zone->transitions[mid] <= utc) lo = mid;
+        else                               hi = mid - 1;
+    }
+    const CClockTzType* type = &zone->types[zone->transitionTypes[lo]];
+    *start = zone->transitions[lo];
+    *end = lo + 1 < n ? zone->transitions[lo + 1] : INT64_MAX;
+    *offset = type->utcOffset;
+    *isDst = type->isDst != 0;
+}
+
+int32_t tz_zone_offset(CClockTzZone* zone, int64_t utc, bool* isDst) {
+    if (utc < zone->cacheStart || utc >= zone->cacheEnd) {
+        lookup_interval(zone, utc, &zone->cacheStart, &zone->cacheEnd, &zone->cacheOffset, &zone->cacheIsDst);
+    }
+    if (isDst) *isDst = zone->cacheIsDst;
+    return zone->cacheOffset;
+}
+
+void tz_zone_localtime(CClockTzZone* zone, int64_t utc, struct tm* out) {
+    bool isDst;
+    const int32_t offset = tz_zone_offset(zone, utc, &isDst);
+    tz_civil_from_seconds(utc + offset, out);
+    out->tm_isdst = isDst;
+}
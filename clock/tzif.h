@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Reader for TZif zoneinfo files (RFC 8536), UTC -> local conversions without touching TZ/tzset
+// which are process global and not thread-safe
+
+#ifdef _WIN32
+#define TZ_DEFAULT_DIR "zoneinfo"
+#else
+#define TZ_DEFAULT_DIR "/usr/share/zoneinfo"
+#endif
+
+#define TZ_MAX_TYPES 256
+#define TZ_MAX_ABBREVIATIONS 256
+
+typedef struct {
+    int32_t utcOffset;  // seconds east of UTC
+    uint8_t isDst;
+    uint8_t abbreviation; // index into CClockTzZone.abbreviations
+} CClockTzType;
+
+// One DST transition of a POSIX TZ rule (Jn, n or Mm.w.d)
+typedef struct {
+    char kind;          // 'J', 'D' (zero based day of year) or 'M'
+    int month;
+    int week;
+    int day;
+    int32_t time;       // local seconds after midnight, may be negative or above 24h
+} CClockTzRuleDate;
+
+// POSIX TZ string from the footer, covers everything after the last transition
+typedef struct {
+    int32_t stdOffset;  // seconds east of UTC
+    int32_t dstOffset;
+    bool hasDst;
+    CClockTzRuleDate start;
+    CClockTzRuleDate end;
+} CClockTzRule;
+
+typedef struct {
+    int64_t* transitions;       // sorted UTC instants
+    uint8_t* transitionTypes;   // index into types of the interval starting at transitions[i]
+    int transitionCount;
+    CClockTzType types[TZ_MAX_TYPES];
+    int typeCount;
+    char abbreviations[TZ_MAX_ABBREVIATIONS];
+    CClockTzRule rule;
+    bool hasRule;
+
+    // Interval of the last lookup, the clock asks for nearly the same instant every tick
+    int64_t cacheStart;
+    int64_t cacheEnd;           // exclusive
+    int32_t cacheOffset;
+    bool cacheIsDst;
+} CClockTzZone;
+
+// dir may be NULL to use $TZDIR or TZ_DEFAULT_DIR
+bool tz_zone_load(CClockTzZone* zone, const char* dir, const char* name);
+
+bool tz_zone_parse(CClockTzZone* zone, const uint8_t* data, size_t size);
+
+// Parses a POSIX TZ string such as "CET-1CEST,M3.5.0,M10.5.0/3"
+bool tz_rule_parse(CClockTzRule* rule, const char* text);
+
+void tz_zone_free(CClockTzZone* zone);
+
+// O(1) while utc stays in the cached interval, binary search otherwise
+int32_t tz_zone_offset(CClockTzZone* zone, int64_t utc, bool* isDst);
+
+// Same fields as localtime_r fills, except tm_gmtoff/tm_zone
+void tz_zone_localtime(CClockTzZone* zone, int64_t utc, struct tm* out);
+
+// Splits seconds since the epoch into a calendar date without any time zone
+void tz_civil_from_seconds(int64_t seconds, struct tm* out);
+
+int64_t tz_days_from_civil(int64_t y, int m, int d);
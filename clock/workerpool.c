@@ -0,0 +1,148 @@
+#include "workerpool.h"
+
+#include <stdio.h>
+
+static bool pop_task(CClockWorkRange* range, int* task) {
+    bool found = false;
+    SDL_AtomicLock(&range->lock);
+    if (range->begin < range->end) {
+        *task = --range->end;
+        found = true;
+    }
+    SDL_AtomicUnlock(&range->lock);
+    return found;
+}
+
+// Moves the upper half of a victim range into the (empty) range of thread `self`
+static bool steal_tasks(CClockWorkerPool* pool, int self) {
+    for (int i = 1; i < pool->threadCount; ++i) {
+        CClockWorkRange* victim = &pool->ranges[(self + i) % pool->threadCount];
+        int begin = 0, end = 0;
+        SDL_AtomicLock(&victim->lock);
+        if (victim->begin < victim->end) {
+            const int mid = victim->begin + (victim->end - victim->begin) / 2;
+            begin = mid;
+            end = victim->end;
+            victim->end = mid;
+        }
+        SDL_AtomicUnlock(&victim->lock);
+
+        if (begin < end) {
+            CClockWorkRange* own = &pool->ranges[self];
+            SDL_AtomicLock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            SDL_AtomicUnlock(&own->lock);
+            SDL_AtomicIncRef(&pool->steals);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void work(CClockWorkerPool* pool, int self) {
+    int task;
+    for (;;) {
+        while (pop_task(&pool->ranges[self], &task)) {
+            pool->fn(pool->context, task);
+        }
+        if (!steal_tasks(pool, self)) return;
+    }
+}
+
+static int worker_main(void* data) {
+    const CClockWorkerStart* start = data;
+    CClockWorkerPool* pool = start->pool;
+    unsigned seenGeneration = 0;
+
+    for (;;) {
+        SDL_LockMutex(pool->mutex);
+        while (!pool->quit && pool->generation == seenGeneration) SDL_CondWait(pool->wake, pool->mutex);
+        const bool quit = pool->quit;
+        seenGeneration = pool->generation;
+        SDL_UnlockMutex(pool->mutex);
+
+        if (quit) return 0;
+        work(pool, start->index);
+
+        // Ranges of the next run may only be published once every worker is out of work(),
+        // otherwise a late thief could overwrite them
+        SDL_LockMutex(pool->mutex);
+        if (--pool->busy == 0) SDL_CondBroadcast(pool->done);
+        SDL_UnlockMutex(pool->mutex);
+    }
+}
+
+bool worker_pool_init(CClockWorkerPool* pool, int threadCount) {
+    *pool = (CClockWorkerPool){ 0 };
+    if (threadCount <= 0) threadCount = SDL_GetCPUCount();
+    if (threadCount > WORKER_POOL_MAX_THREADS) threadCount = WORKER_POOL_MAX_THREADS;
+    pool->threadCount = 1;
+
+    pool->mutex = SDL_CreateMutex();
+    pool->wake = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+    if (!pool->mutex || !pool->wake || !pool->done) {
+        fprintf(stderr, "Could not create the worker pool: %s\n", SDL_GetError());
+        worker_pool_destroy(pool);
+        return false;
+    }
+
+    for (int i = 1; i < threadCount; ++i) {
+        pool->starts[i] = (CClockWorkerStart){ pool, i };
+        pool->threads[i] = SDL_CreateThread(worker_main, "cclock-worker", &pool->starts[i]);
+        if (!pool->threads[i]) {
+            fprintf(stderr, "Could not create worker %d: %s\n", i, SDL_GetError());
+            break;
+        }
+        pool->threadCount = i + 1;
+    }
+    return true;
+}
+
+void worker_pool_run(CClockWorkerPool* pool, CClockTaskFn fn, void* context, int taskCount) {
+    if (taskCount <= 0) return;
+    if (pool->threadCount == 1) {
+        for (int task = 0; task < taskCount; ++task) fn(context, task);
+        return;
+    }
+
+    pool->fn = fn;
+    pool->context = context;
+    for (int i = 0; i < pool->threadCount; ++i) {
+        CClockWorkRange* range = &pool->ranges[i];
+        SDL_AtomicLock(&range->lock);
+        range->begin = (int)((long long)taskCount * i / pool->threadCount);
+        range->end = (int)((long long)taskCount * (i + 1) / pool->threadCount);
+        SDL_AtomicUnlock(&range->lock);
+    }
+
+    SDL_LockMutex(pool->mutex);
+    pool->generation++;
+    pool->busy = pool->threadCount - 1;
+    SDL_CondBroadcast(pool->wake);
+    SDL_UnlockMutex(pool->mutex);
+
+    // The calling thread works too instead of sleeping
+    work(pool, 0);
+
+    SDL_LockMutex(pool->mutex);
+    while (pool->busy > 0) SDL_CondWait(pool->done, pool->mutex);
+    SDL_UnlockMutex(pool->mutex);
+}
+
+void worker_pool_destroy(CClockWorkerPool* pool) {
+    if (pool->mutex) {
+        SDL_LockMutex(pool->mutex);
+        pool->quit = true;
+        SDL_CondBroadcast(pool->wake);
+        SDL_UnlockMutex(pool->mutex);
+    }
+    for (int i = 1; i < WORKER_POOL_MAX_THREADS; ++i) {
+        if (pool->threads[i]) SDL_WaitThread(pool->threads[i], NULL);
+    }
+    if (pool->done) SDL_DestroyCond(pool->done);
+    if (pool->wake) SDL_DestroyCond(pool->wake);
+    if (pool->mutex) SDL_DestroyMutex(pool->mutex);
+    *pool = (CClockWorkerPool){ 0 };
+}
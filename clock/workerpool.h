@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL.h>
+
+#define WORKER_POOL_MAX_THREADS 64
+
+typedef void (*CClockTaskFn)(void* context, int task);
+
+// Tasks of one run are split in contiguous ranges, one per thread. A thread pops from the end
+// of its own range and when it runs dry steals the upper half of another thread's range
+typedef struct {
+    SDL_SpinLock lock;
+    int begin;
+    int end;    // exclusive
+} CClockWorkRange;
+
+struct CClockWorkerPool;
+
+typedef struct {
+    struct CClockWorkerPool* pool;
+    int index;
+} CClockWorkerStart;
+
+typedef struct CClockWorkerPool {
+    SDL_Thread* threads[WORKER_POOL_MAX_THREADS];
+    CClockWorkRange ranges[WORKER_POOL_MAX_THREADS];   // ranges[0] belongs to the calling thread
+    CClockWorkerStart starts[WORKER_POOL_MAX_THREADS];
+    int threadCount;                                    // including the calling thread
+
+    SDL_mutex* mutex;
+    SDL_cond* wake;
+    SDL_cond* done;
+    unsigned generation;
+    int busy;           // workers that have not finished the current run yet
+    bool quit;
+
+    CClockTaskFn fn;
+    void* context;
+    SDL_atomic_t steals;
+} CClockWorkerPool;
+
+// threadCount <= 0 uses one thread per CPU, 1 runs everything on the calling thread
+bool worker_pool_init(CClockWorkerPool* pool, int threadCount);
+
+// Runs fn(context, 0..taskCount-1) across the pool and returns when every task is done
+void worker_pool_run(CClockWorkerPool* pool, CClockTaskFn fn, void* context, int taskCount);
+
+void worker_pool_destroy(CClockWorkerPool* pool);
@@ -0,0 +1,251 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // setenv, tzset
+#endif
+
+#include "worldclock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Every DST transition in the tz database happens on a quarter hour, an offset computed
+// at t stays valid at least until the next quarter hour boundary
+#define OFFSET_CACHE_SECONDS (15 * 60)
+
+static const CClockZoneSpec g_defaultZones[] = {
+    { "UTC", "UTC0" },
+    { "New York", "EST5EDT,M3.2.0,M11.1.0" },
+    { "Paris", "CET-1CEST,M3.5.0,M10.5.0/3" },
+    { "Tokyo", "JST-9" },
+};
+
+int world_clock_default_zones(CClockZoneSpec* specs, int maxSpecs) {
+    const int count = (int)(sizeof(g_defaultZones) / sizeof(g_defaultZones[0]));
+    int i = 0;
+    for (; i < count && i < maxSpecs; ++i) specs[i] = g_defaultZones[i];
+    return i;
+}
+
+bool world_clock_parse_zone(const char* text, CClockZoneSpec* spec) {
+    const char* separator = strchr(text, '|');
+    if (!separator || separator == text) return false;
+
+    const size_t labelLength = (size_t)(separator - text);
+    if (labelLength >= sizeof(spec->label)) return false;
+    memcpy(spec->label, text, labelLength);
+    spec->label[labelLength] = '\0';
+
+    SDL_strlcpy(spec->tz, separator + 1, sizeof(spec->tz));
+    // Strip the line ending left by fgets
+    spec->tz[strcspn(spec->tz, "\r\n")] = '\0';
+    return spec->tz[0] != '\0';
+}
+
+// Zoneinfo file first, then the TZ as a POSIX rule, NULL leaves the zone to the TZ fallback
+static CClockTzZone* load_zone_info(const char* tz) {
+    CClockTzZone* zoneInfo = malloc(sizeof(CClockTzZone));
+    if (!zoneInfo) return NULL;
+    if (tz_zone_load(zoneInfo, NULL, tz)) return zoneInfo;
+
+    *zoneInfo = (CClockTzZone){ 0 };
+    if (tz_rule_parse(&zoneInfo->rule, tz)) {
+        zoneInfo->hasRule = true;
+        zoneInfo->typeCount = 1;
+        zoneInfo->cacheStart = 1;
+        zoneInfo->cacheEnd = 0;
+        return zoneInfo;
+    }
+    free(zoneInfo);
+    return NULL;
+}
+
+void world_clock_init(CClockWorldClock* worldClock, const CClockZoneSpec* specs, int specCount) {
+    *worldClock = (CClockWorldClock){ 0 };
+    if (specCount > WORLD_CLOCK_MAX_ZONES) specCount = WORLD_CLOCK_MAX_ZONES;
+    for (int i = 0; i < specCount; ++i) {
+        worldClock->zones[i].spec = specs[i];
+        worldClock->zones[i].zoneInfo = load_zone_info(specs[i].tz);
+    }
+    worldClock->zoneCount = specCount;
+}
+
+static void set_tz(const char* tz) {
+#ifdef _WIN32
+    _putenv_s("TZ", tz ? tz : "");
+    _tzset();
+#else
+    if (tz) setenv("TZ", tz, 1);
+    else    unsetenv("TZ");
+    tzset();
+#endif
+}
+
+// Copies the current TZ into savedTz, returns false if TZ is not set
+static bool save_tz(char* savedTz, size_t size) {
+#ifdef _WIN32
+    char* value = NULL;
+    size_t length = 0;
+    if (_dupenv_s(&value, &length, "TZ") != 0 || !value) return false;
+    SDL_strlcpy(savedTz, value, size);
+    free(value);
+    return true;
+#else
+    const char* value = getenv("TZ");
+    if (!value) return false;
+    SDL_strlcpy(savedTz, value, size);
+    return true;
+#endif
+}
+
+// Offset of the zone TZ currently points to
+static long compute_utc_offset(time_t t) {
+    struct tm local = { 0 };
+#ifdef _WIN32
+    localtime_s(&local, &t);
+#else
+    localtime_r(&t, &local);
+#endif
+    const long long localSeconds = tz_days_from_civil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) * 86400LL
+        + local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+    return (long)(localSeconds - (long long)t);
+}
+
+void world_clock_update(CClockWorldClock* worldClock, time_t now) {
+    char savedTz[128];
+    bool hadTz = false;
+    bool switched = false;
+
+    for (int i = 0; i < worldClock->zoneCount; ++i) {
+        CClockZone* zone = &worldClock->zones[i];
+        if (zone->zoneInfo) {
+            // O(1) until the next transition of the zone
+            zone->utcOffset = tz_zone_offset(zone->zoneInfo, (int64_t)now, NULL);
+            continue;
+        }
+        if (now < zone->validUntil) continue;
+
+        if (!switched) {
+            hadTz = save_tz(savedTz, sizeof(savedTz));
+            switched = true;
+        }
+        set_tz(zone->spec.tz);
+        zone->utcOffset = compute_utc_offset(now);
+        zone->validUntil = (now / OFFSET_CACHE_SECONDS + 1) * OFFSET_CACHE_SECONDS;
+        worldClock->offsetRecomputes++;
+    }
+
+    if (switched) set_tz(hadTz ? savedTz : NULL);
+}
+
+static void update_layout(CClockWorldClock* worldClock, const CClockGlyphAtlas* atlas, int w, int h, bool showSeconds) {
+    if (worldClock->layoutZoneCount == worldClock->zoneCount && worldClock->layoutW == w && worldClock->layoutH == h
+        && worldClock->layoutShowSeconds == showSeconds) {
+        return;
+    }
+    worldClock->layoutZoneCount = worldClock->zoneCount;
+    worldClock->layoutW = w;
+    worldClock->layoutH = h;
+    worldClock->layoutShowSeconds = showSeconds;
+
+    const int n = worldClock->zoneCount > 0 ? worldClock->zoneCount : 1;
+    const float timeW = (float)glyph_atlas_text_width(atlas, WORLD_CLOCK_TIME_FACE, showSeconds ? "00:00:00" : "00:00");
+    const float timeH = (float)atlas->faces[WORLD_CLOCK_TIME_FACE].lineHeight;
+    const float labelH = (float)atlas->faces[WORLD_CLOCK_LABEL_FACE].lineHeight;
+
+    // Pick the grid that gives the biggest digits, the label takes the top quarter of a cell
+    worldClock->columns = 1;
+    worldClock->rows = n;
+    worldClock->timeScale = 0.f;
+    for (int columns = 1; columns <= n; ++columns) {
+        const int rows = (n + columns - 1) / columns;
+        const float cellW = (float)w / columns;
+        const float cellH = (float)h / rows;
+        const float scaleW = cellW * 0.9f / timeW;
+        const float scaleH = cellH * 0.7f / timeH;
+        const float scale = scaleW < scaleH ? scaleW : scaleH;
+        if (scale > worldClock->timeScale) {
+            worldClock->timeScale = scale;
+            worldClock->columns = columns;
+            worldClock->rows = rows;
+        }
+    }
+    worldClock->labelScale = worldClock->timeScale * timeH * 0.3f / labelH;
+}
+
+static void format_time_of_day(long long localSeconds, bool showSeconds, char* out) {
+    const int secondsOfDay = (int)(((localSeconds % 86400) + 86400) % 86400);
+    const int hour = secondsOfDay / 3600;
+    const int min = (secondsOfDay / 60) % 60;
+    const int sec = secondsOfDay % 60;
+    out[0] = (char)('0' + hour / 10);
+    out[1] = (char)('0' + hour % 10);
+    out[2] = ':';
+    out[3] = (char)('0' + min / 10);
+    out[4] = (char)('0' + min % 10);
+    if (showSeconds) {
+        out[5] = ':';
+        out[6] = (char)('0' + sec / 10);
+        out[7] = (char)('0' + sec % 10);
+        out[8] = '\0';
+    }
+    else {
+        out[5] = '\0';
+    }
+}
+
+void world_clock_render(SDL_Renderer* renderer, CClockWorldClock* worldClock, const CClockGlyphAtlas* atlas,
+    const SDL_Rect* area, time_t now, bool showSeconds, SDL_Color color, bool shadowEffect) {
+
+    world_clock_update(worldClock, now);
+    update_layout(worldClock, atlas, area->w, area->h, showSeconds);
+
+    const float timeScale = worldClock->timeScale;
+    const float labelScale = worldClock->labelScale;
+    const float cellW = (float)area->w / worldClock->columns;
+    const float cellH = (float)area->h / worldClock->rows;
+    const float timeW = glyph_atlas_text_width(atlas, WORLD_CLOCK_TIME_FACE, showSeconds ? "00:00:00" : "00:00") * timeScale;
+    const float timeH = atlas->faces[WORLD_CLOCK_TIME_FACE].lineHeight * timeScale;
+    const float labelH = atlas->faces[WORLD_CLOCK_LABEL_FACE].lineHeight * labelScale;
+    const float shadowOffset = timeH / 64.f > 1.f ? timeH / 64.f : 1.f;
+    const SDL_Color shadowColor = { 1, 1, 1, 255 };
+
+    for (int i = 0; i < worldClock->zoneCount; ++i) {
+        const CClockZone* zone = &worldClock->zones[i];
+        const float cellX = area->x + (i % worldClock->columns) * cellW;
+        const float cellY = area->y + (i / worldClock->columns) * cellH;
+        const float top = cellY + (cellH - (labelH + timeH)) / 2.f;
+
+        char timeStr[9];
+        format_time_of_day((long long)now + zone->utcOffset, showSeconds, timeStr);
+
+        const float labelW = glyph_atlas_text_width(atlas, WORLD_CLOCK_LABEL_FACE, zone->spec.label) * labelScale;
+        const float labelX = cellX + (cellW - labelW) / 2.f;
+        const float timeX = cellX + (cellW - timeW) / 2.f;
+
+        if (shadowEffect && atlas->shadowTexture) {
+            glyph_batch_push_shadow(&worldClock->shadowBatch, atlas, WORLD_CLOCK_LABEL_FACE, zone->spec.label, labelX + shadowOffset / 2.f, top + shadowOffset / 2.f, labelScale, shadowColor);
+            glyph_batch_push_shadow(&worldClock->shadowBatch, atlas, WORLD_CLOCK_TIME_FACE, timeStr, timeX + shadowOffset, top + labelH + shadowOffset, timeScale, shadowColor);
+        }
+        else if (shadowEffect) {
+            glyph_batch_push_text(&worldClock->batch, atlas, WORLD_CLOCK_LABEL_FACE, zone->spec.label, labelX + shadowOffset / 2.f, top + shadowOffset / 2.f, labelScale, shadowColor);
+            glyph_batch_push_text(&worldClock->batch, atlas, WORLD_CLOCK_TIME_FACE, timeStr, timeX + shadowOffset, top + labelH + shadowOffset, timeScale, shadowColor);
+        }
+        glyph_batch_push_text(&worldClock->batch, atlas, WORLD_CLOCK_LABEL_FACE, zone->spec.label, labelX, top, labelScale, color);
+        glyph_batch_push_text(&worldClock->batch, atlas, WORLD_CLOCK_TIME_FACE, timeStr, timeX, top + labelH, timeScale, color);
+    }
+
+    // Shadows go below every clock, one more draw call for the second page
+    glyph_batch_flush_shadow(renderer, atlas, &worldClock->shadowBatch);
+    glyph_batch_flush(renderer, atlas, &worldClock->batch);
+}
+
+void world_clock_destroy(CClockWorldClock* worldClock) {
+    for (int i = 0; i < worldClock->zoneCount; ++i) {
+        if (worldClock->zones[i].zoneInfo) {
+            tz_zone_free(worldClock->zones[i].zoneInfo);
+            free(worldClock->zones[i].zoneInfo);
+            worldClock->zones[i].zoneInfo = NULL;
+        }
+    }
+    glyph_batch_destroy(&worldClock->batch);
+    glyph_batch_destroy(&worldClock->shadowBatch);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <time.h>
+
+#include <SDL.h>
+
+#include "glyph_atlas.h"
+#include "tzif.h"
+
+#define WORLD_CLOCK_MAX_ZONES 128
+
+// Faces of the atlas shared by every clock of the panel and the main clock
+#define WORLD_CLOCK_TIME_FACE 0
+#define WORLD_CLOCK_LABEL_FACE 1
+
+#define WORLD_CLOCK_TIME_CHARSET "0123456789:"
+#define WORLD_CLOCK_LABEL_CHARSET " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"
+
+// What the ini stores: "zone=Paris|Europe/Paris" (zoneinfo name) or "zone=Paris|CET-1CEST,M3.5.0,M10.5.0/3" (POSIX TZ)
+typedef struct {
+    char label[32];
+    char tz[64];
+} CClockZoneSpec;
+
+// The UTC offset of a zone only changes on DST transitions, so it is computed once and reused
+// until the cache expires instead of juggling TZ for every clock on every frame
+typedef struct {
+    CClockZoneSpec spec;
+    CClockTzZone* zoneInfo; // NULL when the TZ is neither a zoneinfo name nor a POSIX TZ we can parse
+    long utcOffset;         // seconds east of UTC
+    time_t validUntil;      // only used by the TZ fallback, zoneInfo caches its own interval
+} CClockZone;
+
+typedef struct {
+    CClockZone zones[WORLD_CLOCK_MAX_ZONES];
+    int zoneCount;
+    CClockGlyphBatch batch;
+    CClockGlyphBatch shadowBatch;
+
+    // Layout is only recomputed when the zone count or the area changes
+    int layoutZoneCount;
+    int layoutW;
+    int layoutH;
+    bool layoutShowSeconds;
+    int columns;
+    int rows;
+    float timeScale;
+    float labelScale;
+
+    unsigned long offsetRecomputes;
+} CClockWorldClock;
+
+void world_clock_init(CClockWorldClock* worldClock, const CClockZoneSpec* specs, int specCount);
+
+// Fills specs with a few well known zones, returns how many
+int world_clock_default_zones(CClockZoneSpec* specs, int maxSpecs);
+
+// Parses "Label|TZ", returns false if malformed
+bool world_clock_parse_zone(const char* text, CClockZoneSpec* spec);
+
+// Refreshes the offsets, TZ is only switched for zones without zoneInfo and at most once per expired zone
+void world_clock_update(CClockWorldClock* worldClock, time_t now);
+
+// All clocks are submitted in a single SDL_RenderGeometry call, plus one for the soft shadows
+void world_clock_render(SDL_Renderer* renderer, CClockWorldClock* worldClock, const CClockGlyphAtlas* atlas,
+    const SDL_Rect* area, time_t now, bool showSeconds, SDL_Color color, bool shadowEffect);
+
+void world_clock_destroy(CClockWorldClock* worldClock);